@@ -15,6 +15,7 @@ from datetime import datetime
 
 import torch
 
+import elf
 from elf import logging
 from rlpytorch import \
   Evaluator, load_env, ModelInterface
@@ -215,11 +216,12 @@ def main():
     info = "game_start() load/reload models\n"
     logger.info(info)
 
-    vers = [
+    load_models([
         int(batch["checkers_white_ver"][0]),
         int(batch["checkers_black_ver"][0])
-        ]
+        ])
 
+  def load_models(vers):
     # Use the version number to load models.
     for model_loader, ver, actor_name in zip(
         env["model_loaders"], vers, actors):
@@ -242,6 +244,12 @@ def main():
   """
   def game_end(batch):
     nonlocal loop_end
+    if args.mode == "arena":
+      arena = batch.GC.getArena()
+      logger.info(f'game_end()\t{arena.info()}')
+      loop_end = arena.finished()
+      return
+
     wr = batch.GC.getClient().getCheckersGameStats().getWinRateStats()
     win_rate = (100.0 * wr.black_wins / (wr.black_wins + wr.white_wins)
           if (wr.black_wins + wr.white_wins) > 0 else 0.0)
@@ -252,6 +260,7 @@ def main():
     info += f'Total Games: {wr.total_games}'
 
     logger.info(info)
+    logger.info(f'game_end()\tMCTS: {elf.getSearchStats().info()}')
     if args.suicide_after_n_games > 0 and \
         wr.total_games >= args.suicide_after_n_games:
       info = f'game_end()\tTotal Games: {wr.total_games}, '
@@ -280,9 +289,15 @@ def main():
         reload_model(model_loader, GC.params,
                env["mi_" + actor_name], actor_name, args)
 
-    # We just use one thread to do selfplay.
-    GC.GC.getClient().setRequest(
-      int(black), int(white), 1)
+    if args.mode == "arena":
+      # No server sends game_start: load the models before the games.
+      if args.eval_model_pair.find(",") >= 0:
+        load_models([int(white), int(black)])
+      GC.GC.getArena().setModels(int(black), int(white))
+    else:
+      # We just use one thread to do selfplay.
+      GC.GC.getClient().setRequest(
+        int(black), int(white), 1)
 
   # Called before each episode, resets actor_count(num of total nn call)
   for actor_name in actors:
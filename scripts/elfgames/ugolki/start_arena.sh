@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Copyright (c) 2018-present, Facebook, Inc.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+# Plays NEW_VER against OLD_VER in this process, both loaded from
+# $root/save-<ver>.bin, until the evaluation passes or fails.
+
+NEW_VER=${NEW_VER:-609280}
+OLD_VER=${OLD_VER:-600000}
+
+BATCHSIZE=32
+NUM_ROLLOUTS=400
+
+GPU=0
+
+DIM=128
+NUM_BLOCK=10
+
+root=${root:-./models} \
+game=elfgames.ugolki.game \
+model=df_pred \
+model_file=elfgames.ugolki.model_ugolki \
+	python3 ./py/selfplay.py \
+	\
+	--T 1 \
+	--gpu $GPU --gpu0 $GPU  --gpu1 $GPU\
+	\
+	--mode arena \
+	--num_games 64 \
+	--keys_in_reply V rv\
+	\
+	--batchsize $BATCHSIZE \
+	--mcts_rollout_per_batch 8 \
+	--mcts_rollout_per_thread $NUM_ROLLOUTS \
+	\
+	--use_mcts							--use_mcts_ai2 \
+	--mcts_virtual_loss 3		--mcts_epsilon 0.0 \
+	--mcts_alpha 0.00 			--mcts_threads 2\
+	--mcts_use_prior \
+	--mcts_persistent_tree	--mcts_puct 0.9 \
+	\
+	--eval_model_pair $NEW_VER,$OLD_VER \
+	--eval_num_games 400 \
+	--policy_distri_cutoff 5 \
+	--num_block0 $NUM_BLOCK		--dim0 $DIM \
+	--num_block1 $NUM_BLOCK		--dim1 $DIM \
+	--no_check_loaded_options0 \
+	--no_check_loaded_options1 \
+	--use_fp160					--use_fp161 \
+	--replace_prefix0 resnet.module,resnet init_conv.module,init_conv\
+	--replace_prefix1 resnet.module,resnet init_conv.module,init_conv\
+	--selfplay_timeout_usec 10 \
+	"$@"
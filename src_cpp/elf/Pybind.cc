@@ -17,6 +17,7 @@
 #include <spdlog/spdlog.h>
 
 #include "elf/ai/tree_search/tree_search_options.h"
+#include "elf/ai/tree_search/tree_search_stats.h"
 #include "elf/base/context.h"
 #include "elf/comm/comm.h"
 #include "elf/logging/Pybind.h"
@@ -92,10 +93,20 @@ void register_tree_search(pybind11::module& m) {
   namespace py = pybind11;
 
   using elf::ai::tree_search::SearchAlgoOptions;
+  using elf::ai::tree_search::SearchStats;
   using elf::ai::tree_search::TSOptions;
 
   PYCLASS_WITH_FIELDS(m, SearchAlgoOptions).def(py::init<>());
   PYCLASS_WITH_FIELDS(m, TSOptions).def(py::init<>());
+  PYCLASS_WITH_FIELDS(m, SearchStats)
+      .def(py::init<>())
+      .def("meanDepth", &SearchStats::meanDepth)
+      .def("info", &SearchStats::info)
+      .def("dumpJson", &SearchStats::dumpJson);
+
+  // MCTS counters of all the searches of the process.
+  m.def("getSearchStats", &elf::ai::tree_search::getProcessSearchStats);
+  m.def("resetSearchStats", &elf::ai::tree_search::resetProcessSearchStats);
 }
 
 } // namespace
@@ -0,0 +1,172 @@
+#include "tree_search_node.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace elf::ai::tree_search;
+
+namespace {
+
+using Tree = TreeT<int, int>;
+using Node = NodeT<int, int>;
+
+void evaluate(Node* node, int num_edges) {
+  NodeResponseT<int> resp;
+  for (int a = 0; a < num_edges; ++a) {
+    resp.pi.emplace_back(a, 1.0f / (a + 2));
+  }
+  resp.value = 0.0;
+  node->setEvaluation(resp);
+}
+
+} // namespace
+
+// Each backup of 64 threads hammering the same edges is counted.
+TEST(TreeSearchNodeTest, concurrentBackupLosesNoUpdate) {
+  const int num_threads = 64;
+  const int num_edges = 16;
+  const int num_backups = 20000;
+
+  Tree tree;
+  Node* root = tree.getRootNode();
+  evaluate(root, num_edges);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < num_backups; ++i) {
+        int edge = (t + i) % num_edges;
+        root->addVirtualLoss(edge, 1.0);
+        EXPECT_NE(InvalidNodeId, root->followEdge(edge, tree));
+        root->updateEdgeStats(edge, (t % 2) ? 1.0 : -1.0, 1.0);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int> visits(num_edges, 0);
+  std::vector<float> rewards(num_edges, 0.0);
+  for (int t = 0; t < num_threads; ++t) {
+    for (int i = 0; i < num_backups; ++i) {
+      visits[(t + i) % num_edges]++;
+      rewards[(t + i) % num_edges] += (t % 2) ? 1.0 : -1.0;
+    }
+  }
+
+  EXPECT_EQ(num_threads * num_backups, root->getNumVisits());
+  for (int i = 0; i < num_edges; ++i) {
+    EdgeInfo edge = root->getEdge(i);
+    EXPECT_EQ(visits[i], edge.num_visits) << "edge " << i;
+    EXPECT_EQ(rewards[i], edge.reward) << "edge " << i;
+    EXPECT_EQ(0.0, edge.virtual_loss) << "edge " << i;
+  }
+  // One child per edge, however many threads followed it at once.
+  EXPECT_EQ(size_t(1 + num_edges), tree.size());
+}
+
+// findMove() picks the edge of the best EdgeInfo::getScore().
+TEST(TreeSearchNodeTest, findMoveMatchesEdgeScores) {
+  std::mt19937 rng(0);
+  SearchAlgoOptions alg_opt;
+  alg_opt.c_puct = 1.5;
+
+  for (int trial = 0; trial < 200; ++trial) {
+    Tree tree;
+    Node* root = tree.getRootNode();
+    const int num_edges = 1 + rng() % 40;
+    evaluate(root, num_edges);
+
+    for (int i = rng() % 300; i > 0; --i) {
+      int edge = rng() % num_edges;
+      root->updateEdgeStats(edge, (rng() % 3) - 1.0, 0.0);
+    }
+    for (int i = rng() % 3; i > 0; --i) {
+      root->addVirtualLoss(rng() % num_edges, 1.0);
+    }
+
+    int best = -1;
+    ASSERT_TRUE(root->findMove(alg_opt, 1, &best));
+
+    const int parent_visits = root->getNumVisits() + 1;
+    float max_score = std::numeric_limits<float>::lowest();
+    for (int i = 0; i < num_edges; ++i) {
+      Score s = root->getEdge(i).getScore(false, parent_visits, 0.0);
+      max_score = std::max(max_score, s.prior_probability * 1.5f + s.q);
+    }
+    Score s = root->getEdge(best).getScore(false, parent_visits, 0.0);
+    EXPECT_NEAR(max_score, s.prior_probability * 1.5f + s.q, 1e-5)
+        << "trial " << trial;
+  }
+}
+
+// Stats are allocated for the edges reached, and the edges keep the order
+// of the policy outside of the node.
+TEST(TreeSearchNodeTest, edgesAllocatedWhenReached) {
+  const int num_edges = 100;
+
+  Tree tree;
+  Node* root = tree.getRootNode();
+  evaluate(root, num_edges);
+  EXPECT_EQ(0u, root->getNumMaterializedEdges());
+
+  SearchAlgoOptions alg_opt;
+  int edge = -1;
+  ASSERT_TRUE(root->findMove(alg_opt, 0, &edge));
+  // evaluate() gives the first action the highest prior.
+  EXPECT_EQ(0, root->getAction(edge));
+  root->followEdge(edge, tree);
+  root->updateEdgeStats(edge, 1.0, 0.0);
+  EXPECT_EQ(1u, root->getNumMaterializedEdges());
+
+  std::mt19937 rng(0);
+  root->enhanceExploration(0.25, 0.03, &rng);
+  EXPECT_EQ(1, root->getEdge(root->findEdge(0)).num_visits);
+  EXPECT_NE(InvalidNodeId, root->getChild(root->findEdge(0)));
+
+  auto action_edges = root->getStateActions();
+  ASSERT_EQ(size_t(num_edges), action_edges.size());
+  for (int a = 0; a < num_edges; ++a) {
+    EXPECT_EQ(a, action_edges[a].first);
+  }
+}
+
+// A node of a checkers width has the stats of all its edges once evaluated,
+// in the order of the policy.
+TEST(TreeSearchNodeTest, narrowNodeAllocatedAtOnce) {
+  const int num_edges = Node::kEagerEdges;
+
+  Tree tree;
+  Node* root = tree.getRootNode();
+  std::vector<float> priors(num_edges);
+  NodeResponseT<int> resp;
+  for (int a = 0; a < num_edges; ++a) {
+    // Not sorted, to show that the edges keep the order of the policy.
+    priors[a] = 1.0f + (a * 7) % num_edges;
+    resp.pi.emplace_back(a, priors[a]);
+  }
+  root->setEvaluation(resp);
+  EXPECT_EQ(size_t(num_edges), root->getNumMaterializedEdges());
+  for (int i = 0; i < num_edges; ++i) {
+    EXPECT_EQ(i, root->getAction(i));
+    EXPECT_EQ(priors[i], root->getEdge(i).prior_probability);
+  }
+
+  SearchAlgoOptions alg_opt;
+  int edge = -1;
+  ASSERT_TRUE(root->findMove(alg_opt, 0, &edge));
+  EXPECT_EQ(
+      int(std::max_element(priors.begin(), priors.end()) - priors.begin()),
+      edge);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
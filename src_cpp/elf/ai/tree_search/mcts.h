@@ -91,11 +91,12 @@ class MCTSAI_T : public AI_T<typename Actor::State, typename Actor::Action> {
 
       clock.record("MCTS");
       logger_->info(
-          "[{}] MCTSAI Result: {} Action: {}\n{}",
+          "[{}] MCTSAI Result: {} Action: {}\n{}\n{}",
           this->getID(),
           lastResult_.info(),
           lastResult_.best_action,
-          clock.summary());
+          clock.summary(),
+          ts_->getLastStats().info());
     } else {
       lastResult_ = ts_->run(s);
     }
@@ -112,6 +113,17 @@ class MCTSAI_T : public AI_T<typename Actor::State, typename Actor::Action> {
     return true;
   }
 
+  // Called with the state after our move: keeps searching the tree in the
+  // background while the opponent is to move, until the next act().
+  // If the opponent plays the expected reply, its subtree is kept.
+  void ponder(const State& s) {
+    if (options_.ponder_rollouts_per_thread <= 0 || !options_.persistent_tree)
+      return;
+
+    align_state(s);
+    ts_->ponder(s);
+  }
+
   // reset Tree;
   bool endGame(const State&) override {
     resetTree();
@@ -122,6 +134,10 @@ class MCTSAI_T : public AI_T<typename Actor::State, typename Actor::Action> {
     return lastResult_;
   }
 
+  const SearchStats& getLastSearchStats() const {
+    return ts_->getLastStats();
+  }
+
   std::string getCurrentTree() const {
     std::stringstream ss;
     ss << options_.info(true) << std::endl;
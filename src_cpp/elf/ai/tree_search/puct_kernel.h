@@ -0,0 +1,296 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "elf/utils/cpu_features.h"
+
+namespace elf {
+namespace ai {
+namespace tree_search {
+
+// PUCT selection among the edges of one node, over flat arrays of the
+// prior, #visits, accumulated reward and virtual loss of each edge:
+//
+//   q = (reward (negated if flip_q_sign) - virtual_loss)
+//       / (num_visits + virtual_loss),
+//       or +/- unsigned_default_q for an edge without visit nor loss
+//   score = prior * c_puct * sqrt(parent_visits) / (1 + num_visits) + q
+//       (q alone without use_prior)
+//
+// puctSelect() returns the first edge of the highest score, and sums the
+// unsigned q (reward / num_visits, or unsigned_default_q) of the edges
+// that have been visited or have a virtual loss. It runs the AVX2 kernel
+// from kMinSimdEdges edges on, when the cpu has it; below that the lane
+// reduction costs more than it saves. The AVX-512 kernel is kept for
+// elf_puct_bench: its divides are no faster per lane, so it loses to AVX2
+// on the cpus measured. No multiply is followed by an add, so compilers
+// cannot fuse them and every kernel rounds the scores the same way: they
+// all pick the same edge. Only total_unsigned_q may differ in its last
+// bits, as it is summed in another order.
+struct PuctEdges {
+  const float* prior;
+  const int* num_visits;
+  const float* reward;
+  const float* virtual_loss;
+  size_t n;
+};
+
+struct PuctParams {
+  bool use_prior = true;
+  float c_puct = 5;
+  bool flip_q_sign = false;
+  int parent_visits = 1;
+  float unsigned_default_q = 0;
+};
+
+struct PuctChoice {
+  int best = -1;
+  float max_score = std::numeric_limits<float>::lowest();
+  float total_unsigned_q = 0;
+  int total_visits = 0;
+};
+
+namespace detail {
+
+struct PuctConsts {
+  float prior_weight;
+  float sign;
+  float signed_default_q;
+  float unsigned_default_q;
+
+  explicit PuctConsts(const PuctParams& params)
+      : prior_weight(
+            params.use_prior
+                ? params.c_puct * std::sqrt(float(params.parent_visits))
+                : 0.0f),
+        sign(params.flip_q_sign ? -1.0f : 1.0f),
+        signed_default_q(
+            params.flip_q_sign ? -params.unsigned_default_q
+                               : params.unsigned_default_q),
+        unsigned_default_q(params.unsigned_default_q) {}
+};
+
+inline float puctScore(
+    const PuctEdges& e,
+    const PuctConsts& c,
+    size_t i,
+    float* unsigned_q,
+    bool* counted) {
+  const float v = float(e.num_visits[i]);
+  const float r = e.reward[i] * c.sign - e.virtual_loss[i];
+  const float v_with_loss = v + e.virtual_loss[i];
+
+  const float q = v_with_loss > 0 ? r / v_with_loss : c.signed_default_q;
+  const float p = e.prior[i] * c.prior_weight / (1.0f + v);
+
+  *unsigned_q = v > 0 ? e.reward[i] / v : c.unsigned_default_q;
+  *counted = (v_with_loss != 0);
+  return p + q;
+}
+
+// Edges [begin, n) one at a time.
+inline void puctSelectTail(
+    const PuctEdges& e,
+    const PuctConsts& c,
+    size_t begin,
+    PuctChoice* choice) {
+  for (size_t i = begin; i < e.n; ++i) {
+    float unsigned_q;
+    bool counted;
+    float score = puctScore(e, c, i, &unsigned_q, &counted);
+    if (score > choice->max_score) {
+      choice->max_score = score;
+      choice->best = int(i);
+    }
+    if (counted) {
+      choice->total_unsigned_q += unsigned_q;
+      choice->total_visits++;
+    }
+  }
+}
+
+// The first edge of the highest score over the lanes of a kernel.
+inline void puctReduceLanes(
+    const float* scores,
+    const int* indices,
+    int num_lanes,
+    PuctChoice* choice) {
+  for (int l = 0; l < num_lanes; ++l) {
+    if (indices[l] < 0) {
+      continue;
+    }
+    if (scores[l] > choice->max_score ||
+        (scores[l] == choice->max_score && indices[l] < choice->best)) {
+      choice->max_score = scores[l];
+      choice->best = indices[l];
+    }
+  }
+}
+
+#ifdef ELF_TARGET_AVX2
+ELF_TARGET_AVX2 inline PuctChoice puctSelectAVX2(
+    const PuctEdges& e,
+    const PuctConsts& c) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 prior_weight = _mm256_set1_ps(c.prior_weight);
+  const __m256 sign = _mm256_set1_ps(c.sign);
+  const __m256 signed_default_q = _mm256_set1_ps(c.signed_default_q);
+  const __m256 unsigned_default_q = _mm256_set1_ps(c.unsigned_default_q);
+
+  __m256 best_score = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+  __m256i best_index = _mm256_set1_epi32(-1);
+  __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256 sum_unsigned_q = zero;
+
+  PuctChoice choice;
+  size_t i = 0;
+  for (; i + 8 <= e.n; i += 8) {
+    const __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(e.num_visits + i)));
+    const __m256 reward = _mm256_loadu_ps(e.reward + i);
+    const __m256 loss = _mm256_loadu_ps(e.virtual_loss + i);
+
+    const __m256 r = _mm256_sub_ps(_mm256_mul_ps(reward, sign), loss);
+    const __m256 v_with_loss = _mm256_add_ps(v, loss);
+    const __m256 q = _mm256_blendv_ps(
+        signed_default_q,
+        _mm256_div_ps(r, v_with_loss),
+        _mm256_cmp_ps(v_with_loss, zero, _CMP_GT_OQ));
+    const __m256 p = _mm256_div_ps(
+        _mm256_mul_ps(_mm256_loadu_ps(e.prior + i), prior_weight),
+        _mm256_add_ps(one, v));
+    const __m256 score = _mm256_add_ps(p, q);
+
+    const __m256 unsigned_q = _mm256_blendv_ps(
+        unsigned_default_q,
+        _mm256_div_ps(reward, v),
+        _mm256_cmp_ps(v, zero, _CMP_GT_OQ));
+    const __m256 counted = _mm256_cmp_ps(v_with_loss, zero, _CMP_NEQ_OQ);
+    sum_unsigned_q =
+        _mm256_add_ps(sum_unsigned_q, _mm256_and_ps(counted, unsigned_q));
+    choice.total_visits += __builtin_popcount(_mm256_movemask_ps(counted));
+
+    const __m256 better = _mm256_cmp_ps(score, best_score, _CMP_GT_OQ);
+    best_score = _mm256_blendv_ps(best_score, score, better);
+    best_index = _mm256_castps_si256(_mm256_blendv_ps(
+        _mm256_castsi256_ps(best_index), _mm256_castsi256_ps(index), better));
+    index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+  }
+
+  alignas(32) float scores[8];
+  alignas(32) int indices[8];
+  alignas(32) float sums[8];
+  _mm256_store_ps(scores, best_score);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(indices), best_index);
+  _mm256_store_ps(sums, sum_unsigned_q);
+  puctReduceLanes(scores, indices, 8, &choice);
+  for (int l = 0; l < 8; ++l) {
+    choice.total_unsigned_q += sums[l];
+  }
+
+  puctSelectTail(e, c, i, &choice);
+  return choice;
+}
+#endif
+
+#ifdef ELF_TARGET_AVX512
+ELF_TARGET_AVX512 inline PuctChoice puctSelectAVX512(
+    const PuctEdges& e,
+    const PuctConsts& c) {
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const __m512 prior_weight = _mm512_set1_ps(c.prior_weight);
+  const __m512 sign = _mm512_set1_ps(c.sign);
+  const __m512 signed_default_q = _mm512_set1_ps(c.signed_default_q);
+  const __m512 unsigned_default_q = _mm512_set1_ps(c.unsigned_default_q);
+
+  __m512 best_score = _mm512_set1_ps(std::numeric_limits<float>::lowest());
+  __m512i best_index = _mm512_set1_epi32(-1);
+  __m512i index = _mm512_setr_epi32(
+      0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __m512 sum_unsigned_q = zero;
+
+  PuctChoice choice;
+  size_t i = 0;
+  for (; i + 16 <= e.n; i += 16) {
+    const __m512 v = _mm512_cvtepi32_ps(_mm512_loadu_si512(e.num_visits + i));
+    const __m512 reward = _mm512_loadu_ps(e.reward + i);
+    const __m512 loss = _mm512_loadu_ps(e.virtual_loss + i);
+
+    const __m512 r = _mm512_sub_ps(_mm512_mul_ps(reward, sign), loss);
+    const __m512 v_with_loss = _mm512_add_ps(v, loss);
+    const __m512 q = _mm512_mask_div_ps(
+        signed_default_q,
+        _mm512_cmp_ps_mask(v_with_loss, zero, _CMP_GT_OQ),
+        r,
+        v_with_loss);
+    const __m512 p = _mm512_div_ps(
+        _mm512_mul_ps(_mm512_loadu_ps(e.prior + i), prior_weight),
+        _mm512_add_ps(one, v));
+    const __m512 score = _mm512_add_ps(p, q);
+
+    const __m512 unsigned_q = _mm512_mask_div_ps(
+        unsigned_default_q, _mm512_cmp_ps_mask(v, zero, _CMP_GT_OQ), reward, v);
+    const __mmask16 counted =
+        _mm512_cmp_ps_mask(v_with_loss, zero, _CMP_NEQ_OQ);
+    sum_unsigned_q =
+        _mm512_mask_add_ps(sum_unsigned_q, counted, sum_unsigned_q, unsigned_q);
+    choice.total_visits += __builtin_popcount(counted);
+
+    const __mmask16 better = _mm512_cmp_ps_mask(score, best_score, _CMP_GT_OQ);
+    best_score = _mm512_mask_blend_ps(better, best_score, score);
+    best_index = _mm512_mask_blend_epi32(better, best_index, index);
+    index = _mm512_add_epi32(index, _mm512_set1_epi32(16));
+  }
+
+  alignas(64) float scores[16];
+  alignas(64) int indices[16];
+  alignas(64) float sums[16];
+  _mm512_store_ps(scores, best_score);
+  _mm512_store_si512(indices, best_index);
+  _mm512_store_ps(sums, sum_unsigned_q);
+  puctReduceLanes(scores, indices, 16, &choice);
+  for (int l = 0; l < 16; ++l) {
+    choice.total_unsigned_q += sums[l];
+  }
+
+  puctSelectTail(e, c, i, &choice);
+  return choice;
+}
+#endif
+
+} // namespace detail
+
+inline PuctChoice puctSelectScalar(
+    const PuctEdges& e,
+    const PuctParams& params) {
+  PuctChoice choice;
+  detail::puctSelectTail(e, detail::PuctConsts(params), 0, &choice);
+  return choice;
+}
+
+constexpr size_t kMinSimdEdges = 16;
+
+inline PuctChoice puctSelect(const PuctEdges& e, const PuctParams& params) {
+#ifdef ELF_TARGET_AVX2
+  if (e.n >= kMinSimdEdges && elf_utils::cpu_has_avx2()) {
+    return detail::puctSelectAVX2(e, detail::PuctConsts(params));
+  }
+#endif
+  return puctSelectScalar(e, params);
+}
+
+} // namespace tree_search
+} // namespace ai
+} // namespace elf
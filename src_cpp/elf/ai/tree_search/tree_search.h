@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -29,6 +31,7 @@
 
 #include "tree_search_node.h"
 #include "tree_search_options.h"
+#include "tree_search_stats.h"
 
 /*eval_num_games
  * Use the following function of S
@@ -96,6 +99,11 @@ class TreeSearchSingleThreadT {
 		runInfoWhenStateReady_.push(num_rollout);
 	}
 
+	// Of the last run(), once it is done.
+	const SearchStats& getStats() const {
+		return stats_;
+	}
+
 
 
 	 /* run() will iterates n_rollout times: 
@@ -118,6 +126,7 @@ class TreeSearchSingleThreadT {
 		int num_rollout;
 
 		runInfoWhenStateReady_.pop(&num_rollout);
+		stats_ = SearchStats();
 
 		Node* root = search_tree.getRootNode();
 		if (root == nullptr || root->getStatePtr() == nullptr) {
@@ -155,15 +164,16 @@ class TreeSearchSingleThreadT {
 	int threadId_;
 	const TSOptions& options_;
 
-	// Нода - экшн и листок от этого экшена
+	// Нода - индекс ребра и листок от этого ребра
 	struct Traj {
-		std::vector<std::pair<Node*, Action>> traj;
+		std::vector<std::pair<Node*, int>> traj;
 		Node* leaf;
 	};
 
 	// TODO: The weird variable name below needs to change (ssengupta@fb)
 	elf::concurrency::ConcurrentQueue<int> runInfoWhenStateReady_;
 	std::unique_ptr<std::ostream> output_;
+	SearchStats stats_;
 
 	std::shared_ptr<spdlog::logger> logger_;
 
@@ -244,6 +254,8 @@ class TreeSearchSingleThreadT {
 			Actor& actor,
 			Tree& search_tree) {
 
+		auto start = std::chrono::steady_clock::now();
+
 		// Start from the root and run one path
 		std::vector<Traj> trajs;
 
@@ -254,6 +266,7 @@ class TreeSearchSingleThreadT {
 		for (int j = 0; j < options_.num_rollouts_per_batch; ++j) {
 			trajs.push_back(single_rollout<Actor>(ctx, root, actor, search_tree));
 		}
+		stats_.select_ns += lapNs(start);
 
 		// Now we want to batch create nodes.
 		std::vector<Node*> locked_leaves;
@@ -272,28 +285,38 @@ class TreeSearchSingleThreadT {
 			}
 
 			auto it = traj_counts.find(traj.leaf);
-			if (it == traj_counts.end())
+			if (it == traj_counts.end()) {
 				traj_counts[traj.leaf] = std::make_pair(&traj, 1);
-			else
+			} else {
 				it->second.second++;
+				stats_.num_duplicate_leaves++;
+			}
 		}
 
 		// Batch evaluate.
 		std::vector<NodeResponseT<Action>> resps;
 		actor.evaluate(locked_states, &resps);
+		stats_.num_evaluations += locked_leaves.size();
+		stats_.evaluate_ns += lapNs(start);
 
 		for (size_t j = 0; j < locked_leaves.size(); ++j) {
 			// Now the node points to a recently created node.
 			// Evaluate it and backpropagate.
 			locked_leaves[j]->setEvaluation(resps[j]);
 		}
+		stats_.expand_ns += lapNs(start);
+
+		// Leaves that other threads sent to evaluation.
+		for (auto& traj_pair : traj_counts) {
+			traj_pair.first->waitEvaluation();
+		}
+		stats_.evaluate_ns += lapNs(start);
 
 		for (auto& traj_pair : traj_counts) {
 			Node* leaf = traj_pair.first;
 			Traj* traj = traj_pair.second.first;
 			int count = traj_pair.second.second;
 
-			leaf->waitEvaluation();
 			float reward = get_reward(actor, leaf);
 			// PRINT_TS("Reward: " << reward << " Start backprop");
 
@@ -303,6 +326,7 @@ class TreeSearchSingleThreadT {
 						p.second, reward, options_.virtual_loss * count);
 			}
 		}
+		stats_.backup_ns += lapNs(start);
 
 		printHelper(ctx, "Done backprop");
 	}
@@ -328,11 +352,12 @@ class TreeSearchSingleThreadT {
 		// находим ноду которую не посещали
 		while (node->isVisited()) {
 			// If there is no move available, skip.
-			Action action;
+			int edge;
 			bool has_move =
-					node->findMove(options_.alg_opt, ctx.depth, &action, output_.get());
+					node->findMove(options_.alg_opt, ctx.depth, &edge, output_.get());
 			if (!has_move) {
 				printHelper(ctx, "No available action");
+				stats_.num_terminal_hits++;
 				break;
 			}
 
@@ -340,16 +365,27 @@ class TreeSearchSingleThreadT {
 
 			// Add virtual loss if there is any.
 			if (options_.virtual_loss > 0) {
-				node->addVirtualLoss(action, options_.virtual_loss);
+				node->addVirtualLoss(edge, options_.virtual_loss);
 			}
 
 			// Save trajectory.
-			traj.traj.push_back(std::make_pair(node, action));
-			NodeId next = node->followEdge(action, search_tree);
+			traj.traj.push_back(std::make_pair(node, edge));
+			NodeId next = node->followEdge(edge, search_tree);
 			// PRINT_TS(" Descent node id: " << next);
 
 			assert(node->getStatePtr());
 
+			// The tree is out of nodes: node is the leaf, and the value it
+			// already has is backed up.
+			if (next == InvalidNodeId) {
+				if (options_.virtual_loss > 0) {
+					node->addVirtualLoss(edge, -options_.virtual_loss);
+				}
+				traj.traj.pop_back();
+				printHelper(ctx, "Tree is full");
+				break;
+			}
+
 			// Note that next might be invalid, if there is not valid move.
 			Node* next_node = search_tree[next];
 			if (next_node == nullptr) {
@@ -362,7 +398,8 @@ class TreeSearchSingleThreadT {
 			// actor takes action with node's state. If this
 			// action is valid, then next_node is set with the new state
 			// Otherwise next_node's state is a nullptr
-			if (!allocateState(node, action, actor, next_node)) {
+			if (!allocateState(node, node->getAction(edge), actor, next_node)) {
+				stats_.num_terminal_hits++;
 				break;
 			}
 
@@ -374,6 +411,8 @@ class TreeSearchSingleThreadT {
 			ctx.incDepth();
 		}
 		traj.leaf = node;
+		stats_.num_rollouts++;
+		stats_.total_depth += traj.traj.size();
 		return traj;
 	}
 };
@@ -413,6 +452,7 @@ class TreeSearchT {
 	TreeSearchT(const TSOptions& options, std::function<Actor*(int)> actor_gen)
 			: options_(options),
 				stopSearch_(false),
+				stopRollouts_(false),
 				logger_(elf::logging::getIndexedLogger(
 						"elf::ai::tree_search::TreeSearchT-",
 						"")) {
@@ -421,26 +461,45 @@ class TreeSearchT {
 			actors_.emplace_back(actor_gen(i));
 		}
 
+		// Root parallelism: thread i searches tree i % num_trees.
+		int num_trees =
+				std::max(1, std::min(options.num_trees, options.num_threads));
+		// The trees only differ by their root noise. Without any they would
+		// make the same selections, so the threads share one tree instead.
+		if (num_trees > 1 && options.root_epsilon <= 0.0 &&
+				options.tree_epsilon <= 0.0) {
+			logger_->warn(
+					"{} trees without root noise (root_epsilon, tree_epsilon) would "
+					"search alike, using one tree",
+					num_trees);
+			num_trees = 1;
+		}
+		for (int k = 0; k < num_trees; ++k) {
+			trees_.emplace_back(
+					new Tree(options.max_nodes_per_tree, options.max_nodes_per_process));
+		}
+
 		// std::vector<std::thread> threadPool_;
 		// std::vector<std::unique_ptr<TreeSearchSingleThread>> treeSearches_;
 		// std::vector<std::unique_ptr<Actor>> actors_;
 
 		for (int i = 0; i < options.num_threads; ++i) {
 			TreeSearchSingleThread* th = treeSearches_[i].get();
+			Tree* tree = trees_[i % trees_.size()].get();
 
 			// [i, this, th] - области видимости lambda функции
 			// () - параметры
 			// {} - тело функции
 			threadPool_.emplace_back(std::thread{
-				[i, this, th]() {
+				[i, this, th, tree]() {
 				int counter = 0;
 				while (true) {
 					th->run(
 							counter,
 							// &this->done_.flag(),
-							&this->stopSearch_,
+							&this->stopRollouts_,
 							*this->actors_[i],
-							this->tree_);
+							*tree);
 
 					// if (this->done_.get()) {
 					if (this->stopSearch_.load()) {
@@ -468,8 +527,23 @@ class TreeSearchT {
 		return actors_.size();
 	}
 
+	size_t getNumTrees() const {
+		return trees_.size();
+	}
+
+	// Of the last run(). The process totals are in getProcessSearchStats().
+	const SearchStats& getLastStats() const {
+		return lastStats_;
+	}
+
+	// The first tree only, with root parallelism.
 	std::string printTree() const {
-		return tree_.printTree();
+		return trees_[0]->printTree();
+	}
+
+	// The root edges of tree k, before the trees are merged by run().
+	std::vector<std::pair<Action, EdgeInfo>> getTreeRootActions(size_t k) const {
+		return trees_[k]->getRootNode()->getStateActions();
 	}
 
 	MCTSResult runPolicyOnly(const State& root_state) {
@@ -477,10 +551,11 @@ class TreeSearchT {
 			throw std::range_error(
 					"TreeSearch::runPolicyOnly works when there is at least one thread");
 		}
+		stopPondering();
 		setRootNodeState(root_state);
 
 		// Some hack here.
-		Node* root = tree_.getRootNode();
+		Node* root = trees_[0]->getRootNode();
 
 		if (!root->isVisited()) {
 			NodeResponseT<Action> resp;
@@ -497,12 +572,28 @@ class TreeSearchT {
 
 	// get root -> notify search -> wait until count -> reset -> chooseAction;
 	MCTSResult run(const State& root_state) {
+		stopPondering();
 		setRootNodeState(root_state);
 
-		if (options_.root_epsilon > 0.0) {
-			Node* root = tree_.getRootNode();
-			root->enhanceExploration(
-					options_.root_epsilon, options_.root_alpha, actors_[0]->rng());
+		SearchStats stats;
+		stats.num_searches = 1;
+		stats.nodes_freed = treeSize();
+		pruneTree();
+		stats.nodes_freed -= treeSize();
+		stats.nodes_allocated = -numAddedNodes();
+
+		// The noise mixes into the priors, so the roots are evaluated first.
+		// They share the state, so one evaluation serves all the trees.
+		evaluateRoots();
+		for (size_t k = 0; k < trees_.size(); ++k) {
+			Node* root = trees_[k]->getRootNode();
+			if (options_.root_epsilon > 0.0) {
+				root->enhanceExploration(
+						options_.root_epsilon, options_.root_alpha, rootRng(k));
+			} else if (k > 0) {
+				root->enhanceExploration(
+						options_.tree_epsilon, options_.tree_alpha, rootRng(k));
+			}
 		}
 
 		notifySearches(options_.num_rollouts_per_thread);
@@ -511,20 +602,57 @@ class TreeSearchT {
 		treeReady_.waitUntilCount(threadPool_.size());
 		treeReady_.reset();
 
+		stats += threadStats();
+		stats.nodes_allocated += numAddedNodes();
+		stats.tree_size = treeSize();
+		lastStats_ = stats;
+		addProcessSearchStats(stats);
 
 		return chooseAction();
 	}
 
+	// Keep searching from root_state in the background, at most
+	// options_.ponder_rollouts_per_thread rollouts per thread. Anything
+	// else done on the tree stops it first.
+	void ponder(const State& root_state) {
+		stopPondering();
+		setRootNodeState(root_state);
+		pruneTree();
+
+		notifySearches(options_.ponder_rollouts_per_thread);
+		pondering_ = true;
+	}
+
+	void stopPondering() {
+		if (!pondering_) {
+			return;
+		}
+
+		stopRollouts_ = true;
+		treeReady_.waitUntilCount(threadPool_.size());
+		treeReady_.reset();
+		stopRollouts_ = false;
+		pondering_ = false;
+		addProcessSearchStats(threadStats());
+	}
+
 	void treeAdvance(const Action& action) {
-		tree_.treeAdvance(action);
+		stopPondering();
+		for (auto& tree : trees_) {
+			tree->treeAdvance(action);
+		}
 	}
 
 	void clear() {
-		tree_.clear();
+		stopPondering();
+		for (auto& tree : trees_) {
+			tree->clear();
+		}
 	}
 
 	void stop() {
 		stopSearch_ = true;
+		stopRollouts_ = true;
 
 		notifySearches(0);
 
@@ -551,10 +679,16 @@ class TreeSearchT {
 
 	std::unique_ptr<std::ostream> output_;
 
-	Tree tree_;
+	// One tree, or options_.num_trees with root parallelism.
+	std::vector<std::unique_ptr<Tree>> trees_;
+
+	SearchStats lastStats_;
 
 	TSOptions options_;
 	std::atomic<bool> stopSearch_;
+	// Ends the rollouts of the threads, for good or only to stop pondering.
+	std::atomic<bool> stopRollouts_;
+	bool pondering_ = false;
 	// Notif done_;
 	elf::concurrency::Counter<size_t> treeReady_;
 	elf::concurrency::Counter<size_t> countStoppedThreads_;
@@ -567,49 +701,154 @@ class TreeSearchT {
 		}
 	}
 
+	// Summed over the threads, once they are done.
+	SearchStats threadStats() const {
+		SearchStats stats;
+		for (const auto& th : treeSearches_) {
+			stats += th->getStats();
+		}
+		return stats;
+	}
+
+	int64_t treeSize() const {
+		int64_t size = 0;
+		for (const auto& tree : trees_) {
+			size += tree->size();
+		}
+		return size;
+	}
+
+	int64_t numAddedNodes() const {
+		int64_t added = 0;
+		for (const auto& tree : trees_) {
+			added += tree->getNumAdded();
+		}
+		return added;
+	}
+
+	void evaluateRoots() {
+		NodeResponseT<Action> resp;
+		bool evaluated = false;
+		for (auto& tree : trees_) {
+			Node* root = tree->getRootNode();
+			if (root->isVisited()) {
+				continue;
+			}
+			if (!evaluated) {
+				actors_[0]->evaluate(*root->getStatePtr(), &resp);
+				evaluated = true;
+			}
+			root->setEvaluation(resp);
+		}
+	}
+
+	// Thread k searches tree k, so its actor holds the seed of the tree.
+	std::mt19937* rootRng(size_t k) {
+		return actors_[k]->rng();
+	}
+
+	// Leaves each tree half of its node budget for the coming search, or
+	// halves the trees if all the trees of the process are over theirs.
+	void pruneTree() {
+		const bool process_full = options_.max_nodes_per_process > 0 &&
+				processNodeCount() >= options_.max_nodes_per_process;
+
+		for (auto& tree : trees_) {
+			size_t max_nodes = tree->size();
+			if (options_.max_nodes_per_tree > 0) {
+				max_nodes =
+						std::min(max_nodes, size_t(options_.max_nodes_per_tree / 2));
+			}
+			if (process_full) {
+				max_nodes = std::min(max_nodes, tree->size() / 2);
+			}
+
+			if (max_nodes < tree->size()) {
+				tree->prune(max_nodes);
+			}
+		}
+	}
+
 	void setRootNodeState(const State& root_state) {
-		Node* root = tree_.getRootNode();
+		for (auto& tree : trees_) {
+			Node* root = tree->getRootNode();
+
+			if (root == nullptr) {
+				throw std::range_error("TreeSearch::root cannot be null!");
+			}
+
+			root->setStateIfUnset([&]() { return new State(root_state); });
 
-		if (root == nullptr) {
-			throw std::range_error("TreeSearch::root cannot be null!");
+			// Check hash code.
+			if (!elf::ai::tree_search::StateTrait<State, Action>::equals(
+							root_state, *root->getStatePtr())) {
+				throw std::range_error(
+						"TreeSearch::Root state is not the same as the input state");
+			}
 		}
+	}
 
-		root->setStateIfUnset([&]() { return new State(root_state); });
+	// Edges of the root, summed over the trees with root parallelism. The
+	// priors and the value are averaged, as the trees differ only by their
+	// root noise.
+	std::vector<std::pair<Action, EdgeInfo>> rootActions(
+			float* root_value) const {
+		const Node* root = trees_[0]->getRootNode();
+		std::vector<std::pair<Action, EdgeInfo>> actions = root->getStateActions();
+		*root_value = root->getValue();
+
+		for (size_t k = 1; k < trees_.size(); ++k) {
+			const Node* other = trees_[k]->getRootNode();
+			*root_value += other->getValue();
+
+			for (auto& p : actions) {
+				int edge = other->findEdge(p.first);
+				if (edge < 0) {
+					continue;
+				}
+				EdgeInfo info = other->getEdge(edge);
+				p.second.prior_probability += info.prior_probability;
+				p.second.reward += info.reward;
+				p.second.num_visits += info.num_visits;
+				p.second.virtual_loss += info.virtual_loss;
+			}
+		}
 
-		// Check hash code.
-		if (!elf::ai::tree_search::StateTrait<State, Action>::equals(
-						root_state, *root->getStatePtr())) {
-			throw std::range_error(
-					"TreeSearch::Root state is not the same as the input state");
+		for (auto& p : actions) {
+			p.second.prior_probability /= trees_.size();
 		}
+		*root_value /= trees_.size();
+		return actions;
 	}
 
 	// get results from the hash table SA
 	MCTSResult chooseAction() const {    
-		const Node* root = tree_.getRootNode();
-		if (root == nullptr) {
-			throw std::range_error("TreeSearch::root cannot be null!");
+		for (const auto& tree : trees_) {
+			if (tree->getRootNode() == nullptr) {
+				throw std::range_error("TreeSearch::root cannot be null!");
+			}
 		}
 
 		// Pick the best solution.
 		MCTSResult result;
-		result.root_value = root->getValue();
+		std::vector<std::pair<Action, EdgeInfo>> actions =
+				rootActions(&result.root_value);
 
 		// MCTSResult result2;
 		if (options_.pick_method == "strongest_prior") {
 			result.action_rank_method = MCTSResult::PRIOR;
-			result.addActions(root->getStateActions());
+			result.addActions(actions);
 			// result2 = StrongestPrior(root->getStateActions());
 		} else if (options_.pick_method == "most_visited") {
 			result.action_rank_method = MCTSResult::MOST_VISITED;
-			result.addActions(root->getStateActions());
+			result.addActions(actions);
 			// result2 = MostVisited(root->getStateActions());
 
 			// assert(result.max_score == result2.max_score);
 			// assert(result.total_visits == result2.total_visits);
 		} else if (options_.pick_method == "uniform_random") {
 			result.action_rank_method = MCTSResult::UNIFORM_RANDOM;
-			result.addActions(root->getStateActions());
+			result.addActions(actions);
 			// result = UniformRandom(root->getStateActions());
 		} else {
 			throw std::range_error(
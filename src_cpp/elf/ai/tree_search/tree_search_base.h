@@ -307,7 +307,8 @@ struct MCTSResultT {
 
   // TODO: This function should be private and called from the constructor
   //       ssengupta@fb.com
-  void addActions(const std::unordered_map<Action, EdgeInfo>& action_edges) {
+  void addActions(
+      const std::vector<std::pair<Action, EdgeInfo>>& action_edges) {
     static std::mt19937 rng(time(NULL));
     int random_idx = 0;
 
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <memory>
@@ -18,8 +19,12 @@
 #include <unordered_map>
 #include <vector>
 
+#include "elf/concurrency/ConcurrentQueue.h"
+
+#include "puct_kernel.h"
 #include "tree_search_base.h"
 #include "tree_search_options.h"
+#include "tree_search_stats.h"
 
 namespace elf {
 namespace ai {
@@ -28,6 +33,20 @@ namespace tree_search {
 template <typename State, typename Action>
 class TreeT;
 
+// The PUCT kernels read the edge stats as plain arrays.
+static_assert(
+    sizeof(std::atomic<float>) == sizeof(float) &&
+        sizeof(std::atomic<int>) == sizeof(int),
+    "edge stats must be laid out as plain arrays");
+
+// std::atomic<float> has no fetch_add before C++20.
+inline void atomicAdd(std::atomic<float>& x, float delta) {
+  float old = x.load(std::memory_order_relaxed);
+  while (!x.compare_exchange_weak(
+      old, old + delta, std::memory_order_relaxed)) {
+  }
+}
+
 template <typename State>
 class NodeBaseT {
  public:
@@ -95,6 +114,24 @@ class NodeBaseT {
 
 
 // Tree node.
+//
+// The edges are sorted by prior, highest first, and an edge is known by
+// its index in that order. Until UCT first picks an edge, all it keeps is
+// its action and prior: an edge gets stats when a search first reaches
+// it, in chunks of kEdgeChunk edges, and the edges are only sorted one
+// past those. Edges not reached yet have no visit and the same q, so the
+// one of them that UCT would pick is the first one, which it scores
+// alongside the others. The node thus searches as if it had all its
+// edges, but most nodes of wide games (ugolki) never allocate stats for
+// more than a chunk. The edges past the sorted ones may still move.
+// Nodes of at most kEagerEdges edges (both checkers games) get all their
+// stats at once, in the order of the policy: sorting and growing them
+// edge by edge costs more than it saves.
+//
+// The stats of an edge are atomics that the search threads update with
+// no lock; only the allocation of a chunk and the creation of a child take
+// lockNode_. A search may see the reward of a backup before its visit,
+// which UCT tolerates as it does virtual losses, but no update is lost.
 template <typename State, typename Action>
 class NodeT : public NodeBaseT<State> {
  public:
@@ -107,18 +144,84 @@ class NodeT : public NodeBaseT<State> {
     VISITED,
   };
 
+  // Edges whose stats are allocated together, and scored by one call of
+  // the PUCT kernel.
+  static constexpr size_t kEdgeChunk = kMinSimdEdges;
+  static constexpr size_t kEagerEdges = 2 * kEdgeChunk;
+
   NodeT(float unsigned_parent_q)
       : status_(NOT_VISITED),
         numVisits_(0),
         unsignedParentQ_(unsigned_parent_q) {
     unsignedMeanQ_ = unsignedParentQ_;
+    processNodeCount()++;
+    processNodesAllocated()++;
   }
 
   NodeT(const Node&) = delete;
   Node& operator=(const Node&) = delete;
 
-  const std::unordered_map<Action, EdgeInfo>& getStateActions() const {
-    return stateActions_;
+  ~NodeT() {
+    processNodeCount()--;
+  }
+
+  size_t getNumEdges() const {
+    return actions_.size();
+  }
+
+  // Edges reached by a search, with their stats allocated.
+  size_t getNumMaterializedEdges() const {
+    return numMaterialized_.load();
+  }
+
+  const Action& getAction(int edge) const {
+    return actions_[order_[edge]];
+  }
+
+  NodeId getChild(int edge) const {
+    if (!isMaterialized(edge)) {
+      return InvalidNodeId;
+    }
+    return chunk(edge).children[edge % kEdgeChunk].load();
+  }
+
+  // Copy of the stats of an edge.
+  EdgeInfo getEdge(int edge) const {
+    EdgeInfo info(priors_[order_[edge]]);
+    if (isMaterialized(edge)) {
+      const EdgeChunk& c = chunk(edge);
+      const size_t i = edge % kEdgeChunk;
+      info.child_node = c.children[i].load();
+      info.reward = c.rewards[i].load();
+      info.num_visits = c.visits[i].load();
+      info.virtual_loss = c.virtualLosses[i].load();
+    }
+    return info;
+  }
+
+  // -1 if action has no edge.
+  int findEdge(const Action& action) const {
+    for (size_t i = 0; i < order_.size(); ++i) {
+      if (actions_[order_[i]] == action) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Copy of all the edges, in the order of the policy.
+  std::vector<std::pair<Action, EdgeInfo>> getStateActions() const {
+    std::vector<int> edges(order_.size());
+    for (size_t i = 0; i < order_.size(); ++i) {
+      edges[order_[i]] = i;
+    }
+
+    std::vector<std::pair<Action, EdgeInfo>> action_edges;
+    action_edges.reserve(actions_.size());
+    for (size_t i = 0; i < actions_.size(); ++i) {
+      action_edges.emplace_back(actions_[i], getEdge(edges[i]));
+    }
+    return action_edges;
   }
 
   int getNumVisits() const {
@@ -151,18 +254,40 @@ class NodeT : public NodeBaseT<State> {
     std::gamma_distribution<> dis(alpha);
 
     // Draw distribution.
-    std::vector<float> etas(stateActions_.size());
+    std::vector<float> etas(priors_.size());
     float Z = 1e-10;
-    for (size_t i = 0; i < stateActions_.size(); ++i) {
+    for (size_t i = 0; i < priors_.size(); ++i) {
       etas[i] = dis(*rng);
       Z += etas[i];
     }
 
-    int i = 0;
-    for (auto& p : stateActions_) {
-      p.second.prior_probability =
-          (1 - epsilon) * p.second.prior_probability + epsilon * etas[i] / Z;
-      i++;
+    for (size_t i = 0; i < priors_.size(); ++i) {
+      priors_[i] = (1 - epsilon) * priors_[i] + epsilon * etas[i] / Z;
+    }
+
+    // The edges are sorted again for the new priors, keeping their stats.
+    std::vector<std::pair<uint32_t, EdgeInfo>> infos;
+    for (size_t i = 0; i < getNumMaterializedEdges(); ++i) {
+      infos.emplace_back(order_[i], getEdge(i));
+    }
+    resetEdges(order_.size());
+
+    std::vector<int> edges(order_.size());
+    for (size_t i = 0; i < order_.size(); ++i) {
+      edges[order_[i]] = i;
+    }
+    for (const auto& p : infos) {
+      const EdgeInfo& info = p.second;
+      if (info.child_node == InvalidNodeId && info.num_visits == 0 &&
+          info.reward == 0 && info.virtual_loss == 0) {
+        continue;
+      }
+      const int edge = edges[p.first];
+      EdgeChunk& c = materialize(edge);
+      c.children[edge % kEdgeChunk] = info.child_node;
+      c.rewards[edge % kEdgeChunk] = info.reward;
+      c.visits[edge % kEdgeChunk] = info.num_visits;
+      c.virtualLosses[edge % kEdgeChunk] = info.virtual_loss;
     }
   }
 
@@ -194,22 +319,22 @@ class NodeT : public NodeBaseT<State> {
     if (status_ == VISITED)
       return false;
 
-    // Then we need to allocate sa_val_
-    for (const std::pair<Action, float>& action_pair : resp.pi) {
-      stateActions_.insert(
-          std::make_pair(action_pair.first, EdgeInfo(action_pair.second)));
-      lockStateActions_[action_pair.first].reset(new std::mutex());
-
-      // Compute v here.
-      // Node *child = alloc[res.first->second.next];
-      // child->V_ = V_ + log(action_pair.second + 1e-6);
+    // Then we need to allocate the edges.
+    actions_.clear();
+    priors_.clear();
+    actions_.reserve(resp.pi.size());
+    priors_.reserve(resp.pi.size());
+    for (const auto& p : resp.pi) {
+      actions_.push_back(p.first);
+      priors_.push_back(p.second);
     }
+    resetEdges(1);
 
     // value
     V_ = resp.value;
     flipQSign_ = resp.q_flip;
 
-    // Once sa_ is allocated, its structure won't change.
+    // Once the edges are allocated, their structure won't change.
     status_ = VISITED;
     return true;
   }
@@ -219,14 +344,14 @@ class NodeT : public NodeBaseT<State> {
       const SearchAlgoOptions& alg_opt,
       int node_depth,
       // const NodeDynInfo& node_info,
-      Action* action,
+      int* edge,
       std::ostream* oo = nullptr) {
     if (status_ != VISITED)
       return false;
 
     std::lock_guard<std::mutex> lock(lockNode_);
 
-    if (stateActions_.empty()) {
+    if (actions_.empty()) {
       return false;
     }
 
@@ -235,95 +360,103 @@ class NodeT : public NodeBaseT<State> {
       unsignedMeanQ_ = 0.0;
     }
 
-    BestAction best_action = UCT(alg_opt, oo);
-    *action = best_action.action_with_max_score;
-    unsignedMeanQ_ = (unsignedParentQ_ + best_action.total_unsigned_q) /
-        (best_action.total_visits + 1);
+    PuctChoice choice = UCT(alg_opt, oo);
+    if (choice.best < 0) {
+      return false;
+    }
+    *edge = choice.best;
+    unsignedMeanQ_ = (unsignedParentQ_ + choice.total_unsigned_q) /
+        (choice.total_visits + 1);
 
     return true;
   }
 
-  bool addVirtualLoss(const Action& action, float virtual_loss) {
+  bool addVirtualLoss(int edge, float virtual_loss) {
     if (status_ != VISITED)
       return false;
 
-    auto it = stateActions_.find(action);
-
-    if (it == stateActions_.end()) {
-      return false;
-    }
-
-    EdgeInfo& info = it->second;
-
-    auto lock_it = lockStateActions_.find(action);
-    assert(lock_it != lockStateActions_.end());
-    std::lock_guard<std::mutex> lock(*(lock_it->second.get()));
-
-    info.virtual_loss += virtual_loss;
+    atomicAdd(materialize(edge).virtualLosses[edge % kEdgeChunk], virtual_loss);
     return true;
   }
 
   // backup value
-  bool updateEdgeStats(const Action& action, float reward, float virtual_loss) {
+  bool updateEdgeStats(int edge, float reward, float virtual_loss) {
     if (status_ != VISITED)
       return false;
 
-    auto it = stateActions_.find(action);
-    if (it == stateActions_.end()) {
-      return false;
-    }
-
-    EdgeInfo& edge = it->second;
-
     numVisits_++;
 
-    // Async modification (we probably need to add a locker in the future, or
-    // not for speed).
-
-    auto lock_it = lockStateActions_.find(action);
-    assert(lock_it != lockStateActions_.end());
-    std::lock_guard<std::mutex> lock(*(lock_it->second.get()));
-
-    edge.reward += reward;
-    edge.num_visits++;
+    EdgeChunk& c = materialize(edge);
+    const size_t i = edge % kEdgeChunk;
+    atomicAdd(c.rewards[i], reward);
+    c.visits[i].fetch_add(1, std::memory_order_relaxed);
     // Reduce virtual loss.
-    edge.virtual_loss -= virtual_loss;
+    atomicAdd(c.virtualLosses[i], -virtual_loss);
     return true;
   }
 
-  // tree adds a new node
-  NodeId followEdge(const Action& action, Tree& tree) {
-    if (status_ != VISITED)
-      return InvalidNodeId;
-
-    auto it = stateActions_.find(action);
-    if (it == stateActions_.end()) {
+  // Forgets the child of the edge but keeps the stats of the edge. The
+  // child is added again if the search comes back to it. Only when no
+  // search runs on the tree.
+  NodeId detachChild(int edge) {
+    if (!isMaterialized(edge)) {
       return InvalidNodeId;
     }
+    return chunk(edge).children[edge % kEdgeChunk].exchange(InvalidNodeId);
+  }
 
-    EdgeInfo& edge = it->second;
+  // tree adds a new node, InvalidNodeId if the tree is full
+  NodeId followEdge(int edge, Tree& tree) {
+    if (status_ != VISITED)
+      return InvalidNodeId;
 
-    if (edge.child_node == InvalidNodeId) {
-      auto lock_it = lockStateActions_.find(action);
-      assert(lock_it != lockStateActions_.end());
-      std::lock_guard<std::mutex> lock(*(lock_it->second.get()));
+    std::atomic<NodeId>& child = materialize(edge).children[edge % kEdgeChunk];
+    if (child == InvalidNodeId) {
+      std::lock_guard<std::mutex> lock(lockNode_);
 
       // Need to check twice.
-      if (edge.child_node == InvalidNodeId) {
-        edge.child_node = tree.addNode(unsignedMeanQ_);
+      if (child == InvalidNodeId) {
+        child = tree.addNode(unsignedMeanQ_);
       }
     }
-    return edge.child_node;
+    return child;
   }
 
  private:
   // for unit-test purpose only
   friend class NodeTest;
 
+  // Prior, child, accumulated reward, #trial and virtual loss of
+  // kEdgeChunk edges. The priors are copied here for the PUCT kernel.
+  struct EdgeChunk {
+    float priors[kEdgeChunk] = {};
+    std::atomic<NodeId> children[kEdgeChunk];
+    std::atomic<float> rewards[kEdgeChunk] = {};
+    std::atomic<int> visits[kEdgeChunk] = {};
+    std::atomic<float> virtualLosses[kEdgeChunk] = {};
+
+    // The chunk is published by the store of numMaterialized_, so its
+    // initial values need no fence of their own.
+    EdgeChunk() {
+      for (size_t i = 0; i < kEdgeChunk; ++i) {
+        children[i].store(InvalidNodeId, std::memory_order_relaxed);
+      }
+    }
+  };
+
   std::atomic<VisitType> status_;
   std::mutex lockNode_;
-  std::unordered_map<Action, EdgeInfo> stateActions_;
-  std::unordered_map<Action, std::unique_ptr<std::mutex>> lockStateActions_;
+
+  // From state, in the order of the policy.
+  std::vector<Action> actions_;
+  std::vector<float> priors_;
+  // Index in the policy of each edge.
+  std::vector<uint32_t> order_;
+  // Edges in order; the others have lower priors, in no order.
+  size_t sortedEdges_ = 0;
+  // Stats of the first numMaterialized_ edges.
+  std::unique_ptr<std::unique_ptr<EdgeChunk>[]> chunks_;
+  std::atomic<size_t> numMaterialized_{0};
 
   std::atomic<int> numVisits_;
   float V_ = 0.0;
@@ -333,91 +466,167 @@ class NodeT : public NodeBaseT<State> {
   const float unsignedParentQ_;
   bool flipQSign_ = false;
 
+  bool isMaterialized(int edge) const {
+    return size_t(edge) < numMaterialized_.load();
+  }
+
+  const EdgeChunk& chunk(int edge) const {
+    return *chunks_[edge / kEdgeChunk];
+  }
 
-  struct BestAction {
-    Action action_with_max_score;
-    float max_score;
-    float total_unsigned_q;
-    int total_visits;
+  EdgeChunk& chunk(int edge) {
+    return *chunks_[edge / kEdgeChunk];
+  }
 
-    BestAction()
-        : action_with_max_score(ActionTrait<Action>::default_value()),
-          max_score(std::numeric_limits<float>::lowest()),
-          total_unsigned_q(0),
-          total_visits(0) {
+  // Allocates the stats of the edge, and of the edges of higher prior.
+  EdgeChunk& materialize(int edge) {
+    if (!isMaterialized(edge)) {
+      std::lock_guard<std::mutex> lock(lockNode_);
+      // The edge after the last with stats has to be the best of the rest.
+      sortEdges(edge + 2);
+      growEdges(edge + 1);
     }
+    return chunk(edge);
+  }
 
-    void addAction(
-        const Action& action,
-        float score,
-        float unsigned_q,
-        bool first_visit) {
-      if (score > max_score) {
-        max_score = score;
-        action_with_max_score = action;
-      }
-
-      if (!first_visit) {
-        total_unsigned_q += unsigned_q;
-        total_visits++;
+  // Allocates the stats of the first end edges, which are sorted.
+  void growEdges(size_t end) {
+    for (size_t i = numMaterialized_.load(); i < end; ++i) {
+      if (i % kEdgeChunk == 0) {
+        chunks_[i / kEdgeChunk].reset(new EdgeChunk());
       }
+      chunk(i).priors[i % kEdgeChunk] = priors_[order_[i]];
     }
+    numMaterialized_ = std::max<size_t>(numMaterialized_.load(), end);
+  }
 
-    std::string info() const {
-      std::stringstream ss;
-      
-      ss << " max_score: " << max_score << ", best_action: "
-         << ActionTrait<Action>::to_string(action_with_max_score)
-         << ", mean unsigned_q stats: "
-         << (total_visits > 0 ? total_unsigned_q / total_visits : 0.0) << "/"
-         << total_visits;
-      return ss.str();
+  // Drops the stats and sorts the first end edges, or allocates them all
+  // unsorted in a narrow node.
+  void resetEdges(size_t end) {
+    const size_t n = actions_.size();
+    order_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      order_[i] = i;
     }
-  };
-
+    sortedEdges_ = 0;
 
+    chunks_.reset(
+        new std::unique_ptr<EdgeChunk>[(n + kEdgeChunk - 1) / kEdgeChunk]);
+    numMaterialized_ = 0;
+    if (n <= kEagerEdges) {
+      sortedEdges_ = n;
+      growEdges(n);
+    } else {
+      sortEdges(end);
+    }
+  }
 
+  // Sorts the first end edges by decreasing prior, the order of the policy
+  // breaking ties. Leaves alone the edges with stats, which are sorted
+  // already, so it runs under the searches.
+  void sortEdges(size_t end) {
+    end = std::min(end, order_.size());
+    if (end <= sortedEdges_) {
+      return;
+    }
+    auto higher = [this](uint32_t i1, uint32_t i2) {
+      return priors_[i1] > priors_[i2] ||
+          (priors_[i1] == priors_[i2] && i1 < i2);
+    };
+    auto first = order_.begin() + sortedEdges_;
+    auto last = order_.begin() + end;
+    if (last - first == 1) {
+      // A single pass for each edge a search reaches.
+      std::iter_swap(first, std::min_element(first, order_.end(), higher));
+    } else {
+      std::nth_element(first, last - 1, order_.end(), higher);
+      std::sort(first, last - 1, higher);
+    }
+    sortedEdges_ = end;
+  }
 
+  // UCT score of one edge, as the kernel computes it.
+  float edgeScore(int edge, const detail::PuctConsts& consts) const {
+    EdgeInfo info = getEdge(edge);
+    const int num_visits = info.num_visits;
+    const PuctEdges one{&info.prior_probability,
+                        &num_visits,
+                        &info.reward,
+                        &info.virtual_loss,
+                        1};
+    float unsigned_q;
+    bool counted;
+    return detail::puctScore(one, consts, 0, &unsigned_q, &counted);
+  }
 
   // Algorithms.
   // http://liacs.leidenuniv.nl/~plaata1/papers/paper_ICAART17.pdf
   // http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.159.4373&rep=rep1&type=pdf
-  BestAction UCT(const SearchAlgoOptions& alg_opt, std::ostream* oo = nullptr)
+  PuctChoice UCT(const SearchAlgoOptions& alg_opt, std::ostream* oo = nullptr)
       const {
-    BestAction best_action;
-
-    if (oo) {
-      *oo << "uct prior = " << std::string(alg_opt.use_prior ? "True" : "False")
-          << ", parent_cnt: " << (numVisits_.load() + 1) << std::endl;
+    PuctParams params;
+    params.use_prior = alg_opt.use_prior;
+    params.c_puct = alg_opt.c_puct;
+    params.flip_q_sign = flipQSign_;
+    // num_visits_ + 1 is sum of all visits to all other actions from
+    // this node
+    params.parent_visits = numVisits_.load() + 1;
+    params.unsigned_default_q = unsignedMeanQ_;
+    const detail::PuctConsts consts(params);
+
+    PuctChoice choice;
+    const size_t n = actions_.size();
+    const size_t num_materialized = numMaterialized_.load();
+    for (size_t first = 0; first < num_materialized; first += kEdgeChunk) {
+      const EdgeChunk& stats = chunk(first);
+      // Racy reads, as the stats keep changing under the other threads.
+      const PuctEdges edges{
+          stats.priors,
+          reinterpret_cast<const int*>(stats.visits),
+          reinterpret_cast<const float*>(stats.rewards),
+          reinterpret_cast<const float*>(stats.virtualLosses),
+          std::min(kEdgeChunk, num_materialized - first)};
+      PuctChoice chunk_choice = puctSelect(edges, params);
+
+      if (chunk_choice.max_score > choice.max_score) {
+        choice.max_score = chunk_choice.max_score;
+        choice.best = first + chunk_choice.best;
+      }
+      choice.total_unsigned_q += chunk_choice.total_unsigned_q;
+      choice.total_visits += chunk_choice.total_visits;
     }
 
-    for (const auto& action_pair : stateActions_) {
-      const Action& action = action_pair.first;
-      const EdgeInfo& edge = action_pair.second;
-
-      // num_visits_ + 1 is sum of all visits to all other actions from
-      // this node
-      const int all_visits = numVisits_.load() + 1;
-      auto prior_score = edge.getScore(flipQSign_, all_visits, unsignedMeanQ_);
-
-      float score = alg_opt.use_prior
-          ? (prior_score.prior_probability * alg_opt.c_puct + prior_score.q)
-          : prior_score.q;
-
-      best_action.addAction(
-          action, score, prior_score.unsigned_q, prior_score.first_visit);
-
-      if (oo) {
-        *oo << "UCT [a=" << ActionTrait<Action>::to_string(action)
-            << "][score=" << score << "] " << edge.info(true) << std::endl;
+    // The first edge without stats stands for all of them.
+    const size_t next = num_materialized;
+    if (next < n) {
+      const float score = edgeScore(next, consts);
+      if (score > choice.max_score) {
+        choice.max_score = score;
+        choice.best = next;
       }
     }
+
     if (oo) {
+      *oo << "uct prior = " << std::string(alg_opt.use_prior ? "True" : "False")
+          << ", parent_cnt: " << params.parent_visits << std::endl;
+
+      for (size_t i = 0; i < n; ++i) {
+        *oo << "UCT [a=" << ActionTrait<Action>::to_string(getAction(i))
+            << "][score=" << edgeScore(i, consts) << "] "
+            << getEdge(i).info(true) << std::endl;
+      }
+
       *oo << "Get best action. uct prior = "
           << std::string(alg_opt.use_prior ? "True" : "False")
-          << best_action.info() << std::endl;
-    }
-    return best_action;
+          << " max_score: " << choice.max_score << ", best_action: "
+          << ActionTrait<Action>::to_string(getAction(choice.best))
+          << ", mean unsigned_q stats: "
+          << (choice.total_visits > 0
+                  ? choice.total_unsigned_q / choice.total_visits
+                  : 0.0)
+          << "/" << choice.total_visits << std::endl;
+    }
+    return choice;
   };
 };
 
@@ -433,44 +642,139 @@ class NodeT : public NodeBaseT<State> {
 
 
 
+// Nodes dropped by treeAdvance() and clear() are freed by a background
+// thread of the tree (the reclaimer), off the path between two moves.
+//
+// The nodes live in a generation (NodeMap), and clear() starts a new one,
+// so that the ids of the new tree may start from 0 again while the old
+// generation is still being freed.
+//
+// max_nodes and max_process_nodes (0 = no limit) bound the nodes of this
+// tree and of all the trees of the process: once either is reached, the
+// search stops expanding and backs up the value of the deepest node it
+// got to. prune() makes room again between two searches.
 template <typename State, typename Action>
 
 class TreeT {
  public:
   using Node = NodeT<State, Action>;
   using Tree = TreeT<State, Action>;
-
-  TreeT() {
+  using NodeMap = std::unordered_map<NodeId, std::unique_ptr<Node>>;
+
+  TreeT(size_t max_nodes = 0, int64_t max_process_nodes = 0)
+      : maxNodes_(max_nodes), maxProcessNodes_(max_process_nodes) {
+    reclaimThread_ = std::thread([this]() {
+      std::function<void()> job;
+      while (true) {
+        reclaimQueue_.pop(&job);
+        if (job == nullptr) {
+          break;
+        }
+        job();
+        job = nullptr;
+        pendingReclaims_--;
+      }
+    });
     clear();
   }
 
   TreeT(const Tree&) = delete;
   Tree& operator=(const Tree&) = delete;
 
+  ~TreeT() {
+    // Finishes the pending reclaims first.
+    reclaimQueue_.push(nullptr);
+    reclaimThread_.join();
+  }
+
   void clear() {
-    allocatedNodes_.clear();
-    allocatedNodeCount_ = 0;
+    std::shared_ptr<NodeMap> old_nodes;
+    {
+      std::lock_guard<std::mutex> lock(allocMutex_);
+      old_nodes = std::move(allocatedNodes_);
+      allocatedNodes_ = std::make_shared<NodeMap>();
+      allocatedNodeCount_ = 0;
+    }
     rootId_ = InvalidNodeId;
     allocateRoot();
+
+    if (old_nodes != nullptr) {
+      // The old generation goes once its pending reclaims are done.
+      reclaim([old_nodes = std::move(old_nodes)]() { old_nodes->clear(); });
+    }
   }
 
-  // will free all unused nodes recursively before moving the next root;
+  // Moves the root to the child of action. The rest of the tree is freed
+  // by the reclaimer, so this costs the same whatever the tree size.
   void treeAdvance(const Action& action) {
     NodeId next_root = InvalidNodeId;
-    Node* r = getRootNode();
-
-    for (const auto& p : r->getStateActions()) {
-      if (p.first == action) {
-        next_root = p.second.child_node;
-      } else {
-        recursiveFree(p.second.child_node);
-      }
+    std::shared_ptr<Node> root;
+    std::shared_ptr<NodeMap> nodes;
+    {
+      std::lock_guard<std::mutex> lock(allocMutex_);
+      auto it = allocatedNodes_->find(rootId_);
+      assert(it != allocatedNodes_->end());
+      root = std::move(it->second);
+      allocatedNodes_->erase(it);
+      nodes = allocatedNodes_;
     }
 
-    // Free root.
-    freeNode(rootId_);
+    int edge = root->findEdge(action);
+    if (edge >= 0) {
+      next_root = root->getChild(edge);
+    }
     rootId_ = next_root;
     allocateRoot();
+
+    reclaim([this,
+             nodes = std::move(nodes),
+             root = std::move(root),
+             next_root]() {
+      for (size_t i = 0; i < root->getNumEdges(); ++i) {
+        if (root->getChild(i) != next_root) {
+          recursiveFree(*nodes, root->getChild(i));
+        }
+      }
+    });
+  }
+
+  // Cuts the subtrees entered the fewest times until at most max_nodes
+  // remain. The edges keep their stats. Only when no search runs on the
+  // tree.
+  void prune(size_t max_nodes) {
+    max_nodes = std::max(max_nodes, size_t(1));
+
+    for (int min_visits = 1; size() > max_nodes; min_visits *= 2) {
+      std::vector<Node*> to_visit{getRootNode()};
+
+      while (!to_visit.empty()) {
+        Node* node = to_visit.back();
+        to_visit.pop_back();
+
+        for (size_t i = 0; i < node->getNumEdges(); ++i) {
+          NodeId child = node->getChild(i);
+          if (child == InvalidNodeId) {
+            continue;
+          }
+          if (node->getEdge(i).num_visits < min_visits) {
+            node->detachChild(i);
+            reclaim([this, nodes = allocatedNodes_, child]() {
+              recursiveFree(*nodes, child);
+            });
+          } else {
+            to_visit.push_back((*this)[child]);
+          }
+        }
+      }
+      waitReclaims();
+    }
+  }
+
+  // Blocks until the reclaimer has freed every node dropped so far.
+  void waitReclaims() const {
+    while (pendingReclaims_.load() > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
   }
 
   Node* getRootNode() {
@@ -484,26 +788,7 @@ class TreeT {
   // Low level functions.
   // add a new node with parent Q?
   NodeId addNode(float unsigned_parent_q) {
-    std::lock_guard<std::mutex> lock(allocMutex_);
-
-    allocatedNodes_[allocatedNodeCount_].reset(new Node(unsigned_parent_q));
-    return allocatedNodeCount_++;
-  }
-
-  void freeNode(NodeId id) {
-    allocatedNodes_.erase(id);
-  }
-
-  void recursiveFree(NodeId id) {
-    if (id == InvalidNodeId) {
-      return;
-    }
-    Node* root = (*this)[id];
-    for (const auto& p : root->getStateActions()) {
-      p.second.checkValid();
-      recursiveFree(p.second.child_node);
-    }
-    freeNode(id);
+    return insertNode(unsigned_parent_q, true);
   }
 
   // get the node by key
@@ -519,6 +804,18 @@ class TreeT {
     return getNode(i);
   }
 
+  // Number of nodes of the current tree.
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(allocMutex_);
+    return allocatedNodes_->size();
+  }
+
+  // Nodes added since the last clear(), the freed ones included.
+  size_t getNumAdded() const {
+    std::lock_guard<std::mutex> lock(allocMutex_);
+    return allocatedNodeCount_;
+  }
+
   std::string printTree() const {
     // [TODO]: Only called when no search is performed!
     return printTree(0, getRootNode());
@@ -574,15 +871,23 @@ class TreeT {
   }
 
  private:
+  const size_t maxNodes_;
+  const int64_t maxProcessNodes_;
+
   // TODO: We might just allocate one chunk at a time.
-  std::unordered_map<NodeId, std::unique_ptr<Node>> allocatedNodes_;
+  std::shared_ptr<NodeMap> allocatedNodes_;
   NodeId allocatedNodeCount_;
   NodeId rootId_;
   mutable std::mutex allocMutex_;
 
+  // Jobs of the reclaimer, nullptr stops it.
+  elf::concurrency::ConcurrentQueue<std::function<void()>> reclaimQueue_;
+  std::atomic<int> pendingReclaims_{0};
+  std::thread reclaimThread_;
+
   const Node* getNode(NodeId i) const {
-    auto it = allocatedNodes_.find(i);
-    if (it == allocatedNodes_.end()) {
+    auto it = allocatedNodes_->find(i);
+    if (it == allocatedNodes_->end()) {
       return nullptr;
     } else {
       return it->second.get();
@@ -590,18 +895,69 @@ class TreeT {
   }
 
   Node* getNode(NodeId i) {
-    auto it = allocatedNodes_.find(i);
+    auto it = allocatedNodes_->find(i);
 
-    if (it == allocatedNodes_.end()) {
+    if (it == allocatedNodes_->end()) {
       return nullptr;
     } else {
       return it->second.get();
     }
   }
 
+  void reclaim(std::function<void()> job) {
+    pendingReclaims_++;
+    reclaimQueue_.push(job);
+  }
+
+  // Runs on the reclaimer. nodes may still be the current generation, so
+  // each node is taken out under allocMutex_ but destroyed outside of it.
+  void recursiveFree(NodeMap& nodes, NodeId id) {
+    std::vector<NodeId> to_free{id};
+
+    while (!to_free.empty()) {
+      NodeId curr = to_free.back();
+      to_free.pop_back();
+      if (curr == InvalidNodeId) {
+        continue;
+      }
+
+      std::unique_ptr<Node> node;
+      {
+        std::lock_guard<std::mutex> lock(allocMutex_);
+        auto it = nodes.find(curr);
+        if (it == nodes.end()) {
+          continue;
+        }
+        node = std::move(it->second);
+        nodes.erase(it);
+      }
+
+      for (size_t i = 0; i < node->getNumEdges(); ++i) {
+        node->getEdge(i).checkValid();
+        to_free.push_back(node->getChild(i));
+      }
+    }
+  }
+
+  NodeId insertNode(float unsigned_parent_q, bool bounded) {
+    if (bounded && maxProcessNodes_ > 0 &&
+        processNodeCount() >= maxProcessNodes_) {
+      return InvalidNodeId;
+    }
+
+    std::lock_guard<std::mutex> lock(allocMutex_);
+
+    if (bounded && maxNodes_ > 0 && allocatedNodes_->size() >= maxNodes_) {
+      return InvalidNodeId;
+    }
+    (*allocatedNodes_)[allocatedNodeCount_].reset(new Node(unsigned_parent_q));
+    return allocatedNodeCount_++;
+  }
+
   bool allocateRoot() {    
     if (rootId_ == InvalidNodeId) {
-      rootId_ = addNode(0.0);
+      // The root is always there, whatever the budget.
+      rootId_ = insertNode(0.0, false);
       return true;
     }
     return false;
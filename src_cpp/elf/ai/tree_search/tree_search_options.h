@@ -103,6 +103,23 @@ struct TSOptions {
   std::string pick_method = "most_visited";
   // Pre-added pseudo playout.
   int virtual_loss = 0;
+  // Rollouts per thread run in the background after our move, while the
+  // opponent is to move (0 = no pondering). Needs persistent_tree.
+  int ponder_rollouts_per_thread = 0;
+  // Nodes of one tree and of all the trees of the process (0 = no limit).
+  // Over budget, the search stops expanding, and the least visited
+  // subtrees are pruned before the next search.
+  int max_nodes_per_tree = 0;
+  int max_nodes_per_process = 0;
+  // Trees searched from the same root, among which the threads are shared
+  // out (root parallelism). Their root visits are summed to pick the move.
+  // 1 = all the threads on one tree. Each tree gets its own root noise,
+  // seeded by the actors of its threads.
+  int num_trees = 1;
+  // Root noise of the trees past the first when root_epsilon is 0 (eval,
+  // play), so that they still search apart. The first tree stays noise-free.
+  float tree_epsilon = 0.25;
+  float tree_alpha = 0.3;
 
   SearchAlgoOptions alg_opt;
 
@@ -125,6 +142,14 @@ struct TSOptions {
       ss << "Mcts log_prefix: " << "[" << log_prefix << "]" << std::endl;
       ss << std::setw(20) << std::right;
       ss << "Threads: " << num_threads << std::endl;
+      if (num_trees > 1) {
+        ss << std::setw(20) << std::right;
+        ss << "Trees: " << num_trees;
+        if (root_epsilon <= 0) {
+          ss << " [eps=" << tree_epsilon << "][alpha=" << tree_alpha << "]";
+        }
+        ss << std::endl;
+      }
       ss << std::setw(20) << std::right;
       ss << "Rollout per thread: " << num_rollouts_per_thread << std::endl;
       ss << std::setw(20) << std::right;
@@ -137,6 +162,15 @@ struct TSOptions {
       ss << "Persistent tree: " << elf_utils::print_bool(persistent_tree) << std::endl;
       ss << std::setw(20) << std::right;
       ss << "#Virtual loss: " << virtual_loss << std::endl;
+      if (ponder_rollouts_per_thread > 0) {
+        ss << std::setw(20) << std::right;
+        ss << "Ponder per thread: " << ponder_rollouts_per_thread << std::endl;
+      }
+      if (max_nodes_per_tree > 0 || max_nodes_per_process > 0) {
+        ss << std::setw(20) << std::right;
+        ss << "Max nodes: " << max_nodes_per_tree << " per tree, "
+           << max_nodes_per_process << " per process" << std::endl;
+      }
       ss << std::setw(20) << std::right;
       ss << "Pick method: " << pick_method << std::endl;
 
@@ -155,9 +189,12 @@ struct TSOptions {
 
     } else {
       ss << "[num_th=" << num_threads 
+         << "][trees=" << num_trees
          << "][rl_th=" << num_rollouts_per_thread
          << "][rl_b=" << num_rollouts_per_batch
          << "][per=" << elf_utils::print_bool(persistent_tree) 
+         << "][ponder=" << ponder_rollouts_per_thread
+         << "][max_nodes=" << max_nodes_per_tree << "/" << max_nodes_per_process
          << "][eps=" << root_epsilon
          << "][alpha=" << root_alpha
          << "][verbose=" << elf_utils::print_bool(verbose)
@@ -213,6 +250,24 @@ struct TSOptions {
     if (t1.virtual_loss != t2.virtual_loss) {
       return false;
     }
+    if (t1.ponder_rollouts_per_thread != t2.ponder_rollouts_per_thread) {
+      return false;
+    }
+    if (t1.max_nodes_per_tree != t2.max_nodes_per_tree) {
+      return false;
+    }
+    if (t1.max_nodes_per_process != t2.max_nodes_per_process) {
+      return false;
+    }
+    if (t1.num_trees != t2.num_trees) {
+      return false;
+    }
+    if (t1.tree_epsilon != t2.tree_epsilon) {
+      return false;
+    }
+    if (t1.tree_alpha != t2.tree_alpha) {
+      return false;
+    }
     return true;
   }
 
@@ -230,6 +285,12 @@ struct TSOptions {
     JSON_SAVE(j, root_epsilon);
     JSON_SAVE(j, root_alpha);
     JSON_SAVE(j, virtual_loss);
+    JSON_SAVE(j, ponder_rollouts_per_thread);
+    JSON_SAVE(j, max_nodes_per_tree);
+    JSON_SAVE(j, max_nodes_per_process);
+    JSON_SAVE(j, num_trees);
+    JSON_SAVE(j, tree_epsilon);
+    JSON_SAVE(j, tree_alpha);
     JSON_SAVE_OBJ(j, alg_opt);
   }
 
@@ -248,6 +309,12 @@ struct TSOptions {
     JSON_LOAD(opt, j, root_epsilon);
     JSON_LOAD(opt, j, root_alpha);
     JSON_LOAD(opt, j, virtual_loss);
+    JSON_LOAD_OPTIONAL(opt, j, ponder_rollouts_per_thread);
+    JSON_LOAD_OPTIONAL(opt, j, max_nodes_per_tree);
+    JSON_LOAD_OPTIONAL(opt, j, max_nodes_per_process);
+    JSON_LOAD_OPTIONAL(opt, j, num_trees);
+    JSON_LOAD_OPTIONAL(opt, j, tree_epsilon);
+    JSON_LOAD_OPTIONAL(opt, j, tree_alpha);
     JSON_LOAD_OBJ(opt, j, alg_opt);
     return opt;
   }
@@ -265,7 +332,13 @@ struct TSOptions {
       verbose_time,
       alg_opt,
       root_epsilon,
-      root_alpha);
+      root_alpha,
+      ponder_rollouts_per_thread,
+      max_nodes_per_tree,
+      max_nodes_per_process,
+      num_trees,
+      tree_epsilon,
+      tree_alpha);
 };
 
 } // namespace tree_search
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "tree_search_base.h"
+
+#include "elf/legacy/pybind_helper.h"
+#include "elf/utils/json_utils.h"
+
+namespace elf {
+namespace ai {
+namespace tree_search {
+
+// Nodes alive in all the trees of the process.
+inline std::atomic<int64_t>& processNodeCount() {
+  static std::atomic<int64_t> count(0);
+  return count;
+}
+
+// Nodes ever created in the process.
+inline std::atomic<int64_t>& processNodesAllocated() {
+  static std::atomic<int64_t> count(0);
+  return count;
+}
+
+// Counters of MCTS searches, cheap enough to stay on. Each search thread
+// counts into its own SearchStats, which are summed once per search, and
+// the phases are timed once per batch of rollouts:
+//   select:   the descents, with the forward() of the new leaves,
+//   evaluate: actor.evaluate(), and the waits for leaves that another
+//             thread sent to it,
+//   expand:   setting the evaluations on the leaves,
+//   backup:   updating the edges of the rollouts.
+// A duplicate leaf is a rollout ending at a leaf that another rollout of
+// the same batch reached first: it adds no evaluation.
+struct SearchStats {
+  int64_t num_searches = 0;
+  int64_t num_rollouts = 0;
+  int64_t num_evaluations = 0;
+  int64_t num_terminal_hits = 0;
+  int64_t num_duplicate_leaves = 0;
+  // Summed over the rollouts.
+  int64_t total_depth = 0;
+
+  int64_t select_ns = 0;
+  int64_t evaluate_ns = 0;
+  int64_t expand_ns = 0;
+  int64_t backup_ns = 0;
+
+  // For a search: the nodes it added, the nodes pruned before it and the
+  // nodes of its trees once done. For the process: all the nodes created
+  // and freed, and those alive.
+  int64_t nodes_allocated = 0;
+  int64_t nodes_freed = 0;
+  int64_t tree_size = 0;
+
+  float meanDepth() const {
+    return num_rollouts > 0 ? float(total_depth) / num_rollouts : 0.0f;
+  }
+
+  SearchStats& operator+=(const SearchStats& other) {
+    num_searches += other.num_searches;
+    num_rollouts += other.num_rollouts;
+    num_evaluations += other.num_evaluations;
+    num_terminal_hits += other.num_terminal_hits;
+    num_duplicate_leaves += other.num_duplicate_leaves;
+    total_depth += other.total_depth;
+    select_ns += other.select_ns;
+    evaluate_ns += other.evaluate_ns;
+    expand_ns += other.expand_ns;
+    backup_ns += other.backup_ns;
+    nodes_allocated += other.nodes_allocated;
+    nodes_freed += other.nodes_freed;
+    tree_size += other.tree_size;
+    return *this;
+  }
+
+  std::string info() const {
+    std::stringstream ss;
+    ss << "[searches=" << num_searches << "][rollouts=" << num_rollouts
+       << "][evals=" << num_evaluations << "][terminal=" << num_terminal_hits
+       << "][dup_leaves=" << num_duplicate_leaves
+       << "][depth=" << meanDepth() << "]"
+       << "[select=" << select_ns / 1e6 << "ms][eval=" << evaluate_ns / 1e6
+       << "ms][expand=" << expand_ns / 1e6 << "ms][backup=" << backup_ns / 1e6
+       << "ms]"
+       << "[nodes +" << nodes_allocated << "/-" << nodes_freed
+       << "][tree=" << tree_size << "]";
+    return ss.str();
+  }
+
+  void setJsonFields(json& j) const {
+    JSON_SAVE(j, num_searches);
+    JSON_SAVE(j, num_rollouts);
+    JSON_SAVE(j, num_evaluations);
+    JSON_SAVE(j, num_terminal_hits);
+    JSON_SAVE(j, num_duplicate_leaves);
+    JSON_SAVE(j, total_depth);
+    JSON_SAVE(j, select_ns);
+    JSON_SAVE(j, evaluate_ns);
+    JSON_SAVE(j, expand_ns);
+    JSON_SAVE(j, backup_ns);
+    JSON_SAVE(j, nodes_allocated);
+    JSON_SAVE(j, nodes_freed);
+    JSON_SAVE(j, tree_size);
+    j["mean_depth"] = meanDepth();
+  }
+
+  std::string dumpJson() const {
+    json j;
+    setJsonFields(j);
+    return j.dump();
+  }
+
+  REGISTER_PYBIND_FIELDS(
+      num_searches,
+      num_rollouts,
+      num_evaluations,
+      num_terminal_hits,
+      num_duplicate_leaves,
+      total_depth,
+      select_ns,
+      evaluate_ns,
+      expand_ns,
+      backup_ns,
+      nodes_allocated,
+      nodes_freed,
+      tree_size);
+};
+
+// Nanoseconds since start, and restarts it.
+inline int64_t lapNs(std::chrono::steady_clock::time_point& start) {
+  auto now = std::chrono::steady_clock::now();
+  int64_t ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - start)
+          .count();
+  start = now;
+  return ns;
+}
+
+namespace detail {
+
+struct ProcessSearchStats {
+  std::mutex mutex;
+  SearchStats total;
+  // Node counters at the last reset.
+  int64_t nodes_allocated = 0;
+  int64_t nodes_alive = 0;
+};
+
+inline ProcessSearchStats& processSearchStats() {
+  static ProcessSearchStats stats;
+  return stats;
+}
+
+} // namespace detail
+
+inline void addProcessSearchStats(const SearchStats& stats) {
+  detail::ProcessSearchStats& p = detail::processSearchStats();
+  std::lock_guard<std::mutex> lock(p.mutex);
+  p.total += stats;
+}
+
+// All the searches of the process since the last reset. The node counts
+// include the trees cleared and advanced between searches.
+inline SearchStats getProcessSearchStats() {
+  detail::ProcessSearchStats& p = detail::processSearchStats();
+  std::lock_guard<std::mutex> lock(p.mutex);
+  SearchStats stats = p.total;
+  const int64_t alive = processNodeCount().load();
+  stats.nodes_allocated = processNodesAllocated().load() - p.nodes_allocated;
+  stats.nodes_freed = stats.nodes_allocated - (alive - p.nodes_alive);
+  stats.tree_size = alive;
+  return stats;
+}
+
+inline void resetProcessSearchStats() {
+  detail::ProcessSearchStats& p = detail::processSearchStats();
+  std::lock_guard<std::mutex> lock(p.mutex);
+  p.total = SearchStats();
+  p.nodes_allocated = processNodesAllocated().load();
+  p.nodes_alive = processNodeCount().load();
+}
+
+} // namespace tree_search
+} // namespace ai
+} // namespace elf
@@ -0,0 +1,411 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "elf/logging/IndexedLoggerFactory.h"
+
+namespace elf {
+
+namespace shared {
+
+struct MMapStoreCtrl {
+  // Directory of the segment files. Existing segments are reloaded.
+  std::string dir;
+  // Number of records per segment file.
+  size_t segment_size = 65536;
+
+  std::string info() const {
+    std::stringstream ss;
+    ss << "MMapStore [dir=" << dir << "][segment_size=" << segment_size
+       << "]";
+    return ss.str();
+  }
+};
+
+struct MMapSegmentInfo {
+  std::string path;
+  size_t count = 0;
+  int64_t min_version = 0;
+  int64_t max_version = 0;
+};
+
+// Append-only store of fixed-size records, kept in memory-mapped segment
+// files. Only the segment index lives in RAM, record pages are managed by
+// the kernel page cache. Each record is tagged with a version and whole
+// segments are evicted once all their records fall out of the version
+// window.
+//
+// Writers are serialized by a mutex. Samplers take a snapshot of the
+// segment index and never lock; a segment is unmapped (and its file
+// removed, if evicted) once the last snapshot holding it is released.
+template <typename T>
+class MMapStoreT {
+  static_assert(
+      std::is_trivially_copyable<T>::value,
+      "MMapStoreT records are copied as raw bytes");
+
+ public:
+  MMapStoreT(const MMapStoreCtrl& ctrl)
+      : ctrl_(ctrl),
+        segments_(std::make_shared<const SegmentList>()),
+        logger_(elf::logging::getIndexedLogger(
+            "elf::distributed::MMapStoreT-",
+            "")) {
+    if (ctrl_.segment_size == 0) {
+      ctrl_.segment_size = 1;
+    }
+    if (::mkdir(ctrl_.dir.c_str(), 0755) != 0 && errno != EEXIST) {
+      logger_->error("Cannot create directory {}", ctrl_.dir);
+      throw std::runtime_error("MMapStoreT: cannot create " + ctrl_.dir);
+    }
+    loadSegments();
+  }
+
+  MMapStoreT(const MMapStoreT&) = delete;
+  MMapStoreT& operator=(const MMapStoreT&) = delete;
+
+  // Append n records with the same version. Return #records appended.
+  size_t Append(const T* vs, size_t n, int64_t version) {
+    return Append(vs, n, version, version);
+  }
+
+  // Append n records with versions in [min_version, max_version].
+  size_t Append(
+      const T* vs,
+      size_t n,
+      int64_t min_version,
+      int64_t max_version) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+
+    size_t i = 0;
+    while (i < n) {
+      if (active_ == nullptr || active_->full()) {
+        openNewSegment();
+      }
+      Segment& seg = *active_;
+      size_t count = seg.count.load();
+      size_t m = std::min(n - i, seg.capacity - count);
+      std::memcpy(seg.data + count, vs + i, m * sizeof(T));
+
+      seg.header->min_version =
+          std::min(seg.header->min_version, min_version);
+      seg.header->max_version =
+          std::max(seg.header->max_version, max_version);
+      seg.header->count = count + m;
+      // Publish to samplers after the records are written.
+      seg.count.store(count + m);
+      total_appended_ += m;
+      i += m;
+    }
+    return n;
+  }
+
+  // Copy one uniformly sampled record into out.
+  // Return false if the store is empty.
+  bool sample(std::mt19937* rng, T* out) const {
+    std::shared_ptr<const SegmentList> segs = std::atomic_load(&segments_);
+    if (segs->segments.empty())
+      return false;
+
+    // Sealed segments never change; the last one may still be growing.
+    const Segment& last = *segs->segments.back();
+    size_t sealed = segs->starts.back();
+    size_t total = sealed + last.count.load();
+    if (total == 0)
+      return false;
+
+    size_t idx = (*rng)() % total;
+    if (idx >= sealed) {
+      *out = last.data[idx - sealed];
+      return true;
+    }
+    size_t k = std::upper_bound(
+                   segs->starts.begin(), segs->starts.end(), idx) -
+        segs->starts.begin() - 1;
+    *out = segs->segments[k]->data[idx - segs->starts[k]];
+    return true;
+  }
+
+  // Remove every segment whose records all have version < min_version.
+  // The active segment is kept. Return #records evicted.
+  size_t evictBelowVersion(int64_t min_version) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+
+    std::shared_ptr<const SegmentList> segs = std::atomic_load(&segments_);
+    std::vector<std::shared_ptr<Segment>> kept;
+    size_t evicted = 0;
+    for (const auto& seg : segs->segments) {
+      if (seg != active_ && seg->header->max_version < min_version) {
+        seg->remove_on_release = true;
+        evicted += seg->count.load();
+      } else {
+        kept.push_back(seg);
+      }
+    }
+    if (evicted > 0) {
+      publish(std::move(kept));
+      logger_->info(
+          "Evicted {} records below version {}, {}", evicted, min_version,
+          info());
+    }
+    return evicted;
+  }
+
+  // Remove all the segments.
+  void clear() {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+
+    std::shared_ptr<const SegmentList> segs = std::atomic_load(&segments_);
+    for (const auto& seg : segs->segments) {
+      seg->remove_on_release = true;
+    }
+    active_ = nullptr;
+    publish({});
+  }
+
+  size_t size() const {
+    std::shared_ptr<const SegmentList> segs = std::atomic_load(&segments_);
+    if (segs->segments.empty())
+      return 0;
+    return segs->starts.back() + segs->segments.back()->count.load();
+  }
+
+  std::vector<MMapSegmentInfo> segments() const {
+    std::shared_ptr<const SegmentList> segs = std::atomic_load(&segments_);
+    std::vector<MMapSegmentInfo> res;
+    for (const auto& seg : segs->segments) {
+      MMapSegmentInfo info;
+      info.path = seg->path;
+      info.count = seg->count.load();
+      info.min_version = seg->header->min_version;
+      info.max_version = seg->header->max_version;
+      res.push_back(info);
+    }
+    return res;
+  }
+
+  size_t numSegments() const {
+    return std::atomic_load(&segments_)->segments.size();
+  }
+
+  std::string info() const {
+    std::stringstream ss;
+    ss << ctrl_.info() << ", #segments: " << numSegments()
+       << ", size: " << size() << ", appended: " << total_appended_;
+    return ss.str();
+  }
+
+ private:
+  static constexpr uint64_t kMagic = 0x59414c5046464c45ULL; // "ELFFPLAY"
+
+  struct SegmentHeader {
+    uint64_t magic;
+    uint64_t record_size;
+    uint64_t capacity;
+    uint64_t count;
+    int64_t min_version;
+    int64_t max_version;
+    uint64_t reserved[2];
+  };
+
+  struct Segment {
+    std::string path;
+    int fd = -1;
+    void* addr = nullptr;
+    size_t bytes = 0;
+
+    SegmentHeader* header = nullptr;
+    T* data = nullptr;
+    size_t capacity = 0;
+    std::atomic<size_t> count{0};
+
+    bool remove_on_release = false;
+
+    bool full() const {
+      return count.load() >= capacity;
+    }
+
+    ~Segment() {
+      if (addr != nullptr)
+        ::munmap(addr, bytes);
+      if (fd >= 0)
+        ::close(fd);
+      if (remove_on_release)
+        ::unlink(path.c_str());
+    }
+  };
+
+  struct SegmentList {
+    std::vector<std::shared_ptr<Segment>> segments;
+    // starts[i]: global index of the first record of segments[i], so the
+    // last entry is the number of records in all but the last segment.
+    std::vector<size_t> starts{0};
+  };
+
+  MMapStoreCtrl ctrl_;
+
+  std::mutex writeMutex_;
+  std::shared_ptr<Segment> active_;
+  uint64_t next_segment_id_ = 0;
+  std::atomic<size_t> total_appended_{0};
+
+  std::shared_ptr<const SegmentList> segments_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  static size_t dataOffset() {
+    // Keep records cache line aligned.
+    return (sizeof(SegmentHeader) + 63) / 64 * 64;
+  }
+
+  void publish(std::vector<std::shared_ptr<Segment>> segs) {
+    auto l = std::make_shared<SegmentList>();
+    l->segments = std::move(segs);
+    l->starts.clear();
+    size_t start = 0;
+    for (const auto& seg : l->segments) {
+      l->starts.push_back(start);
+      start += seg->count.load();
+    }
+    if (l->starts.empty())
+      l->starts.push_back(0);
+    std::atomic_store(&segments_, std::shared_ptr<const SegmentList>(l));
+  }
+
+  std::string segmentPath(uint64_t id) const {
+    std::stringstream ss;
+    ss << ctrl_.dir << "/segment-" << std::setw(10) << std::setfill('0') << id
+       << ".bin";
+    return ss.str();
+  }
+
+  std::shared_ptr<Segment> mapSegment(
+      const std::string& path,
+      bool create) {
+    auto seg = std::make_shared<Segment>();
+    seg->path = path;
+    seg->fd = ::open(path.c_str(), create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0644);
+    if (seg->fd < 0)
+      return nullptr;
+
+    size_t capacity = ctrl_.segment_size;
+    if (!create) {
+      SegmentHeader h;
+      if (::pread(seg->fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) ||
+          h.magic != kMagic || h.record_size != sizeof(T)) {
+        logger_->warn("Skip incompatible segment {}", path);
+        return nullptr;
+      }
+      capacity = h.capacity;
+    }
+
+    seg->bytes = dataOffset() + capacity * sizeof(T);
+    if (create && ::ftruncate(seg->fd, seg->bytes) != 0)
+      return nullptr;
+
+    seg->addr = ::mmap(
+        nullptr, seg->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, seg->fd, 0);
+    if (seg->addr == MAP_FAILED) {
+      seg->addr = nullptr;
+      return nullptr;
+    }
+    seg->header = static_cast<SegmentHeader*>(seg->addr);
+    seg->data = reinterpret_cast<T*>(
+        static_cast<char*>(seg->addr) + dataOffset());
+    seg->capacity = capacity;
+
+    if (create) {
+      seg->header->magic = kMagic;
+      seg->header->record_size = sizeof(T);
+      seg->header->capacity = capacity;
+      seg->header->count = 0;
+      seg->header->min_version = std::numeric_limits<int64_t>::max();
+      seg->header->max_version = std::numeric_limits<int64_t>::min();
+    }
+    seg->count = std::min<size_t>(seg->header->count, capacity);
+    return seg;
+  }
+
+  void openNewSegment() {
+    std::shared_ptr<Segment> seg;
+    while (seg == nullptr) {
+      std::string path = segmentPath(next_segment_id_++);
+      seg = mapSegment(path, true);
+      if (seg == nullptr && errno != EEXIST) {
+        logger_->error("Cannot create segment {}", path);
+        throw std::runtime_error("MMapStoreT: cannot create " + path);
+      }
+    }
+    active_ = seg;
+
+    std::shared_ptr<const SegmentList> segs = std::atomic_load(&segments_);
+    std::vector<std::shared_ptr<Segment>> l = segs->segments;
+    l.push_back(seg);
+    publish(std::move(l));
+  }
+
+  // Rebuild the index from the segment files already in ctrl_.dir.
+  void loadSegments() {
+    DIR* d = ::opendir(ctrl_.dir.c_str());
+    if (d == nullptr)
+      return;
+
+    std::vector<std::string> names;
+    while (struct dirent* e = ::readdir(d)) {
+      std::string name = e->d_name;
+      if (name.compare(0, 8, "segment-") == 0 &&
+          name.size() > 4 && name.compare(name.size() - 4, 4, ".bin") == 0) {
+        names.push_back(name);
+      }
+    }
+    ::closedir(d);
+    std::sort(names.begin(), names.end());
+
+    std::vector<std::shared_ptr<Segment>> l;
+    for (const auto& name : names) {
+      auto seg = mapSegment(ctrl_.dir + "/" + name, false);
+      if (seg == nullptr || seg->count.load() == 0)
+        continue;
+      // Reloaded segments are sealed, new records go to a new segment.
+      seg->capacity = seg->count.load();
+      l.push_back(seg);
+      next_segment_id_ = std::max<uint64_t>(
+          next_segment_id_, std::stoull(name.substr(8)) + 1);
+    }
+    if (!l.empty()) {
+      publish(std::move(l));
+      logger_->info("Reloaded {}", info());
+    }
+  }
+};
+
+} // namespace shared
+
+} // namespace elf
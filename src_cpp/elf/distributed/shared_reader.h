@@ -9,14 +9,23 @@
 #pragma once
 
 #include <time.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <deque>
+#include <cmath>
 #include <functional>
 #include <iostream>
-#include <shared_mutex>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
 #include <thread>
+#include <vector>
 
 #include "elf/logging/IndexedLoggerFactory.h"
+#include "sum_tree.h"
 
 namespace elf {
 
@@ -25,9 +34,26 @@ namespace shared {
 struct ReaderCtrl {
   size_t queue_min_size = 10;
   size_t queue_max_size = 1000;
+
+  // Sample records proportionally to their weight (see
+  // ReaderQueueT::setWeightFunction) instead of uniformly.
+  bool prioritized = false;
+  // If > 0, the weight of a record halves every recency_half_life
+  // insertions made after it. Only used when prioritized.
+  float recency_half_life = 0.0;
+  // If > 0, the weight of a record halves for every version_half_life
+  // versions (see ReaderQueueT::setVersionFunction) it is behind the
+  // newest record of the queues, including records inserted after it.
+  // Only used when prioritized.
+  float version_half_life = 0.0;
+
   std::string info() const {
     std::stringstream ss;
     ss << "Queue [min=" << queue_min_size << "][max=" << queue_max_size << "]";
+    if (prioritized) {
+      ss << "[prioritized][recency_half_life=" << recency_half_life
+         << "][version_half_life=" << version_half_life << "]";
+    }
     return ss.str();
   }
 };
@@ -39,125 +65,414 @@ struct ReaderCtrl {
 
 
 
+// Fixed-capacity ring of record slots shared by one writer group and many
+// samplers. Writers claim slots with an atomic counter and swap the new
+// record in; samplers pin the current epoch and read slots without taking
+// any lock. A record that got overwritten is only freed once no sampler
+// pinned at (or before) the epoch of its removal is still alive, so the
+// pointer returned by Sampler::sample() stays valid for the sampler lifetime.
 template <typename T>
 class ReaderQueueT {
  public:
   using ReaderQ = ReaderQueueT<T>;
 
+  // Samplers alive at the same time that pin the queue without a lock.
+  // Any more share overflowPins_, behind a mutex.
+  static constexpr size_t kMaxPins = 256;
+  // Number of retired records that triggers a reclamation pass.
+  static constexpr size_t kReclaimThreshold = 64;
+
   class Sampler {
    public:
     explicit Sampler(ReaderQ* r, std::mt19937* rng)
-        : r_(r), lock_(r->rwMutex_), rng_(rng) {
-      released_ = false;
+        : r_(r), pin_(r->pin()), rng_(rng) {
     }
     Sampler(const Sampler&) = delete;
     Sampler(Sampler&& sampler)
-        : r_(sampler.r_), released_(sampler.released_), rng_(sampler.rng_) {
+        : r_(sampler.r_), pin_(sampler.pin_), rng_(sampler.rng_) {
+      sampler.pin_ = -1;
     }
 
+    // Never holds a lock: a short queue only delays the sampler itself.
     const T* sample(int timeout_millisec = 100) {
-      const auto& buf = r_->buffer_;
-
-      if (buf.size() < r_->ctrl_.queue_min_size) {
-        lock_.unlock();
+      if (r_->size() < r_->ctrl_.queue_min_size) {
         std::this_thread::sleep_for(
             std::chrono::milliseconds(timeout_millisec));
-        lock_.lock();
-        if (buf.size() < r_->ctrl_.queue_min_size)
+        if (r_->size() < r_->ctrl_.queue_min_size)
           return nullptr;
       }
 
-      int idx = (*rng_)() % buf.size();
-      return &buf[idx];
+      // A slot can be transiently empty while a concurrent writer (or
+      // clear()) is in flight, so retry a few times before giving up.
+      const int kNumTrials = 4;
+      for (int i = 0; i < kNumTrials; ++i) {
+        size_t slot;
+        if (r_->tree_ != nullptr) {
+          double total = r_->tree_->total();
+          if (total <= 0)
+            return nullptr;
+          std::uniform_real_distribution<double> dis(0.0, total);
+          slot = r_->tree_->find(dis(*rng_));
+          if (r_->tree_->get(slot) <= 0)
+            continue;
+        } else {
+          size_t n = r_->size();
+          if (n == 0)
+            return nullptr;
+          slot = (*rng_)() % n;
+        }
+        const T* p = r_->slots_[slot].load();
+        if (p != nullptr)
+          return p;
+      }
+      return nullptr;
     }
 
     ~Sampler() {
-      release();
+      if (pin_ >= 0)
+        r_->unpin(pin_);
     }
 
    private:
-    void release() {
-      if (!released_) {
-        lock_.unlock();
-        released_ = true;
-      }
-    }
-
     ReaderQ* r_;
-    std::shared_lock<std::shared_mutex> lock_;
-    bool released_ = true;
+    int pin_ = -1;
     std::mt19937* rng_ = nullptr;
   };
 
+  ReaderQueueT(const ReaderCtrl& ctrl)
+      : ctrl_(ctrl),
+        capacity_(std::max<size_t>(ctrl.queue_max_size, 1)),
+        slots_(new std::atomic<T*>[capacity_]) {
+    for (size_t i = 0; i < capacity_; ++i) {
+      slots_[i] = nullptr;
+    }
+    if (ctrl_.prioritized) {
+      tree_.reset(new SumTree(capacity_));
+      weights_.resize(capacity_, 0.0);
+      times_.resize(capacity_, 0.0);
+      versions_.resize(capacity_, 0.0);
+    }
+    for (auto& p : pins_) {
+      p = 0;
+    }
+  }
 
+  ReaderQueueT(const ReaderQ&) = delete;
+  ReaderQueueT& operator=(const ReaderQ&) = delete;
 
-
-
-
-
-
-  ReaderQueueT(const ReaderCtrl& ctrl) : ctrl_(ctrl) {
+  ~ReaderQueueT() {
+    for (size_t i = 0; i < capacity_; ++i) {
+      delete slots_[i].load();
+    }
+    for (auto& r : retired_) {
+      delete r.second;
+    }
   }
 
   Sampler getSampler(std::mt19937* rng) {
     return Sampler(this, rng);
   }
 
+  // Weight of a record at insertion, used when ctrl.prioritized.
+  // Default weight is 1.
+  void setWeightFunction(std::function<float(const T&)> weight_fn) {
+    weight_fn_ = std::move(weight_fn);
+  }
+
+  // Version of a record, used with ctrl.version_half_life. Default is 0.
+  // There is no hook for the trainer to push priorities back: the train
+  // batches do not carry the slot of their records, and the trainer has no
+  // per-sample loss to send.
+  void setVersionFunction(std::function<int64_t(const T&)> version_fn) {
+    version_fn_ = std::move(version_fn);
+  }
+
   // Return delta buffer size.
-  int Insert(T&& v) {
-    int delta = 0;
+  // time is the insertion clock used for recency weighting.
+  int Insert(T&& v, double time = 0.0) {
+    std::vector<T> vs;
+    vs.push_back(std::move(v));
+    return Insert(std::move(vs), time);
+  }
 
-    {
-      std::unique_lock<std::shared_mutex> lock(rwMutex_);
-      buffer_.push_back(v);
-      delta++;
-      while (buffer_.size() > ctrl_.queue_max_size) {
-        buffer_.pop_front();
-        delta--;
+  // Bulk insert: claims a contiguous range of slots with a single atomic
+  // operation. Record i gets insertion time time + i.
+  // Return delta buffer size.
+  int Insert(std::vector<T>&& vs, double time = 0.0) {
+    if (vs.empty())
+      return 0;
+
+    // Records beyond the capacity would be overwritten by the same batch.
+    size_t skip = vs.size() > capacity_ ? vs.size() - capacity_ : 0;
+    size_t n = vs.size() - skip;
+
+    // Writers are serialized only when the sum tree has to be updated.
+    std::unique_lock<std::mutex> lock(treeMutex_, std::defer_lock);
+    if (tree_ != nullptr)
+      lock.lock();
+
+    size_t pos = head_.fetch_add(n);
+
+    std::vector<T*> olds;
+    for (size_t i = 0; i < n; ++i) {
+      size_t slot = (pos + i) % capacity_;
+      T* v = new T(std::move(vs[skip + i]));
+      T* old = slots_[slot].exchange(v);
+      if (old != nullptr)
+        olds.push_back(old);
+
+      if (tree_ != nullptr) {
+        weights_[slot] = weight_fn_ ? weight_fn_(*v) : 1.0;
+        times_[slot] = time + skip + i;
+        versions_[slot] = version_fn_ ? version_fn_(*v) : 0;
+        newest_version_ = std::max(newest_version_.load(), versions_[slot]);
+        updateLeaf(slot);
       }
     }
+    int delta = commit(n);
+    if (lock.owns_lock())
+      lock.unlock();
+
+    if (!olds.empty())
+      retire(olds);
     return delta;
   }
 
+  // Sum of the weights, with recency measured at time now and versions
+  // against newest_version. Equals size() when not prioritized.
+  double totalWeight(double now, double newest_version) const {
+    if (tree_ == nullptr)
+      return size();
+    return tree_->total() * recency(base_time_.load(), now) *
+        versionWeight(base_version_.load(), newest_version);
+  }
+
+  // Newest version inserted, 0 before any insertion.
+  double newestVersion() const {
+    return newest_version_.load();
+  }
+
   void clear() {
-    std::unique_lock<std::shared_mutex> lock(rwMutex_);
-    buffer_.clear();
+    std::unique_lock<std::mutex> lock(treeMutex_, std::defer_lock);
+    if (tree_ != nullptr)
+      lock.lock();
+
+    std::vector<T*> olds;
+    committed_ = 0;
+    for (size_t i = 0; i < capacity_; ++i) {
+      T* old = slots_[i].exchange(nullptr);
+      if (old != nullptr)
+        olds.push_back(old);
+    }
+    head_ = 0;
+    if (tree_ != nullptr)
+      tree_->clear();
+    if (lock.owns_lock())
+      lock.unlock();
+
+    if (!olds.empty())
+      retire(olds);
   }
 
   std::vector<T> Dump() const {
     std::vector<T> vec;
-
-    {
-      std::shared_lock<std::shared_mutex> lock(rwMutex_);
-      vec.insert(vec.end(), buffer_.begin(), buffer_.end());
+    ReaderQ* self = const_cast<ReaderQ*>(this);
+    int p = self->pin();
+    for (size_t i = 0; i < size(); ++i) {
+      const T* v = slots_[i].load();
+      if (v != nullptr)
+        vec.push_back(*v);
     }
+    self->unpin(p);
     return vec;
   }
 
   size_t size() const {
-    return buffer_.size();
+    return std::min(committed_.load(), capacity_);
   }
 
   std::string info() const {
     std::stringstream ss;
 
-    ss << "ReaderQueue: " << ctrl_.info();
+    ss << "ReaderQueue: " << ctrl_.info() << ", epoch: " << epoch_.load()
+       << ", retired: " << num_retired_.load();
     return ss.str();
   }
 
  private:
-  // TODO: update to std::shared_mutex with C++17
-  mutable std::shared_mutex rwMutex_;
+  ReaderCtrl ctrl_;
+  const size_t capacity_;
+
+  std::unique_ptr<std::atomic<T*>[]> slots_;
+  // Next slot to be claimed by a writer.
+  std::atomic<size_t> head_{0};
+  // Number of slots that have been written since the last clear().
+  std::atomic<size_t> committed_{0};
+
+  // Epoch-based reclamation. pins_[i] holds the epoch observed by an alive
+  // sampler, 0 if unused. epoch_ starts at 1.
+  std::atomic<uint64_t> epoch_{1};
+  std::array<std::atomic<uint64_t>, kMaxPins> pins_;
+  // Pins past kMaxPins, as pins_; pin() returns kMaxPins + their index.
+  std::mutex overflowMutex_;
+  std::vector<uint64_t> overflowPins_;
+
+  // Retired records with the epoch they were unlinked in. Only touched by
+  // writers, samplers never wait on this mutex.
+  std::mutex retireMutex_;
+  std::vector<std::pair<uint64_t, T*>> retired_;
+  std::atomic<size_t> num_retired_{0};
+
+  // Prioritized sampling. Leaf weight of a slot is
+  // weights_[slot] * 2^((times_[slot] - base_time_) / recency_half_life)
+  //   * 2^((versions_[slot] - base_version_) / version_half_life).
+  // As the bases are shared by the leaves, a newer record lowers the share
+  // of the older ones without touching their leaves.
+  std::function<float(const T&)> weight_fn_;
+  std::function<int64_t(const T&)> version_fn_;
+  std::unique_ptr<SumTree> tree_;
+  std::vector<float> weights_;
+  std::vector<double> times_;
+  std::atomic<double> base_time_{0.0};
+  std::vector<double> versions_;
+  std::atomic<double> base_version_{0.0};
+  std::atomic<double> newest_version_{0.0};
+  std::mutex treeMutex_;
+
+  double recency(double time, double now) const {
+    if (ctrl_.recency_half_life <= 0)
+      return 1.0;
+    return std::exp2((time - now) / ctrl_.recency_half_life);
+  }
 
-  std::deque<T> buffer_;
+  double versionWeight(double version, double newest) const {
+    if (ctrl_.version_half_life <= 0)
+      return 1.0;
+    return std::exp2((version - newest) / ctrl_.version_half_life);
+  }
 
-  ReaderCtrl ctrl_;
-};
+  // Called with treeMutex_ held.
+  void updateLeaf(size_t slot) {
+    // Keep the exponents bounded: move the bases to the newest record and
+    // recompute every leaf, once every 64 half-lives.
+    const double kMaxExponent = 64;
+    bool rebase = false;
+    if (ctrl_.recency_half_life > 0 &&
+        (times_[slot] - base_time_.load()) / ctrl_.recency_half_life >
+            kMaxExponent) {
+      base_time_ = times_[slot];
+      rebase = true;
+    }
+    if (ctrl_.version_half_life > 0 &&
+        (versions_[slot] - base_version_.load()) / ctrl_.version_half_life >
+            kMaxExponent) {
+      base_version_ = versions_[slot];
+      rebase = true;
+    }
+    if (rebase) {
+      for (size_t i = 0; i < capacity_; ++i) {
+        if (i != slot) {
+          tree_->set(i, slots_[i].load() == nullptr ? 0.0 : leafWeight(i));
+        }
+      }
+    }
+    tree_->set(slot, leafWeight(slot));
+  }
 
+  double leafWeight(size_t slot) const {
+    return std::max(weights_[slot], 0.0f) *
+        recency(times_[slot], base_time_.load()) *
+        versionWeight(versions_[slot], base_version_.load());
+  }
 
+  int commit(size_t n) {
+    size_t prev = committed_.fetch_add(n);
+    if (prev >= capacity_)
+      return 0;
+    return static_cast<int>(std::min(n, capacity_ - prev));
+  }
+
+  // A slot freed while the table is scanned may be missed, in which case
+  // the sampler pins in overflowPins_ instead.
+  int pin() {
+    size_t start =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % kMaxPins;
+    for (size_t i = 0; i < kMaxPins; ++i) {
+      size_t idx = (start + i) % kMaxPins;
+      uint64_t expected = 0;
+      if (pins_[idx].compare_exchange_strong(expected, epoch_.load())) {
+        return static_cast<int>(idx);
+      }
+    }
 
+    std::lock_guard<std::mutex> lock(overflowMutex_);
+    size_t idx = 0;
+    while (idx < overflowPins_.size() && overflowPins_[idx] != 0) {
+      ++idx;
+    }
+    if (idx == overflowPins_.size()) {
+      overflowPins_.push_back(0);
+    }
+    overflowPins_[idx] = epoch_.load();
+    return static_cast<int>(kMaxPins + idx);
+  }
 
+  void unpin(int idx) {
+    if (size_t(idx) < kMaxPins) {
+      pins_[idx] = 0;
+    } else {
+      std::lock_guard<std::mutex> lock(overflowMutex_);
+      overflowPins_[idx - kMaxPins] = 0;
+    }
+  }
 
+  void retire(const std::vector<T*>& olds) {
+    std::vector<T*> to_free;
+    {
+      std::lock_guard<std::mutex> lock(retireMutex_);
+      uint64_t e = epoch_.load();
+      for (T* p : olds) {
+        retired_.emplace_back(e, p);
+      }
+
+      if (retired_.size() >= kReclaimThreshold) {
+        // Anything retired before this point can only be seen by samplers
+        // pinned at an epoch <= e.
+        epoch_++;
+
+        uint64_t min_pinned = std::numeric_limits<uint64_t>::max();
+        for (const auto& p : pins_) {
+          uint64_t v = p.load();
+          if (v != 0)
+            min_pinned = std::min(min_pinned, v);
+        }
+        {
+          std::lock_guard<std::mutex> overflow_lock(overflowMutex_);
+          for (uint64_t v : overflowPins_) {
+            if (v != 0)
+              min_pinned = std::min(min_pinned, v);
+          }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < retired_.size(); ++i) {
+          if (retired_[i].first < min_pinned) {
+            to_free.push_back(retired_[i].second);
+          } else {
+            retired_[kept++] = retired_[i];
+          }
+        }
+        retired_.resize(kept);
+      }
+      num_retired_ = retired_.size();
+    }
+
+    // Free outside of the lock.
+    for (T* p : to_free) {
+      delete p;
+    }
+  }
+};
 
 struct InsertInfo {
   bool success = true;
@@ -201,8 +516,8 @@ class ReaderQueuesT {
   using ReaderQueue = ReaderQueueT<T>;
 
   ReaderQueuesT(const RQCtrl& reader_ctrl)
-      : min_size_satisfied_(false),
-        parity_sizes_(2, 0),
+      : prioritized_(reader_ctrl.ctrl.prioritized),
+        min_size_satisfied_(false),
         logger_(
             elf::logging::getIndexedLogger("elf::distributed::ReaderQueuesT-", "")) {
     // Make sure this is an even number.
@@ -217,9 +532,17 @@ class ReaderQueuesT {
   InsertInfo Insert(std::vector<T>&& vs, std::function<int()> g) {
     InsertInfo info;
 
-    int delta = 0;
+    // Group records per queue so that each queue gets a single bulk insert.
+    std::vector<std::vector<T>> per_queue(qs_.size());
     for (auto&& v : vs) {
-      delta += insert_impl(g(), std::move(v));
+      per_queue[g()].push_back(std::move(v));
+    }
+
+    int delta = 0;
+    for (size_t i = 0; i < per_queue.size(); ++i) {
+      if (!per_queue[i].empty()) {
+        delta += insert_impl(i, std::move(per_queue[i]));
+      }
     }
 
     info.success = true;
@@ -257,11 +580,32 @@ class ReaderQueuesT {
     });
   }
 
+  // See ReaderQueueT::setWeightFunction. Call before any insertion.
+  void setWeightFunction(std::function<float(const T&)> weight_fn) {
+    for (auto& q : qs_) {
+      q->setWeightFunction(weight_fn);
+    }
+  }
+
+  // See ReaderQueueT::setVersionFunction. Call before any insertion.
+  void setVersionFunction(std::function<int64_t(const T&)> version_fn) {
+    for (auto& q : qs_) {
+      q->setVersionFunction(version_fn);
+    }
+  }
+
+  InsertInfo Insert(std::vector<T>&& vs, std::mt19937* rng) {
+    return Insert(
+        std::move(vs), [rng, this]() -> int { return (*rng)() % qs_.size(); });
+  }
+
   void clear() {
     min_size_satisfied_ = false;
     for (auto& q : qs_) {
       q->clear();
     }
+    parity_sizes_[0] = 0;
+    parity_sizes_[1] = 0;
   }
 
   std::vector<T> dumpAll() const {
@@ -302,10 +646,9 @@ class ReaderQueuesT {
 
     // Then we sample according to this ratio.
     std::uniform_real_distribution<> dis(0.0, 1.0);
-    int idx = (*rng)() % (qs_.size() / 2);
-    idx *= 2;
-    if (dis(*rng) > even_ratio)
-      idx++;
+    int parity = dis(*rng) > even_ratio ? 1 : 0;
+    int idx = prioritized_ ? pick_weighted_queue(rng, parity)
+                           : 2 * ((*rng)() % (qs_.size() / 2)) + parity;
 
     if (p_idx != nullptr)
       *p_idx = idx;
@@ -333,31 +676,69 @@ class ReaderQueuesT {
 
  private:
   std::vector<std::unique_ptr<ReaderQueue>> qs_;
+  bool prioritized_;
   size_t min_size_per_queue_ = 0;
   std::atomic_bool min_size_satisfied_;
 
-  size_t total_insertion_ = 0;
-  std::vector<int> parity_sizes_;
+  std::atomic<size_t> total_insertion_{0};
+  std::array<std::atomic<int>, 2> parity_sizes_ = {{0, 0}};
 
   std::shared_ptr<spdlog::logger> logger_;
 
   int insert_impl(int idx, T&& v) {
-    int delta = qs_[idx]->Insert(std::move(v));
+    size_t prev = total_insertion_.fetch_add(1);
+    int delta = qs_[idx]->Insert(std::move(v), prev);
+    on_inserted(idx, prev, 1, delta);
+    return delta;
+  }
+
+  int insert_impl(int idx, std::vector<T>&& vs) {
+    size_t n = vs.size();
+    size_t prev = total_insertion_.fetch_add(n);
+    int delta = qs_[idx]->Insert(std::move(vs), prev);
+    on_inserted(idx, prev, n, delta);
+    return delta;
+  }
 
-    total_insertion_++;
+  // Pick a queue of the given parity proportionally to its total weight.
+  int pick_weighted_queue(std::mt19937* rng, int parity) const {
+    double now = total_insertion_.load();
+    double newest_version = 0.0;
+    for (const auto& q : qs_) {
+      newest_version = std::max(newest_version, q->newestVersion());
+    }
+    std::vector<double> weights;
+    double total = 0.0;
+    for (size_t i = parity; i < qs_.size(); i += 2) {
+      weights.push_back(qs_[i]->totalWeight(now, newest_version));
+      total += weights.back();
+    }
+    if (total <= 0)
+      return 2 * ((*rng)() % (qs_.size() / 2)) + parity;
+
+    std::uniform_real_distribution<> dis(0.0, total);
+    double u = dis(*rng);
+    size_t k = 0;
+    while (k + 1 < weights.size() && u >= weights[k]) {
+      u -= weights[k++];
+    }
+    return 2 * k + parity;
+  }
+
+  void on_inserted(int idx, size_t prev, size_t n, int delta) {
     parity_sizes_[idx % 2] += delta;
 
-    if (total_insertion_ % 1000 == 0) {
-      float even_ratio = static_cast<float>(parity_sizes_[0]) /
-          (parity_sizes_[0] + parity_sizes_[1] + 1e-6);
+    if (prev / 1000 != (prev + n) / 1000) {
+      int even = parity_sizes_[0];
+      int odd = parity_sizes_[1];
+      float even_ratio = static_cast<float>(even) / (even + odd + 1e-6);
       logger_->info(
           "ReaderQueue Insertion: {}, even: {} {}%, odd {}: ",
-          total_insertion_,
-          parity_sizes_[0],
+          prev + n,
+          even,
           100 * even_ratio,
-          parity_sizes_[1]);
+          odd);
     }
-    return delta;
   }
 
   bool sufficient_per_queue_size() const {
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace elf {
+
+namespace shared {
+
+// Binary tree of partial sums over a fixed number of non-negative leaf
+// weights. set() and find() are O(log n).
+//
+// Internal nodes are updated with atomic deltas, so find() can run
+// concurrently with set() without a lock. A concurrent reader may see a
+// parent sum that does not match its children yet; find() then clamps to
+// the last leaf of the subtree and the caller is expected to check the
+// returned leaf (e.g. retry if it has zero weight). Calls to set() and
+// rebuild() must be serialized by the caller.
+class SumTree {
+ public:
+  explicit SumTree(size_t n) : n_(n) {
+    leaves_ = 1;
+    while (leaves_ < n_) {
+      leaves_ *= 2;
+    }
+    nodes_.reset(new std::atomic<double>[2 * leaves_]);
+    clear();
+  }
+
+  size_t size() const {
+    return n_;
+  }
+
+  double total() const {
+    return nodes_[1].load();
+  }
+
+  double get(size_t i) const {
+    return nodes_[leaves_ + i].load();
+  }
+
+  void set(size_t i, double w) {
+    size_t idx = leaves_ + i;
+    double delta = w - nodes_[idx].exchange(w);
+    for (idx /= 2; idx >= 1; idx /= 2) {
+      add(&nodes_[idx], delta);
+    }
+    // Float deltas drift over time, recompute every n updates.
+    if (++num_updates_ >= n_) {
+      rebuild();
+    }
+  }
+
+  // Return the leaf i such that sum(w[0..i-1]) <= u < sum(w[0..i]).
+  size_t find(double u) const {
+    size_t idx = 1;
+    while (idx < leaves_) {
+      double left = nodes_[2 * idx].load();
+      if (u < left) {
+        idx = 2 * idx;
+      } else {
+        u -= left;
+        idx = 2 * idx + 1;
+      }
+    }
+    idx -= leaves_;
+    return idx < n_ ? idx : n_ - 1;
+  }
+
+  // Recompute all internal nodes from the leaves.
+  void rebuild() {
+    for (size_t idx = leaves_ - 1; idx >= 1; --idx) {
+      nodes_[idx] = nodes_[2 * idx].load() + nodes_[2 * idx + 1].load();
+    }
+    num_updates_ = 0;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < 2 * leaves_; ++i) {
+      nodes_[i] = 0.0;
+    }
+    num_updates_ = 0;
+  }
+
+ private:
+  size_t n_;
+  size_t leaves_;
+  std::unique_ptr<std::atomic<double>[]> nodes_;
+  size_t num_updates_ = 0;
+
+  static void add(std::atomic<double>* node, double delta) {
+    double v = node->load();
+    while (!node->compare_exchange_weak(v, v + delta)) {
+    }
+  }
+};
+
+} // namespace shared
+
+} // namespace elf
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/*
+  MCTS rollouts/sec against the number of threads, with all the threads on
+  one tree (tree parallelism) and with one tree per thread (root
+  parallelism):
+
+    mcts_bench [--max_threads N] [--rollouts R] [--batch B]
+               [--branching K] [--eval_us U] [--seconds S]
+
+  The game is synthetic: K moves from each state, with hashed priors and
+  values. Each batch of leaves waits U microseconds, as for the network.
+
+  It then prints, for one tree per thread, how far the merged root visits
+  are from those of the first tree (total variation distance), with the
+  root noise of selfplay (root_epsilon) and with that of eval and play
+  (root_epsilon = 0, tree_epsilon). 0 would mean the trees search alike.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "elf/ai/tree_search/tree_search.h"
+
+using namespace elf::ai::tree_search;
+
+namespace {
+
+int branching = 30;
+int eval_us = 0;
+
+struct BenchState {
+  uint64_t hash = 0;
+  int ply = 0;
+
+  bool operator==(const BenchState& other) const {
+    return hash == other.hash && ply == other.ply;
+  }
+};
+
+struct BenchActor {
+  using State = BenchState;
+  using Action = int;
+
+  std::mt19937 rng_;
+
+  explicit BenchActor(int seed) : rng_(seed) {}
+
+  std::string info() const {
+    return "";
+  }
+
+  std::mt19937* rng() {
+    return &rng_;
+  }
+
+  bool forward(BenchState& s, int a) {
+    if (s.ply >= 200) {
+      return false;
+    }
+    s.hash = (s.hash ^ (a + 1)) * 0x9E3779B97F4A7C15ull;
+    s.ply++;
+    return true;
+  }
+
+  void evaluate(
+      const std::vector<const BenchState*>& states,
+      std::vector<NodeResponseT<int>>* resps) {
+    if (eval_us > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(eval_us));
+    }
+    resps->resize(states.size());
+    for (size_t i = 0; i < states.size(); ++i) {
+      evaluate(*states[i], &(*resps)[i]);
+    }
+  }
+
+  void evaluate(const BenchState& s, NodeResponseT<int>* resp) {
+    resp->pi.clear();
+    float total = 0;
+    for (int a = 0; a < branching; ++a) {
+      float p = 1 + ((s.hash >> (a % 48)) & 0xF);
+      resp->pi.emplace_back(a, p);
+      total += p;
+    }
+    for (auto& p : resp->pi) {
+      p.second /= total;
+    }
+    resp->value = (s.hash % 2001) / 1000.0f - 1.0f;
+    resp->q_flip = s.ply % 2 == 1;
+  }
+};
+
+double rolloutsPerSecond(TSOptions options, double seconds) {
+  const int num_trees = options.num_trees;
+  TreeSearchT<BenchState, int, BenchActor> ts(options, [num_trees](int i) {
+    return new BenchActor(i % num_trees);
+  });
+
+  using clock = std::chrono::steady_clock;
+  uint64_t done = 0;
+  auto start = clock::now();
+  std::chrono::duration<double> elapsed(0);
+  while (elapsed.count() < seconds) {
+    ts.clear();
+    ts.run(BenchState());
+    done += options.num_threads * options.num_rollouts_per_thread;
+    elapsed = clock::now() - start;
+  }
+  return done / elapsed.count();
+}
+
+std::vector<double> visitShares(
+    const std::vector<std::pair<int, EdgeInfo>>& actions) {
+  std::vector<double> shares(branching, 0.0);
+  double total = 0;
+  for (const auto& p : actions) {
+    shares[p.first] += p.second.num_visits;
+    total += p.second.num_visits;
+  }
+  for (auto& share : shares) {
+    share /= std::max(total, 1.0);
+  }
+  return shares;
+}
+
+double mergedDistanceToFirstTree(TSOptions options) {
+  const int num_trees = options.num_trees;
+  TreeSearchT<BenchState, int, BenchActor> ts(options, [num_trees](int i) {
+    return new BenchActor(i % num_trees);
+  });
+  auto merged = visitShares(ts.run(BenchState()).action_edge_pairs);
+  auto first = visitShares(ts.getTreeRootActions(0));
+  double distance = 0;
+  for (int a = 0; a < branching; ++a) {
+    distance += std::abs(merged[a] - first[a]);
+  }
+  return distance / 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  int max_threads = 16;
+  double seconds = 1.0;
+
+  TSOptions options;
+  options.verbose = false;
+  options.persistent_tree = false;
+  options.num_rollouts_per_thread = 400;
+  options.num_rollouts_per_batch = 8;
+  options.virtual_loss = 1;
+  options.alg_opt.c_puct = 1.5;
+  // Root noise, without which the trees of root parallelism would search
+  // alike.
+  options.root_epsilon = 0.25;
+  options.root_alpha = 0.3;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--max_threads" && i + 1 < argc) {
+      max_threads = std::atoi(argv[++i]);
+    } else if (arg == "--rollouts" && i + 1 < argc) {
+      options.num_rollouts_per_thread = std::atoi(argv[++i]);
+    } else if (arg == "--batch" && i + 1 < argc) {
+      options.num_rollouts_per_batch = std::atoi(argv[++i]);
+    } else if (arg == "--branching" && i + 1 < argc) {
+      branching = std::atoi(argv[++i]);
+    } else if (arg == "--eval_us" && i + 1 < argc) {
+      eval_us = std::atoi(argv[++i]);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      seconds = std::atof(argv[++i]);
+    } else {
+      std::fprintf(
+          stderr,
+          "Usage: %s [--max_threads N] [--rollouts R] [--batch B] "
+          "[--branching K] [--eval_us U] [--seconds S]\n",
+          argv[0]);
+      return 1;
+    }
+  }
+
+  std::printf("%8s %14s %14s\n", "threads", "one tree", "tree/thread");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    options.num_threads = threads;
+    options.num_trees = 1;
+    double shared = rolloutsPerSecond(options, seconds);
+    options.num_trees = threads;
+    double root_parallel = rolloutsPerSecond(options, seconds);
+    std::printf("%8d %14.0f %14.0f\n", threads, shared, root_parallel);
+  }
+
+  std::printf(
+      "\n%8s %14s %14s\n", "trees", "root_epsilon", "tree_epsilon");
+  for (int threads = 2; threads <= max_threads; threads *= 2) {
+    options.num_threads = threads;
+    options.num_trees = threads;
+    double selfplay = mergedDistanceToFirstTree(options);
+    TSOptions eval_options = options;
+    eval_options.root_epsilon = 0.0;
+    double eval = mergedDistanceToFirstTree(eval_options);
+    std::printf("%8d %14.3f %14.3f\n", threads, selfplay, eval);
+  }
+  return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/*
+  PUCT child selection throughput:
+
+    puct_bench [--nodes N] [--seconds S]
+
+  Edge stats are random, as in a tree halfway through a search. Checks
+  that every kernel picks the same edges, then prints selections/sec of
+  the scalar, AVX2 and AVX-512 kernels, and of puctSelect() which picks
+  one of them, for the branching factors of checkers (8 to 30) and
+  ugolki (up to 256).
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "elf/ai/tree_search/puct_kernel.h"
+
+using namespace elf::ai::tree_search;
+
+namespace {
+
+// Stats of nodes with n edges each, one after the other.
+struct RandomNodes {
+  size_t n;
+  std::vector<float> prior;
+  std::vector<int> num_visits;
+  std::vector<float> reward;
+  std::vector<float> virtual_loss;
+
+  RandomNodes(size_t num_nodes, size_t n) : n(n) {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (size_t i = 0; i < num_nodes * n; ++i) {
+      prior.push_back(unit(rng) / n);
+      int v = (rng() % 4 == 0) ? 0 : rng() % 200;
+      num_visits.push_back(v);
+      reward.push_back(v * (2 * unit(rng) - 1));
+      virtual_loss.push_back(rng() % 8 == 0 ? 1.0f : 0.0f);
+    }
+  }
+
+  size_t size() const {
+    return num_visits.size() / n;
+  }
+
+  PuctEdges edges(size_t node) const {
+    size_t first = node * n;
+    return PuctEdges{&prior[first],
+                     &num_visits[first],
+                     &reward[first],
+                     &virtual_loss[first],
+                     n};
+  }
+};
+
+PuctParams params(size_t node) {
+  PuctParams p;
+  p.c_puct = 1.5f;
+  p.flip_q_sign = node % 2;
+  p.parent_visits = 1 + node % 5000;
+  p.unsigned_default_q = 0.1f;
+  return p;
+}
+
+// Selections/sec of f(edges, params).
+template <typename F>
+double selectionsPerSecond(const RandomNodes& nodes, double seconds, F f) {
+  using clock = std::chrono::steady_clock;
+  uint64_t done = 0;
+  int sink = 0;
+  auto start = clock::now();
+  std::chrono::duration<double> elapsed(0);
+  while (elapsed.count() < seconds) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      sink += f(nodes.edges(i), params(i)).best;
+    }
+    done += nodes.size();
+    elapsed = clock::now() - start;
+  }
+  if (sink == -1) {
+    std::printf("\n");
+  }
+  return done / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t num_nodes = 1 << 12;
+  double seconds = 1.0;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--nodes" && i + 1 < argc) {
+      num_nodes = std::atoi(argv[++i]);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      seconds = std::atof(argv[++i]);
+    } else {
+      std::fprintf(stderr, "Usage: %s [--nodes N] [--seconds S]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  bool has_avx2 = elf_utils::cpu_has_avx2();
+  bool has_avx512 = elf_utils::cpu_has_avx512f();
+  std::printf(
+      "AVX2: %s, AVX-512: %s\n",
+      has_avx2 ? "yes" : "no",
+      has_avx512 ? "yes" : "no");
+
+  auto scalar = [](const PuctEdges& e, const PuctParams& p) {
+    return puctSelectScalar(e, p);
+  };
+  auto avx2 = [](const PuctEdges& e, const PuctParams& p) {
+#ifdef ELF_TARGET_AVX2
+    return detail::puctSelectAVX2(e, detail::PuctConsts(p));
+#else
+    return puctSelectScalar(e, p);
+#endif
+  };
+  auto avx512 = [](const PuctEdges& e, const PuctParams& p) {
+#ifdef ELF_TARGET_AVX512
+    return detail::puctSelectAVX512(e, detail::PuctConsts(p));
+#else
+    return puctSelectScalar(e, p);
+#endif
+  };
+
+  std::printf(
+      "%6s %14s %14s %14s %14s\n",
+      "edges",
+      "scalar",
+      "AVX2",
+      "AVX-512",
+      "puctSelect");
+  for (size_t n : {8, 16, 30, 64, 128, 256}) {
+    RandomNodes nodes(num_nodes, n);
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      int best = scalar(nodes.edges(i), params(i)).best;
+      if ((has_avx2 && avx2(nodes.edges(i), params(i)).best != best) ||
+          (has_avx512 && avx512(nodes.edges(i), params(i)).best != best)) {
+        std::fprintf(
+            stderr, "Kernels disagree on node %zu of %zu edges\n", i, n);
+        return 1;
+      }
+    }
+
+    std::printf(
+        "%6zu %14.0f %14.0f %14.0f %14.0f\n",
+        n,
+        selectionsPerSecond(nodes, seconds, scalar),
+        has_avx2 ? selectionsPerSecond(nodes, seconds, avx2) : 0.0,
+        has_avx512 ? selectionsPerSecond(nodes, seconds, avx512) : 0.0,
+        selectionsPerSecond(nodes, seconds, puctSelect));
+  }
+  return 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Helpers to build 8x8 input planes from 64-bit board masks
+// (bit = y * 8 + x), written straight into the feature memory.
+namespace elf_utils {
+
+// Bit i goes to bit 63 - i, i.e. the board turned by 180 degrees.
+inline uint64_t reverse_bits(uint64_t b) {
+  b = ((b >> 1) & 0x5555555555555555ULL) | ((b & 0x5555555555555555ULL) << 1);
+  b = ((b >> 2) & 0x3333333333333333ULL) | ((b & 0x3333333333333333ULL) << 2);
+  b = ((b >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((b & 0x0F0F0F0F0F0F0F0FULL) << 4);
+  return __builtin_bswap64(b);
+}
+
+// plane[i] = 1.0 if bit i of mask is set, 0.0 otherwise (64 floats).
+inline void bits_to_plane(uint64_t mask, float* plane) {
+#if defined(__AVX2__)
+  const __m256i select = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  for (int i = 0; i < 8; ++i) {
+    __m256i row = _mm256_set1_epi32((mask >> (8 * i)) & 0xff);
+    __m256i on =
+        _mm256_cmpeq_epi32(_mm256_and_si256(row, select), select);
+    _mm256_storeu_ps(
+        plane + 8 * i, _mm256_and_ps(_mm256_castsi256_ps(on), one));
+  }
+#elif defined(__SSE2__)
+  const __m128i select = _mm_setr_epi32(1, 2, 4, 8);
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (int i = 0; i < 16; ++i) {
+    __m128i quad = _mm_set1_epi32((mask >> (4 * i)) & 0xf);
+    __m128i on = _mm_cmpeq_epi32(_mm_and_si128(quad, select), select);
+    _mm_storeu_ps(plane + 4 * i, _mm_and_ps(_mm_castsi128_ps(on), one));
+  }
+#else
+  for (int i = 0; i < 64; ++i) {
+    plane[i] = (mask >> i) & 1 ? 1.0f : 0.0f;
+  }
+#endif
+}
+
+} // namespace elf_utils
@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// Run-time selection of SIMD kernels. A kernel marked ELF_TARGET_AVX2 is
+// compiled for AVX2 whatever the build flags, and may only be called
+// when cpu_has_avx2() is true (the same for ELF_TARGET_AVX512 and
+// cpu_has_avx512f()):
+//
+//   #ifdef ELF_TARGET_AVX2
+//   ELF_TARGET_AVX2 void kernelAVX2(...) { ... }
+//   #endif
+//
+//   #ifdef ELF_TARGET_AVX2
+//     if (elf_utils::cpu_has_avx2())
+//       return kernelAVX2(...);
+//   #endif
+//     kernelScalar(...);
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ELF_TARGET_AVX2 __attribute__((target("avx2")))
+#define ELF_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace elf_utils {
+
+inline bool cpu_has_avx2() {
+#ifdef ELF_TARGET_AVX2
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+#else
+  return false;
+#endif
+}
+
+inline bool cpu_has_avx512f() {
+#ifdef ELF_TARGET_AVX512
+  static const bool has_avx512f = __builtin_cpu_supports("avx512f");
+  return has_avx512f;
+#else
+  return false;
+#endif
+}
+
+} // namespace elf_utils
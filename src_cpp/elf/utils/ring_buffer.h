@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace elf_utils {
+
+// Keeps the last N pushed items in place, without allocation. With a
+// trivially copyable T the whole buffer is trivially copyable, so game
+// states holding one stay cheap to copy.
+template <typename T, size_t N>
+class RingBuffer {
+ public:
+  static_assert(N > 0, "RingBuffer needs room for one item");
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  // Overwrites the oldest item once full.
+  void push_back(const T& v) {
+    head_ = head_ + 1 == N ? 0 : head_ + 1;
+    items_[head_] = v;
+    if (size_ < N)
+      size_++;
+  }
+
+  // 0 is the oldest item, size() - 1 the last pushed one.
+  const T& operator[](size_t i) const {
+    size_t idx = head_ + N - (size_ - 1 - i);
+    return items_[idx >= N ? idx - N : idx];
+  }
+
+  const T& back() const {
+    return items_[head_];
+  }
+
+  void clear() {
+    head_ = N - 1;
+    size_ = 0;
+  }
+
+ private:
+  std::array<T, N> items_{};
+  size_t head_ = N - 1;
+  size_t size_ = 0;
+};
+
+} // namespace elf_utils
@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cmath>
+
+namespace elf_utils {
+
+// Sequential probability ratio test of H0: elo = elo0 against
+// H1: elo = elo1, on games won, drawn and lost (a draw is half a point).
+// alpha and beta are the chances of accepting H1 when H0 holds and H0
+// when H1 holds.
+//
+// The log-likelihood ratio is the usual approximation for a trinomial
+// score, (s1 - s0) * (2 * s - s0 - s1) * n / (2 * var), with s the mean
+// score and var its variance per game. The variance counts half a game of
+// each result more, so that a run of wins alone still has a finite ratio.
+class Sprt {
+ public:
+  enum Result { SPRT_CONTINUE, SPRT_H0, SPRT_H1 };
+
+  Sprt(float elo0, float elo1, float alpha, float beta)
+      : score0_(eloToScore(elo0)),
+        score1_(eloToScore(elo1)),
+        lower_(std::log(beta / (1.0 - alpha))),
+        upper_(std::log((1.0 - beta) / alpha)) {}
+
+  static double eloToScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+  }
+
+  double lowerBound() const {
+    return lower_;
+  }
+
+  double upperBound() const {
+    return upper_;
+  }
+
+  double llr(int wins, int draws, int losses) const {
+    const int n = wins + draws + losses;
+    if (n == 0)
+      return 0.0;
+
+    const double score = (wins + 0.5 * draws) / n;
+
+    const double w = wins + 0.5, d = draws + 0.5, l = losses + 0.5;
+    const double m = (w + 0.5 * d) / (w + d + l);
+    const double var = (w * (1.0 - m) * (1.0 - m) + d * (0.5 - m) * (0.5 - m) +
+                        l * m * m) /
+        (w + d + l);
+
+    return (score1_ - score0_) * (2.0 * score - score0_ - score1_) * n /
+        (2.0 * var);
+  }
+
+  Result test(int wins, int draws, int losses) const {
+    const double r = llr(wins, draws, losses);
+    if (r >= upper_)
+      return SPRT_H1;
+    if (r <= lower_)
+      return SPRT_H0;
+    return SPRT_CONTINUE;
+  }
+
+ private:
+  double score0_;
+  double score1_;
+  double lower_;
+  double upper_;
+};
+
+} // namespace elf_utils
@@ -40,7 +40,7 @@
   ai1 - uses MCTS for searching best action. Responsible for
       generating batches for training the neural network.
   ai2 - also uses MCTS. Initialized only when the client receives
-      a notification from the server to compare two models.
+      a notification from the server (or LocalArena) to compare two models.
   _human_player - The base class AIClientT that sends batch files from C++ to python 
       and expects to receive an answer. In our case, these are the keys that 
       we registered in the GameFeature.h and game.py files namely by 
@@ -57,7 +57,9 @@ class ClientGameSelfPlay : public GameBase {
       const ContextOptions& context_options,
       const GameOptions& game_options,
       ThreadedDispatcher* dispatcher,
-      GameNotifierBase* gameNotifier = nullptr);
+      GameNotifierBase* gameNotifier = nullptr,
+      const GameTablebase* tablebase = nullptr,
+      GameRequesterBase* arena = nullptr);
 
   bool OnReceive(const MsgRequest& request, RestartReply* reply);
 
@@ -84,14 +86,22 @@ class ClientGameSelfPlay : public GameBase {
   void setAsync();
   Coord mcts_make_diverse_move(MCTSGameAI* mcts_ai, Coord c);
   Coord mcts_update_info(MCTSGameAI* mcts_ai, Coord c);
+  bool tablebase_result(float* final_value) const;
+  bool arena_request();
   void finish_game();
+  void finish_game(float final_value);
 
  private:
   ThreadedDispatcher* dispatcher_ = nullptr;
   GameNotifierBase* gameNotifier_ = nullptr;
+  const GameTablebase* tablebase_ = nullptr;
+  // Hands out the games in the arena mode, instead of dispatcher_.
+  GameRequesterBase* arena_ = nullptr;
   GameStateExt _game_state_ext;
 
   int _online_counter = 0;
+  // The arena has not handed out the current game yet.
+  bool _arena_waiting = true;
   std::unique_ptr<MCTSGameAI> _ai1;
   // Opponent ai (used for selfplay evaluation)
   std::unique_ptr<MCTSGameAI> _ai2;
@@ -83,12 +83,16 @@ class GameFeature {
       const GameStateExtOffline& s, 
       float* predicted_value) {
     *predicted_value = s.getPredictedValue(s._state.getPly() - 1);
+    if (s._aug_code == CHECKERS_AUG_FLIP_COLORS)
+      *predicted_value = -*predicted_value;
   }
 
   static void extractWinner(
       const GameStateExtOffline& s, 
       float* winner) {
     *winner = s._offline_winner;
+    if (s._aug_code == CHECKERS_AUG_FLIP_COLORS)
+      *winner = -*winner;
   }
 
   static void extractGameStateExt(
@@ -96,6 +100,16 @@ class GameFeature {
       float* f) {
     // Then send the data to the server.
     extractGameState(s._bf, f);
+
+    // The piece planes are already seen from the player's side, the
+    // colour flip only swaps the side-to-move planes of every board.
+    if (s._aug_code == CHECKERS_AUG_FLIP_COLORS) {
+      const int region = CHECKERS_BOARD_SIZE * CHECKERS_BOARD_SIZE;
+      for (int i = 0; i < MAX_CHECKERS_HISTORY; ++i) {
+        float* black = f + (6 * i + 4) * region;
+        std::swap_ranges(black, black + region, black + region);
+      }
+    }
   }
 
   // check it
@@ -114,15 +128,16 @@ class GameFeature {
       const auto& policy = s._mcts_policies[move_to].prob;
       float sum_v = 0.0;
       for (size_t i = 0; i < TOTAL_NUM_ACTIONS; ++i) {
-        mcts_scores[i] = policy[i];
-        sum_v += mcts_scores[i];
+        mcts_scores[CheckersAugmentAction(i, s._aug_code)] = policy[i];
+        sum_v += policy[i];
       }
       // Then we normalize.
       for (size_t i = 0; i < TOTAL_NUM_ACTIONS; ++i) {
         mcts_scores[i] /= sum_v;
       }
     } else {
-      mcts_scores[s._offline_all_moves[move_to]] = 1.0;
+      mcts_scores[CheckersAugmentAction(
+          s._offline_all_moves[move_to], s._aug_code)] = 1.0;
     }
   }
 
@@ -135,10 +150,16 @@ class GameFeature {
     const size_t move_to = s._state.getPly() - 1;
     for (int i = 0; i < s._game_options.checkers_num_future_actions; ++i) {
       Coord m = s._offline_all_moves[move_to + i];
-      offline_a[i] = m;
+      offline_a[i] = CheckersAugmentAction(m, s._aug_code);
     }
   }
 
+  static void extractAugCode(
+      const GameStateExtOffline& s, 
+      int* aug_code) {
+    *aug_code = s._aug_code;
+  }
+
   static void extractStateSelfplayVersion(
       const GameStateExtOffline& s, 
       int64_t* ver) {
@@ -209,6 +230,7 @@ class GameFeature {
         .addFunction<float>("winner", extractWinner)
         .addFunction<float>("mcts_scores", extractMCTSPi)
         .addFunction<int64_t>("offline_a", extractOfflineAction)
+        .addFunction<int32_t>("checkers_aug_code", extractAugCode)
         .addFunction<int64_t>("selfplay_ver", extractStateSelfplayVersion)
         ;
 
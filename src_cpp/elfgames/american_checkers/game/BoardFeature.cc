@@ -1,6 +1,8 @@
 #include "BoardFeature.h"
 #include "GameState.h"
 
+#include "elf/utils/bitplanes.h"
+
 static float* board_plane(float* features, int idx) {
   return features + idx * CHECKERS_BOARD_SIZE * CHECKERS_BOARD_SIZE;
 }
@@ -8,30 +10,6 @@ static float* board_plane(float* features, int idx) {
 // features param will taken from parent function 
 #define LAYER(idx) board_plane(features, idx)
 
-void BoardFeature::getKings(GameBoard board, int player, float* data) const {
-  std::array<std::array<int, 8>, 8> observation;
-  observation = GetObservation(board, player);
-  
-  for (int y = 0; y < CHECKERS_BOARD_SIZE; ++y) {
-    for (int x = 0; x < CHECKERS_BOARD_SIZE; ++x) {
-      if (observation[y][x] == 3)
-        data[y * CHECKERS_BOARD_SIZE + x] = 1;
-    }
-  }
-}
-
-void BoardFeature::getPawns(GameBoard board, int player, float* data) const {
-  std::array<std::array<int, 8>, 8> observation;
-  observation = GetObservation(board, player);
-  
-  for (int y = 0; y < CHECKERS_BOARD_SIZE; ++y) {
-    for (int x = 0; x < CHECKERS_BOARD_SIZE; ++x) {
-      if (observation[y][x] == 1)
-        data[y * CHECKERS_BOARD_SIZE + x] = 1;
-    }
-  }
-}
-
 // Extract game state, this method calls from GameFeature::extractState()
 // Filling the memory for submission to the assessment in the neural network.
 // vector features - depends on the number of features and size of the board.
@@ -45,33 +23,21 @@ void BoardFeature::extract(std::vector<float>* features) const {
 }
 
 void BoardFeature::extract(float* features) const {
-  int active_player;
-  int passive_player;
-  GameBoard _board;
-
-  std::fill(features, features + CHECKERS_NUM_FEATURES * kBoardRegion, 0.0);
-  int history_size = s_.getHistory().size();
-  int i = 0;
-  for (int j = history_size; j < MAX_CHECKERS_HISTORY; j++)
-    i++;
+  const GameState::History& history = s_.getHistory();
+  // Oldest boards first, missing ones are left empty.
+  int first = MAX_CHECKERS_HISTORY - history.size();
 
-  for (int k = 0; i < MAX_CHECKERS_HISTORY; i++, k++) {
-    _board = s_.getHistory()[k];
+  std::fill(features, LAYER(6 * first), 0.0);
+  for (size_t k = 0; k < history.size(); k++) {
+    const GameBoardHistory& board = history[k];
+    int i = first + k;
 
-    active_player = _board.active;
-    passive_player = _board.passive;
-
-    getPawns(_board, active_player, LAYER(6 * i + 0));
-    getKings(_board, active_player, LAYER(6 * i + 1));
-    getPawns(_board, passive_player, LAYER(6 * i + 2));
-    getKings(_board, passive_player, LAYER(6 * i + 3));
+    for (int j = 0; j < 4; j++) {
+      elf_utils::bits_to_plane(board.masks[j], LAYER(6 * i + j));
+    }
     // the player on move
-    float* black_indicator = LAYER(6 * i + 4);
-    float* white_indicator = LAYER(6 * i + 5);
-    if (active_player == BLACK_PLAYER)
-      std::fill(black_indicator, black_indicator + kBoardRegion, 1.0);
-    else
-      std::fill(white_indicator, white_indicator + kBoardRegion, 1.0);
-
+    bool black = board.active == BLACK_PLAYER;
+    std::fill(LAYER(6 * i + 4), LAYER(6 * i + 5), black ? 1.0 : 0.0);
+    std::fill(LAYER(6 * i + 5), LAYER(6 * i + 6), black ? 0.0 : 1.0);
   }
 }
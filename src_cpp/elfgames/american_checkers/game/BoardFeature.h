@@ -5,6 +5,18 @@
 // game
 #include "GameBoard.h"
 
+// One board of the history, reduced to what the features need.
+struct GameBoardHistory {
+  // See GetObservationMasks().
+  std::array<uint64_t, 4> masks;
+  int active;
+
+  GameBoardHistory() = default;
+  GameBoardHistory(const GameBoard& b)
+      : masks(GetObservationMasks(b)), active(b.active) {
+  }
+};
+
 class GameState;
 
 class BoardFeature {
@@ -22,10 +34,6 @@ class BoardFeature {
  private:
   const GameState& s_;
   static constexpr int64_t kBoardRegion = CHECKERS_BOARD_SIZE * CHECKERS_BOARD_SIZE;
-
-  // Compute features.
-  void getPawns(GameBoard board, int player, float* data) const;
-  void getKings(GameBoard board, int player, float* data) const;
 };
 
 /* 
@@ -1,5 +1,7 @@
 #include "GameBoard.h"
 
+#include "elf/utils/bitplanes.h"
+
 #define myassert(p, text) \
   do {                    \
     if (!(p)) {           \
@@ -32,6 +34,8 @@ void ClearBoard(GameBoard* board) {
     std::end(board->_last_move_white), -1);
   board->_black_repeats_step = 0;
   board->_white_repeats_step = 0;
+  board->_remove_step_black = false;
+  board->_remove_step_white = false;
 }
 
 bool CheckersPlay(GameBoard *board, int64_t action_index) {
@@ -50,8 +54,7 @@ bool CheckersPlay(GameBoard *board, int64_t action_index) {
   uint64_t buff;
   int buffer;
 
-  auto index = moves::i_to_m.find(action_index);
-  move = index->second[0];
+  move = _action_to_move(action_index)[0];
 
   board->_last_move = action_index;
   active = board->active;
@@ -109,9 +112,9 @@ bool CheckersPlay(GameBoard *board, int64_t action_index) {
   board->empty = UNUSED_BITS ^ MASK ^ (board->pieces[BLACK_PLAYER] | board->pieces[WHITE_PLAYER]);
 
   if (board->jump) {
-    // board->mandatory_jumps = _jumps_from(*board, destination);
-    // if (board->mandatory_jumps.size() != 0)
-    if (_jumps_from(*board, destination).size() != 0)
+    MoveList jumps;
+    _jumps_from(*board, destination, &jumps);
+    if (jumps.size != 0)
       return true;
   }
 
@@ -128,31 +131,22 @@ bool CheckersPlay(GameBoard *board, int64_t action_index) {
   return false;
 }
 
-std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(GameBoard board) {
+std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(const GameBoard& board) {
   std::array<int, TOTAL_NUM_ACTIONS> result;
-  std::vector<int64_t> moves;
-  std::string move_buff;
-  int buffer;
-  int total_moves = 0;
+  MoveList moves;
 
   result.fill(0);
-
-  moves = _get_moves(board);
-
-  for (auto i = moves.begin(); i != moves.end(); ++i) {
-    move_buff = std::to_string(*i) + ", "  + std::to_string(_get_move_direction(board, *i, board.active));
-    // print moves
-    // std::cout << move_buff << " : |" << moves::m_to_i.find(move_buff)->second << "|" << std::endl;
-    result[moves::m_to_i.find(move_buff)->second] = 1;
-    total_moves += 1;
+  _get_moves(board, board.active, &moves);
+  for (int i = 0; i < moves.size; ++i) {
+    result[moves.actions[i]] = 1;
   }
 
   // Repeat moves
-  if (total_moves > 1
+  if (moves.size > 1
       && board.active == WHITE_PLAYER 
       && board._white_repeats_step >= REPEAT_MOVE) {
     result[board._last_move_white[1]] = 0;
-  } else if (total_moves > 1
+  } else if (moves.size > 1
       && board.active == BLACK_PLAYER
       && board._black_repeats_step >= REPEAT_MOVE) {
     result[board._last_move_black[1]] = 0;
@@ -161,45 +155,28 @@ std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(GameBoard board) {
   return result;
 }
 
-std::vector<std::array<int64_t, 2>> GetValidMovesNumberAndDirection(GameBoard board, int player) {
+std::vector<std::array<int64_t, 2>> GetValidMovesNumberAndDirection(const GameBoard& board, int player) {
   std::vector<std::array<int64_t, 2>> result;
-  std::array<int64_t, 2> move_buff;
-  std::vector<int64_t> moves;
-  int buffer;
-
-  if (player != board.active) {
-    buffer = board.active;
-    board.active = board.passive;
-    board.passive = buffer;
+  MoveList moves;
 
-    moves = _get_moves(board);
-    for (auto i = moves.begin(); i != moves.end(); ++i) {
-      move_buff = {*i, _get_move_direction(board, *i, board.active)};
-      result.push_back(move_buff);
-    }
-
-    buffer = board.active;
-    board.active = board.passive;
-    board.passive = buffer;
-  } else {
-    moves = _get_moves(board);
-    for (auto i = moves.begin(); i != moves.end(); ++i) {
-      move_buff = {*i, _get_move_direction(board, *i, board.active)};
-      result.push_back(move_buff);
-    }
+  _get_moves(board, player, &moves);
+  for (int i = 0; i < moves.size; ++i) {
+    result.push_back(_action_to_move(moves.actions[i]));
   }
   return result;
 }
 
-bool CheckersTryPlay(GameBoard board, Coord c) {
+bool CheckersTryPlay(const GameBoard& board, Coord c) {
   std::array<int, TOTAL_NUM_ACTIONS> res = GetValidMovesBinary(board);
   if (res[c])
     return true;
   return false;
 }
 
-bool CheckersIsOver(GameBoard board) {
-  return (_get_moves(board).size() == 0);
+bool CheckersIsOver(const GameBoard& board) {
+  MoveList moves;
+  _get_moves(board, board.active, &moves);
+  return moves.size == 0;
 }
 
 // translates the board in 8x8 format 
@@ -280,6 +257,58 @@ std::array<std::array<int, 8>, 8> GetTrueState(GameBoard board) {
   return (GetObservation(board, BLACK_PLAYER));
 }
 
+namespace {
+
+// Board square (y * 8 + x) of every bit of the masks, same mapping as
+// GetObservation().
+struct SquareTable {
+  int8_t square[64];
+
+  SquareTable() {
+    memset(square, 0, sizeof(square));
+    for (int i = 0; i < 35; i++) {
+      int buff = i - i / 9;
+      int x = 6 - buff % 4 * 2 + buff / 4 % 2;
+      int y = 7 - buff / 4;
+      square[i] = y * 8 + x;
+    }
+  }
+};
+
+const SquareTable& squareTable() {
+  static const SquareTable table;
+  return table;
+}
+
+uint64_t toSquares(int64_t mask, bool turned) {
+  const int8_t* square = squareTable().square;
+  uint64_t squares = 0;
+
+  for (uint64_t b = mask & (MASK ^ UNUSED_BITS); b != 0; b &= b - 1) {
+    squares |= uint64_t(1) << square[__builtin_ctzll(b)];
+  }
+  return turned ? elf_utils::reverse_bits(squares) : squares;
+}
+
+} // namespace
+
+std::array<uint64_t, 4> GetObservationMasks(const GameBoard& board) {
+  // Black kings are the black pieces moving backward, white kings the
+  // white pieces moving forward.
+  int64_t pawns[2], kings[2];
+  kings[BLACK_PLAYER] = board.backward[BLACK_PLAYER];
+  pawns[BLACK_PLAYER] = board.forward[BLACK_PLAYER] & ~kings[BLACK_PLAYER];
+  kings[WHITE_PLAYER] = board.forward[WHITE_PLAYER];
+  pawns[WHITE_PLAYER] = board.backward[WHITE_PLAYER] & ~kings[WHITE_PLAYER];
+
+  int active = board.active;
+  int passive = board.passive;
+  return {toSquares(pawns[active], active == WHITE_PLAYER),
+          toSquares(kings[active], active == WHITE_PLAYER),
+          toSquares(pawns[passive], passive == WHITE_PLAYER),
+          toSquares(kings[passive], passive == WHITE_PLAYER)};
+}
+
 // for display in terminal
 std::string GetTrueStateStr(const GameBoard board) {
   std::array<std::array<int, 8>, 8> observation = GetTrueState(board);
@@ -318,36 +347,87 @@ void GameCopyBoard(GameBoard* dst, const GameBoard* src) {
 }
 
 // just board logic
-int64_t _right_forward(GameBoard board) {
-  return ((board.empty >> 4) & board.forward[board.active]);
+namespace {
+
+// Move generators, indexed like the masks below: right/left forward,
+// right/left backward. A move shifts the piece by kShift squares, a jump
+// by twice as much.
+enum MoveDirection { RF = 0, LF, RB, LB, NUM_MOVE_DIRECTIONS };
+constexpr int kShift[NUM_MOVE_DIRECTIONS] = {4, 5, 4, 5};
+
+// Action index of every move, keyed by (jump, direction, origin square),
+// and move of every action index. Built once from moves::i_to_m.
+struct ActionTable {
+  int16_t index[2][NUM_MOVE_DIRECTIONS][64];
+  std::array<std::array<int64_t, 2>, TOTAL_NUM_ACTIONS> move;
+
+  ActionTable() {
+    memset(index, -1, sizeof(index));
+    for (const auto& a : moves::i_to_m) {
+      int64_t m = a.second[0];
+      bool jump = m < 0;
+      uint64_t bits = static_cast<uint64_t>(jump ? -m : m);
+      int lo = __builtin_ctzll(bits);
+      int hi = 63 - __builtin_clzll(bits);
+      int shift = jump ? (hi - lo) / 2 : hi - lo;
+      bool forward = a.second[1];
+
+      int dir = forward ? (shift == 4 ? RF : LF) : (shift == 4 ? RB : LB);
+      index[jump][dir][forward ? lo : hi] = a.first;
+      move[a.first] = a.second;
+    }
+  }
+};
+
+const ActionTable& actionTable() {
+  static const ActionTable table;
+  return table;
 }
 
-int64_t _left_forward(GameBoard board) {
-  return ((board.empty >> 5) & board.forward[board.active]);
+// Append the moves of every origin square in mask.
+inline void addMoves(int64_t mask, bool jump, int dir, MoveList* moves) {
+  const auto& index = actionTable().index[jump][dir];
+  for (uint64_t b = mask; b != 0; b &= b - 1) {
+    int sq = __builtin_ctzll(b);
+    int shift = jump ? 2 * kShift[dir] : kShift[dir];
+    int lo = dir < RB ? sq : sq - shift;
+    int64_t move = ((int64_t(1) << shift) | 1) << lo;
+    moves->push(jump ? -move : move, index[sq]);
+  }
+}
+
+} // namespace
+
+int64_t _right_forward(const GameBoard& board, int player) {
+  return ((board.empty >> 4) & board.forward[player]);
 }
 
-int64_t _right_backward(GameBoard board) {
-  return ((board.empty << 4) & board.backward[board.active]);
+int64_t _left_forward(const GameBoard& board, int player) {
+  return ((board.empty >> 5) & board.forward[player]);
 }
 
-int64_t _left_backward(GameBoard board) {
-  return ((board.empty << 5) & board.backward[board.active]);
+int64_t _right_backward(const GameBoard& board, int player) {
+  return ((board.empty << 4) & board.backward[player]);
 }
 
-int64_t _right_forward_jumps(GameBoard board) {
-  return ((board.empty >> 8) & (board.pieces[board.passive] >> 4) & board.forward[board.active]);
+int64_t _left_backward(const GameBoard& board, int player) {
+  return ((board.empty << 5) & board.backward[player]);
 }
 
-int64_t _left_forward_jumps(GameBoard board) {
-  return ((board.empty >> 10) & (board.pieces[board.passive] >> 5) & board.forward[board.active]);
+int64_t _right_forward_jumps(const GameBoard& board, int player) {
+  return ((board.empty >> 8) & (board.pieces[1 - player] >> 4) & board.forward[player]);
 }
 
-int64_t _right_backward_jumps(GameBoard board) {
-  return ((board.empty << 8) & (board.pieces[board.passive] << 4) & board.backward[board.active]);
+int64_t _left_forward_jumps(const GameBoard& board, int player) {
+  return ((board.empty >> 10) & (board.pieces[1 - player] >> 5) & board.forward[player]);
 }
 
-int64_t _left_backward_jumps(GameBoard board) {
-  return ((board.empty << 10) & (board.pieces[board.passive] << 5) & board.backward[board.active]);
+int64_t _right_backward_jumps(const GameBoard& board, int player) {
+  return ((board.empty << 8) & (board.pieces[1 - player] << 4) & board.backward[player]);
+}
+
+int64_t _left_backward_jumps(const GameBoard& board, int player) {
+  return ((board.empty << 10) & (board.pieces[1 - player] << 5) & board.backward[player]);
 }
 
 int64_t _get_move_direction(GameBoard board, int64_t move, int player) {
@@ -356,173 +436,120 @@ int64_t _get_move_direction(GameBoard board, int64_t move, int player) {
   return (board.pieces[player] < (board.pieces[player] ^ move));
 }
 
-std::vector<int64_t> _get_moves(GameBoard board) {
+std::array<int64_t, 2> _action_to_move(Coord action) {
+  return actionTable().move[action];
+}
+
+void _get_moves(const GameBoard& board, int player, MoveList* moves) {
   /*
-    Returns a list of all possible moves.
+    Fills moves with all possible moves of player, jumps only if there
+    are some.
 
     A legal move is represented by an integer with exactly two
     bits turned on: the old position and the new position.
 
     Jumps are indicated with a negative sign.
   */
-  int64_t rf;
-  int64_t lf;
-  int64_t rb;
-  int64_t lb;
-  std::vector<int64_t> jumps;
-  std::vector<int64_t> moves;
-  uint64_t buff;
-  // First check if we are in a jump sequence
-  // if (board.jump) {
-  //  return (board.mandatory_jumps);
-  // }
-  // Next check if there are jumps
-  jumps = _get_jumps(board);
-  if (jumps.size() != 0) {
-    return (jumps);
-  } else {
-    rf = _right_forward(board);
-    lf = _left_forward(board);
-    rb = _right_backward(board);
-    lb = _left_backward(board);
-
-    buff = static_cast<uint64_t>(rf);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((static_cast<int64_t>(0x11) << i));
-    }
-
-    buff = static_cast<uint64_t>(lf);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((static_cast<int64_t>(0x21) << i));
-    }
-
-    buff = static_cast<uint64_t>(rb);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((static_cast<int64_t>(0x11) << (i - 4)));
-    }
-
-    buff = static_cast<uint64_t>(lb);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((static_cast<int64_t>(0x21) << (i - 5)));
-    }
-    return (moves);
-  }
+  moves->clear();
+  _get_jumps(board, player, board.pieces[player], moves);
+  if (moves->size != 0)
+    return;
+
+  addMoves(_right_forward(board, player), false, RF, moves);
+  addMoves(_left_forward(board, player), false, LF, moves);
+  addMoves(_right_backward(board, player), false, RB, moves);
+  addMoves(_left_backward(board, player), false, LB, moves);
 }
 
-std::vector<int64_t> _get_jumps(GameBoard board) {
+void _get_jumps(const GameBoard& board, int player, int64_t from, MoveList* moves) {
   /*
-    Returns a list of all possible jumps.
-
-    A legal move is represented by an integer with exactly two
-    bits turned on: the old position and the new position.
+    Appends all possible jumps of player's pieces in from.
 
-    Jumps are indicated with a negative sign.
+    A pawn is only in forward (black) or backward (white), a king in
+    both, so the masks need no special case for kings.
   */
-  int64_t rfj;
-  int64_t lfj;
-  int64_t rbj;
-  int64_t lbj;
-  std::vector<int64_t> moves;
-  uint64_t buff;
-
-  rfj = _right_forward_jumps(board);
-  lfj = _left_forward_jumps(board);
-  rbj = _right_backward_jumps(board);
-  lbj = _left_backward_jumps(board);
-  
-  if ((rfj | lfj | rbj | lbj) != 0) {
-    buff = static_cast<uint64_t>(rfj);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((0xfffffffffffffeff << i));
-    }
-
-    buff = static_cast<uint64_t>(lfj);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((0xfffffffffffffbff << i));
-    }
-
-    buff = static_cast<uint64_t>(rbj);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((0xfffffffffffffeff << (i - 8)));
-    }
-
-    buff = static_cast<uint64_t>(lbj);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((0xfffffffffffffbff << (i - 10)));
-    }
-  }
-  return (moves);
+  addMoves(_right_forward_jumps(board, player) & from, true, RF, moves);
+  addMoves(_left_forward_jumps(board, player) & from, true, LF, moves);
+  addMoves(_right_backward_jumps(board, player) & from, true, RB, moves);
+  addMoves(_left_backward_jumps(board, player) & from, true, LB, moves);
 }
 
-std::vector<int64_t> _jumps_from(GameBoard board, int64_t piece) {
+void _jumps_from(const GameBoard& board, int64_t piece, MoveList* moves) {
   /*
-      Returns list of all possible jumps from the piece indicated.
+      Fills moves with all possible jumps from the piece indicated.
 
       The argument piece should be of the form 2**n, where n + 1 is
       the square of the piece in question (using the internal numeric
       representaiton of the board).
   */
-  int64_t rfj;
-  int64_t lfj;
-  int64_t rbj;
-  int64_t lbj;
-  std::vector<int64_t> moves;
-  uint64_t buff;
+  moves->clear();
+  _get_jumps(board, board.active, piece, moves);
+}
 
-  if (board.active == BLACK_PLAYER) {
-    rfj = ((board.empty >> 8) & (board.pieces[board.passive] >> 4) & piece);
-    lfj = ((board.empty >> 10) & (board.pieces[board.passive] >> 5) & piece);
-    if (piece & board.backward[board.active]) { // piece at square is a king
-      rbj = ((board.empty << 8) & (board.pieces[board.passive] << 4) & piece);
-      lbj = ((board.empty << 10) & (board.pieces[board.passive] << 5) & piece);
-    } else {
-      rbj = 0;
-      lbj = 0;
-    }
-  } else {
-    rbj = ((board.empty << 8) & (board.pieces[board.passive] << 4) & piece);
-    lbj = ((board.empty << 10) & (board.pieces[board.passive] << 5) & piece);
-    if (piece & board.forward[board.active]) { // piece at square is a king
-      rfj = ((board.empty >> 8) & (board.pieces[board.passive] >> 4) & piece);
-      lfj = ((board.empty >> 10) & (board.pieces[board.passive] >> 5) & piece);
-    } else {
-      rfj = 0;
-      lfj = 0;
-    }
+// batched legal moves
+namespace {
+
+// Origin squares of the moves of every direction, then of the jumps, as
+// _right_forward() ... _left_backward_jumps().
+constexpr int kNumDirectionMasks = 2 * NUM_MOVE_DIRECTIONS;
+
+inline void directionMasks(const GameBoard& board, int64_t* masks) {
+  int player = board.active;
+  int64_t forward = board.forward[player];
+  int64_t backward = board.backward[player];
+  int64_t opponent = board.pieces[1 - player];
+  int64_t empty = board.empty;
+
+  masks[RF] = (empty >> 4) & forward;
+  masks[LF] = (empty >> 5) & forward;
+  masks[RB] = (empty << 4) & backward;
+  masks[LB] = (empty << 5) & backward;
+  masks[NUM_MOVE_DIRECTIONS + RF] = (empty >> 8) & (opponent >> 4) & forward;
+  masks[NUM_MOVE_DIRECTIONS + LF] = (empty >> 10) & (opponent >> 5) & forward;
+  masks[NUM_MOVE_DIRECTIONS + RB] = (empty << 8) & (opponent << 4) & backward;
+  masks[NUM_MOVE_DIRECTIONS + LB] = (empty << 10) & (opponent << 5) & backward;
+}
+
+// Turns the direction masks of board into its legal moves, as
+// GetValidMovesBinary(). out is zeroed.
+inline void addLegalMasks(
+    const GameBoard& board,
+    const int64_t* masks,
+    uint8_t* out) {
+  bool jump = false;
+  for (int d = 0; d < NUM_MOVE_DIRECTIONS; d++) {
+    jump |= masks[NUM_MOVE_DIRECTIONS + d] != 0;
   }
-  
-  if ((rfj | lfj | rbj | lbj) != 0) {
-    buff = static_cast<uint64_t>(rfj);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((0xfffffffffffffeff << i));
-    }
 
-    buff = static_cast<uint64_t>(lfj);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((0xfffffffffffffbff << i));
+  int count = 0;
+  for (int d = 0; d < NUM_MOVE_DIRECTIONS; d++) {
+    const auto& index = actionTable().index[jump][d];
+    int64_t mask = masks[(jump ? NUM_MOVE_DIRECTIONS : 0) + d];
+    for (uint64_t b = mask; b != 0; b &= b - 1) {
+      out[index[__builtin_ctzll(b)]] = 1;
+      count++;
     }
+  }
 
-    buff = static_cast<uint64_t>(rbj);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((0xfffffffffffffeff << (i - 8)));
-    }
+  // Repeat moves
+  if (count > 1
+      && board.active == WHITE_PLAYER
+      && board._white_repeats_step >= REPEAT_MOVE) {
+    out[board._last_move_white[1]] = 0;
+  } else if (count > 1
+      && board.active == BLACK_PLAYER
+      && board._black_repeats_step >= REPEAT_MOVE) {
+    out[board._last_move_black[1]] = 0;
+  }
+}
 
-    buff = static_cast<uint64_t>(lbj);
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1)
-        moves.push_back((0xfffffffffffffbff << (i - 10)));
-    }
+} // namespace
+
+void GenerateLegalMasks(const GameBoard* boards, size_t n, uint8_t* masks) {
+  memset(masks, 0, n * TOTAL_NUM_ACTIONS);
+  for (size_t i = 0; i < n; i++) {
+    int64_t dir[kNumDirectionMasks];
+    directionMasks(boards[i], dir);
+    addLegalMasks(boards[i], dir, masks + i * TOTAL_NUM_ACTIONS);
   }
-  return moves;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <queue>
 #include <vector>
 #include <memory.h>
@@ -86,32 +88,64 @@ typedef struct {
   int _white_repeats_step;
 } GameBoard;
 
-bool CheckersTryPlay(GameBoard board, Coord c);
+// Fixed-capacity move list, so move generation needs no allocation.
+// A king has at most 4 moves and a player at most 12 pieces.
+struct MoveList {
+  static constexpr int kMaxMoves = 48;
+
+  // Moves as in HashAllMoves.h (two bits on, negative for jumps).
+  std::array<int64_t, kMaxMoves> moves;
+  // Action index of each move.
+  std::array<Coord, kMaxMoves> actions;
+  int size = 0;
+
+  void push(int64_t move, Coord action) {
+    moves[size] = move;
+    actions[size] = action;
+    size++;
+  }
+
+  void clear() {
+    size = 0;
+  }
+};
+
+bool CheckersTryPlay(const GameBoard& board, Coord c);
 bool CheckersPlay(GameBoard *board, int64_t action);
-bool CheckersIsOver(GameBoard board);
+bool CheckersIsOver(const GameBoard& board);
 
 void ClearBoard(GameBoard *board);
 void GameCopyBoard(GameBoard* dst, const GameBoard* src);
 
-std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(GameBoard board);
-std::vector<std::array<int64_t, 2>> GetValidMovesNumberAndDirection(GameBoard board, int player);
+std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(const GameBoard& board);
+// GetValidMovesBinary() of n boards at once, as bytes: the moves of
+// boards[i] go to masks[i * TOTAL_NUM_ACTIONS]. There is no SIMD path:
+// with 32 squares, the scatter into action indices dominates and AVX2
+// lanes were slower.
+void GenerateLegalMasks(const GameBoard* boards, size_t n, uint8_t* masks);
+// Moves of player (active or not) with their direction.
+std::vector<std::array<int64_t, 2>> GetValidMovesNumberAndDirection(const GameBoard& board, int player);
 
 std::array<std::array<int, 8>, 8> GetTrueState(const GameBoard board);
 std::array<std::array<int, 8>, 8> GetObservation(const GameBoard board, int player);
+// Square masks (bit = y * 8 + x) of the cells GetObservation() marks
+// with 1 and 3 for the active player, then for the passive one.
+std::array<uint64_t, 4> GetObservationMasks(const GameBoard& board);
 std::string GetTrueStateStr(const GameBoard board);
 // std::string get_state_str(const GameBoard *board, int player);
 
 // board logic
-int64_t _right_forward(GameBoard board);
-int64_t _left_forward(GameBoard board);
-int64_t _right_backward(GameBoard board);
-int64_t _left_backward(GameBoard board);
-int64_t _right_forward_jumps(GameBoard board);
-int64_t _left_forward_jumps(GameBoard board);
-int64_t _right_backward_jumps(GameBoard board);
-int64_t _left_backward_jumps(GameBoard board);
+int64_t _right_forward(const GameBoard& board, int player);
+int64_t _left_forward(const GameBoard& board, int player);
+int64_t _right_backward(const GameBoard& board, int player);
+int64_t _left_backward(const GameBoard& board, int player);
+int64_t _right_forward_jumps(const GameBoard& board, int player);
+int64_t _left_forward_jumps(const GameBoard& board, int player);
+int64_t _right_backward_jumps(const GameBoard& board, int player);
+int64_t _left_backward_jumps(const GameBoard& board, int player);
 int64_t _get_move_direction(GameBoard board, int64_t move, int player);
-std::vector<int64_t> _get_moves(GameBoard board);
-std::vector<int64_t> _get_jumps(GameBoard board);
-std::vector<int64_t> _jumps_from(GameBoard board, int64_t piece);
-
+// {move, direction} of an action index, same as moves::i_to_m.
+std::array<int64_t, 2> _action_to_move(Coord action);
+void _get_moves(const GameBoard& board, int player, MoveList* moves);
+void _get_jumps(const GameBoard& board, int player, int64_t from, MoveList* moves);
+void _jumps_from(const GameBoard& board, int64_t piece, MoveList* moves);
@@ -0,0 +1,109 @@
+#include "GamePerft.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+struct PerftTask {
+  GameBoard board;
+  int depth;
+};
+
+// Expand the top of the tree until there is enough work for every thread.
+std::vector<PerftTask> splitTasks(
+    const GameBoard& board,
+    int depth,
+    size_t min_tasks) {
+  std::vector<PerftTask> tasks{{board, depth}};
+
+  while (tasks.size() < min_tasks && tasks[0].depth > 1) {
+    std::vector<PerftTask> next;
+    for (const auto& t : tasks) {
+      auto valid = GetValidMovesBinary(t.board);
+      for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+        if (!valid[c])
+          continue;
+        PerftTask child{t.board, t.depth - 1};
+        CheckersPlay(&child.board, c);
+        next.push_back(child);
+      }
+    }
+    tasks.swap(next);
+    if (tasks.empty())
+      break;
+  }
+  return tasks;
+}
+
+} // namespace
+
+uint64_t GamePerft(const GameBoard& board, int depth) {
+  if (depth <= 0)
+    return 1;
+
+  uint64_t nodes = 0;
+  auto valid = GetValidMovesBinary(board);
+  for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+    if (!valid[c])
+      continue;
+    GameBoard child = board;
+    CheckersPlay(&child, c);
+    nodes += GamePerft(child, depth - 1);
+  }
+  return nodes;
+}
+
+std::vector<std::pair<Coord, uint64_t>> GamePerftDivide(
+    const GameBoard& board,
+    int depth) {
+  std::vector<std::pair<Coord, uint64_t>> result;
+  auto valid = GetValidMovesBinary(board);
+  for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+    if (!valid[c])
+      continue;
+    GameBoard child = board;
+    CheckersPlay(&child, c);
+    result.emplace_back(c, GamePerft(child, depth - 1));
+  }
+  return result;
+}
+
+PerftResult GamePerftBenchmark(
+    const GameBoard& board,
+    int depth,
+    int num_threads) {
+  if (num_threads <= 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<PerftTask> tasks = splitTasks(board, depth, 8 * num_threads);
+  std::atomic<size_t> next_task(0);
+  std::atomic<uint64_t> nodes(0);
+
+  auto worker = [&]() {
+    uint64_t local = 0;
+    for (size_t i = next_task++; i < tasks.size(); i = next_task++) {
+      local += GamePerft(tasks[i].board, tasks[i].depth);
+    }
+    nodes += local;
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  PerftResult result;
+  result.nodes = nodes.load();
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
@@ -0,0 +1,140 @@
+#include "GamePerft.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// rows[0] is the top of GetTrueStateStr. 'w'/'W' white pawn/king,
+// 'b'/'B' black pawn/king, anything else is an empty square.
+GameBoard boardFromRows(const std::string rows[8], int player) {
+  GameBoard board;
+  ClearBoard(&board);
+  board.active = player;
+  board.passive = 1 - player;
+  board.forward.fill(0);
+  board.backward.fill(0);
+  board._remove_step_black = false;
+  board._remove_step_white = false;
+
+  // Same square numbering as GetObservation, every 9th bit is unused.
+  for (int i = 0; i < 35; i++) {
+    if (i % 9 == 8)
+      continue;
+    int buff = i - i / 9;
+    int x = 6 - buff % 4 * 2 + (buff / 4) % 2;
+    int y = 7 - buff / 4;
+    int64_t bit = int64_t(1) << i;
+    switch (rows[y][x]) {
+      case 'b': board.forward[BLACK_PLAYER] |= bit; break;
+      case 'B':
+        board.forward[BLACK_PLAYER] |= bit;
+        board.backward[BLACK_PLAYER] |= bit;
+        break;
+      case 'w': board.backward[WHITE_PLAYER] |= bit; break;
+      case 'W':
+        board.forward[WHITE_PLAYER] |= bit;
+        board.backward[WHITE_PLAYER] |= bit;
+        break;
+    }
+  }
+  for (int p = 0; p < TOTAL_PLAYERS; p++) {
+    board.pieces[p] = board.forward[p] | board.backward[p];
+  }
+  board.empty = UNUSED_BITS ^ MASK ^
+      (board.pieces[BLACK_PLAYER] | board.pieces[WHITE_PLAYER]);
+  return board;
+}
+
+void expectPerft(const GameBoard& board, const std::vector<uint64_t>& expected) {
+  for (size_t depth = 1; depth <= expected.size(); ++depth) {
+    EXPECT_EQ(expected[depth - 1], GamePerft(board, depth))
+        << "depth " << depth;
+  }
+}
+
+} // namespace
+
+// Depths 1-6 agree with the published checkers counts, deeper ones pin
+// the current generator (multi-jumps count one ply per jump).
+TEST(GamePerftTest, startPosition) {
+  GameBoard board;
+  ClearBoard(&board);
+  expectPerft(board, {7, 49, 302, 1469, 7361, 36768, 179258});
+}
+
+// The observation of the start position is the usual diagram.
+TEST(GamePerftTest, boardFromRows) {
+  const std::string rows[8] = {
+      ".w.w.w.w",
+      "w.w.w.w.",
+      ".w.w.w.w",
+      "........",
+      "........",
+      "b.b.b.b.",
+      ".b.b.b.b",
+      "b.b.b.b.",
+  };
+  GameBoard start;
+  ClearBoard(&start);
+  GameBoard board = boardFromRows(rows, BLACK_PLAYER);
+  EXPECT_EQ(GetTrueStateStr(start), GetTrueStateStr(board));
+  EXPECT_EQ(start.empty, board.empty);
+}
+
+// Capturing is mandatory, and a jump continues while it can.
+TEST(GamePerftTest, multiJump) {
+  const std::string rows[8] = {
+      ".......w",
+      "........",
+      "...w....",
+      "........",
+      ".w......",
+      "b.......",
+      "........",
+      "......b.",
+  };
+  GameBoard board = boardFromRows(rows, BLACK_PLAYER);
+  EXPECT_EQ(1u, GamePerft(board, 1));
+  expectPerft(board, {1, 1, 1, 4, 8, 30, 45});
+}
+
+// Kings move backwards, pawns do not.
+TEST(GamePerftTest, kings) {
+  const std::string rows[8] = {
+      "........",
+      "..w.....",
+      "........",
+      "........",
+      "...B....",
+      "........",
+      "........",
+      ".W......",
+  };
+  GameBoard board = boardFromRows(rows, BLACK_PLAYER);
+  EXPECT_EQ(4u, GamePerft(board, 1));
+  expectPerft(board, {4, 8, 23, 40, 126, 183, 438});
+}
+
+TEST(GamePerftTest, divideSumsToPerft) {
+  GameBoard board;
+  ClearBoard(&board);
+  uint64_t sum = 0;
+  for (const auto& p : GamePerftDivide(board, 5)) {
+    sum += p.second;
+  }
+  EXPECT_EQ(7361u, sum);
+}
+
+TEST(GamePerftTest, benchmarkThreads) {
+  GameBoard board;
+  ClearBoard(&board);
+  EXPECT_EQ(36768u, GamePerftBenchmark(board, 6, 1).nodes);
+  EXPECT_EQ(36768u, GamePerftBenchmark(board, 6, 4).nodes);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
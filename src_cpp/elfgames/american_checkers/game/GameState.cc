@@ -11,9 +11,7 @@ bool GameState::forward(const Coord& c) {
 
   CheckersPlay(&_board, c);
   _moves.push_back(c);
-  _history.emplace_back(_board);
-  if (_history.size() > MAX_CHECKERS_HISTORY)
-    _history.pop_front();
+  _history.push_back(_board);
   return true;
 }
 
@@ -25,7 +23,7 @@ void GameState::reset() {
   ClearBoard(&_board);
   _moves.clear();
   _history.clear();
-  _history.emplace_back(_board);
+  _history.push_back(_board);
   _final_value = 0.0;
 }
 
@@ -1,11 +1,15 @@
 #pragma once
 
+// elf
+#include "elf/utils/ring_buffer.h"
 // game
 #include "GameBoard.h"
 #include "BoardFeature.h"
 
 class GameState {
  public:
+  // Last MAX_CHECKERS_HISTORY boards, current one included.
+  using History = elf_utils::RingBuffer<GameBoardHistory, MAX_CHECKERS_HISTORY>;
 
   GameState(int id)
       : _game_idx(id) {
@@ -78,7 +82,7 @@ class GameState {
     return _game_idx;
   }
 
-  const std::deque<GameBoard>& getHistory() const {
+  const History& getHistory() const {
     return _history;
   }
 
@@ -92,7 +96,7 @@ class GameState {
   int _game_idx;
 
   // History of states
-  std::deque<GameBoard> _history;
+  History _history;
   // history of moves for current board
   std::vector<Coord> _moves;
 
@@ -99,6 +99,10 @@ void GameStateExt::showFinishInfo() const {
     _logger->info(
       "Ply: {} exceeds thread_state. Restarting the game(Draw++)", 
       _state.getPly());
+  } else if (!_state.terminated()) {
+    _logger->info("{} won by the tablebase at {} move",
+      _state.getFinalValue() > 0 ? "Black" : "White",
+      _state.getPly());
   } else if (_state.currentPlayer() == WHITE_PLAYER) {
     _logger->info("{}Black{} win at {} move", 
       GREEN_C, 
@@ -136,3 +140,7 @@ void GameStateExt::setFinalValue() {
   _state.setFinalValue(final_value);
 }
 
+void GameStateExt::setFinalValue(float final_value) {
+  _state.setFinalValue(final_value);
+}
+
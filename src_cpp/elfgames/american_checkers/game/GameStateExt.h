@@ -9,6 +9,7 @@
 #include "GameState.h"
 #include "BoardFeature.h"
 #include "GameOptions.h"
+#include "GameSymmetry.h"
 #include "../common/record.h"
 #include "../sgf/sgf.h"
 #include "Record.h"
@@ -42,6 +43,8 @@ struct GameStateExt {
   const GameOptions& gameOptions() const;
   void saveCurrentTree(const std::string& tree_info) const;
   void setFinalValue();
+  // Result of a game stopped before its end, for black.
+  void setFinalValue(float final_value);
 
   // packing the result of the game in json for sending to the server
   GameRecord dumpRecord() const {
@@ -58,6 +61,7 @@ struct GameStateExt {
         std::vector<int64_t>(_using_models.begin(), _using_models.end());
     r.result.policies = _mcts_policies;
     r.result.num_move = _state.getPly() - 1;
+    r.result.draw = _state.getPly() >= TOTAL_MAX_MOVE;
     r.result.values = _predicted_values;
 
     // std::cout << "GoStateExtOffline::dumpRecord" << std::endl;
@@ -150,6 +154,7 @@ class GameStateExtOffline {
     _curr_request = r.request;
     _seq = r.seq;
     _predicted_values = r.result.values;
+    _aug_code = CHECKERS_AUG_IDENTITY;
     _state.reset();
 
     // std::cout << "GoStateExtOffline::fromRecord" << std::endl;
@@ -198,6 +203,15 @@ class GameStateExtOffline {
     return _predicted_values[move_idx];
   }
 
+  // The sample is sent through the symmetry aug_code, see GameSymmetry.h.
+  void setAugCode(int aug_code) {
+    _aug_code = aug_code;
+  }
+
+  int getAugCode() const {
+    return _aug_code;
+  }
+
  private:
   const int _game_idx;
   GameState _state;
@@ -209,6 +223,7 @@ class GameStateExtOffline {
 
   std::vector<Coord> _offline_all_moves;
   float _offline_winner;
+  int _aug_code = CHECKERS_AUG_IDENTITY;
 
   std::vector<GameCoordRecord> _mcts_policies;
   std::vector<float> _predicted_values;
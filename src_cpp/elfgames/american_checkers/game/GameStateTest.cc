@@ -0,0 +1,113 @@
+#include "GameState.h"
+
+#include <deque>
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const int kRegion = CHECKERS_BOARD_SIZE * CHECKERS_BOARD_SIZE;
+
+// Cells where GetObservation(board, player) is piece, as 0/1 floats.
+void observationPlane(
+    const GameBoard& board,
+    int player,
+    int piece,
+    float* data) {
+  auto observation = GetObservation(board, player);
+  for (int y = 0; y < CHECKERS_BOARD_SIZE; ++y) {
+    for (int x = 0; x < CHECKERS_BOARD_SIZE; ++x) {
+      data[y * CHECKERS_BOARD_SIZE + x] = observation[y][x] == piece ? 1 : 0;
+    }
+  }
+}
+
+// Features of the boards, oldest first and aligned to the end.
+std::vector<float> expectedFeatures(const std::deque<GameBoard>& boards) {
+  std::vector<float> features(CHECKERS_NUM_FEATURES * kRegion, 0.0);
+  size_t first = MAX_CHECKERS_HISTORY - boards.size();
+  for (size_t k = 0; k < boards.size(); ++k) {
+    const GameBoard& board = boards[k];
+    float* planes = &features[6 * (first + k) * kRegion];
+    observationPlane(board, board.active, 1, planes);
+    observationPlane(board, board.active, 3, planes + kRegion);
+    observationPlane(board, board.passive, 1, planes + 2 * kRegion);
+    observationPlane(board, board.passive, 3, planes + 3 * kRegion);
+    int indicator = board.active == BLACK_PLAYER ? 4 : 5;
+    std::fill_n(planes + indicator * kRegion, kRegion, 1.0);
+  }
+  return features;
+}
+
+Coord randomMove(const GameBoard& board, std::mt19937* rng) {
+  auto valid = GetValidMovesBinary(board);
+  std::vector<Coord> legal;
+  for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+    if (valid[c])
+      legal.push_back(c);
+  }
+  return legal.empty() ? M_INVALID : legal[(*rng)() % legal.size()];
+}
+
+} // namespace
+
+// History planes hold the last MAX_CHECKERS_HISTORY boards, copies
+// included.
+TEST(GameStateTest, historyFeatures) {
+  std::mt19937 rng(0);
+  for (int game = 0; game < 20; ++game) {
+    GameState state(game);
+    std::deque<GameBoard> boards = {state.board()};
+
+    while (!state.terminated()) {
+      // Stale values in the slot must be overwritten.
+      std::vector<float> features(CHECKERS_NUM_FEATURES * kRegion, -1.0);
+      GameState copy = state;
+      BoardFeature(copy).extract(features.data());
+      ASSERT_EQ(expectedFeatures(boards), features);
+
+      Coord c = randomMove(state.board(), &rng);
+      ASSERT_NE(M_INVALID, c);
+      ASSERT_TRUE(state.forward(c));
+      boards.push_back(state.board());
+      if (boards.size() > MAX_CHECKERS_HISTORY)
+        boards.pop_front();
+    }
+
+    state.reset();
+    ASSERT_EQ(1u, state.getHistory().size());
+  }
+}
+
+// Batched legal moves are GetValidMovesBinary() of every board.
+TEST(GameStateTest, legalMasks) {
+  std::mt19937 rng(1);
+  std::vector<GameBoard> boards;
+  while (boards.size() < 1003) {
+    GameBoard board;
+    ClearBoard(&board);
+    while (boards.size() < 1003 && board._ply < TOTAL_MAX_MOVE) {
+      boards.push_back(board);
+      Coord c = randomMove(board, &rng);
+      if (c == M_INVALID)
+        break;
+      CheckersPlay(&board, c);
+    }
+  }
+
+  std::vector<uint8_t> masks(boards.size() * TOTAL_NUM_ACTIONS, 2);
+  GenerateLegalMasks(boards.data(), boards.size(), masks.data());
+  for (size_t i = 0; i < boards.size(); ++i) {
+    auto valid = GetValidMovesBinary(boards[i]);
+    std::vector<uint8_t> expected(valid.begin(), valid.end());
+    const uint8_t* m = &masks[i * TOTAL_NUM_ACTIONS];
+    ASSERT_EQ(expected, std::vector<uint8_t>(m, m + TOTAL_NUM_ACTIONS))
+        << GetTrueStateStr(boards[i]);
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,78 @@
+#include "GameSymmetry.h"
+
+#include <map>
+
+namespace {
+
+// Action of every move turned by 180 degrees.
+struct FlipTable {
+  Coord action[TOTAL_NUM_ACTIONS];
+
+  FlipTable() {
+    // Bit of the masks turned by 180 degrees, through the board squares
+    // of GetObservation().
+    int square_bit[64];
+    int flipped_bit[35];
+    for (int i = 0; i < 35; i++) {
+      int buff = i - i / 9;
+      int x = 6 - buff % 4 * 2 + buff / 4 % 2;
+      int y = 7 - buff / 4;
+      if (i % 9 != 8)
+        square_bit[y * 8 + x] = i;
+    }
+    for (int i = 0; i < 35; i++) {
+      int buff = i - i / 9;
+      int x = 6 - buff % 4 * 2 + buff / 4 % 2;
+      int y = 7 - buff / 4;
+      flipped_bit[i] = i % 9 != 8 ? square_bit[(7 - y) * 8 + 7 - x] : i;
+    }
+
+    // A move is its two bits (negative for jumps), the piece starts on
+    // the low one if it goes forward.
+    std::map<std::pair<int64_t, bool>, Coord> index;
+    for (const auto& a : moves::i_to_m) {
+      index[{a.second[0], a.second[1] != 0}] = a.first;
+    }
+    for (const auto& a : moves::i_to_m) {
+      int64_t m = a.second[0];
+      uint64_t bits = static_cast<uint64_t>(m < 0 ? -m : m);
+      int lo = __builtin_ctzll(bits);
+      int hi = 63 - __builtin_clzll(bits);
+      int from = a.second[1] ? lo : hi;
+      int to = a.second[1] ? hi : lo;
+
+      int new_from = flipped_bit[from];
+      int new_to = flipped_bit[to];
+      int64_t move = (int64_t(1) << new_from) | (int64_t(1) << new_to);
+      action[a.first] =
+          index.at({m < 0 ? -move : move, new_from < new_to});
+    }
+  }
+};
+
+const FlipTable& flipTable() {
+  static const FlipTable table;
+  return table;
+}
+
+} // namespace
+
+
+Coord CheckersAugmentAction(Coord action, int aug_code) {
+  if (aug_code != CHECKERS_AUG_FLIP_COLORS || action >= TOTAL_NUM_ACTIONS)
+    return action;
+  return flipTable().action[action];
+}
+
+
+bool CheckersCanFlipColors(int num_move) {
+  // Ply starts from 1.
+  return num_move + 1 < TOTAL_MAX_MOVE;
+}
+
+
+int CheckersRandomAugCode(int num_move, std::mt19937* rng) {
+  if (!CheckersCanFlipColors(num_move))
+    return CHECKERS_AUG_IDENTITY;
+  return (*rng)() % CHECKERS_NUM_AUG_CODES;
+}
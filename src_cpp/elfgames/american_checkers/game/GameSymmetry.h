@@ -0,0 +1,31 @@
+#pragma once
+
+#include <random>
+
+#include "GameBoard.h"
+
+/*
+  Symmetries used to augment training samples, recorded in
+  checkers_aug_code.
+
+  Mirrors do not apply: they move pieces to light squares or turn the
+  direction pawns move. What remains is the colour flip: the board is
+  turned by 180 degrees and the colours are swapped, so the other side
+  is to move in the same game. The piece planes of BoardFeature do not
+  change under it (GetObservation() already turns the board for white);
+  the side-to-move planes, the actions and the result do.
+*/
+
+#define CHECKERS_AUG_IDENTITY     0
+#define CHECKERS_AUG_FLIP_COLORS  1
+#define CHECKERS_NUM_AUG_CODES    2
+
+// Action of the augmented position.
+Coord CheckersAugmentAction(Coord action, int aug_code);
+
+// The colour flip keeps the result of decided games only: games which
+// reach TOTAL_MAX_MOVE are scored as white wins.
+bool  CheckersCanFlipColors(int num_move);
+
+// Random code among the ones valid for a game of num_move moves.
+int   CheckersRandomAugCode(int num_move, std::mt19937* rng);
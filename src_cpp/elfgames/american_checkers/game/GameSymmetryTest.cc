@@ -0,0 +1,104 @@
+#include "GameSymmetry.h"
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Mask turned by 180 degrees, through the squares of GetTrueState().
+int64_t flipMask(int64_t mask) {
+  int64_t res = 0;
+  for (int i = 0; i < 35; i++) {
+    if (i % 9 == 8 || !((mask >> i) & 1))
+      continue;
+    int buff = i - i / 9;
+    int x = 6 - buff % 4 * 2 + buff / 4 % 2;
+    int y = 7 - buff / 4;
+    // Find the bit of the turned square.
+    for (int j = 0; j < 35; j++) {
+      int b = j - j / 9;
+      if (j % 9 != 8 && 6 - b % 4 * 2 + b / 4 % 2 == 7 - x && 7 - b / 4 == 7 - y)
+        res |= int64_t(1) << j;
+    }
+  }
+  return res;
+}
+
+int64_t flipAction(int64_t action) {
+  if (action < 0 || action >= (int64_t)TOTAL_NUM_ACTIONS)
+    return action;
+  return CheckersAugmentAction(action, CHECKERS_AUG_FLIP_COLORS);
+}
+
+// The board turned by 180 degrees with the colours swapped. Black
+// pieces are all in forward, black kings also in backward; white the
+// other way around.
+GameBoard flipColors(const GameBoard& board) {
+  GameBoard res = board;
+  for (int c = 0; c < 2; c++) {
+    res.forward[c] = flipMask(board.backward[1 - c]);
+    res.backward[c] = flipMask(board.forward[1 - c]);
+    res.pieces[c] = flipMask(board.pieces[1 - c]);
+  }
+  res.empty = UNUSED_BITS ^ MASK ^ (res.pieces[0] | res.pieces[1]);
+  res.active = board.passive;
+  res.passive = board.active;
+  res._last_move = flipAction(board._last_move);
+
+  for (int k = 0; k < 2; k++) {
+    res._last_move_black[k] = flipAction(board._last_move_white[k]);
+    res._last_move_white[k] = flipAction(board._last_move_black[k]);
+  }
+  res._remove_step_black = board._remove_step_white;
+  res._remove_step_white = board._remove_step_black;
+  res._black_repeats_step = board._white_repeats_step;
+  res._white_repeats_step = board._black_repeats_step;
+  return res;
+}
+
+} // namespace
+
+// Legal actions and feature planes agree with the flipped board.
+TEST(GameSymmetryTest, flipColors) {
+  std::mt19937 rng(0);
+  for (int game = 0; game < 20; ++game) {
+    GameBoard board;
+    ClearBoard(&board);
+
+    while (board._ply < TOTAL_MAX_MOVE) {
+      GameBoard flipped = flipColors(board);
+      auto valid = GetValidMovesBinary(board);
+      auto flipped_valid = GetValidMovesBinary(flipped);
+      std::vector<Coord> legal;
+      for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+        Coord f = CheckersAugmentAction(c, CHECKERS_AUG_FLIP_COLORS);
+        ASSERT_EQ(c, CheckersAugmentAction(f, CHECKERS_AUG_FLIP_COLORS));
+        ASSERT_EQ(valid[c], flipped_valid[f]) << "action " << c;
+        if (valid[c])
+          legal.push_back(c);
+      }
+      ASSERT_EQ(GetObservationMasks(board), GetObservationMasks(flipped));
+
+      if (legal.empty())
+        break;
+      CheckersPlay(&board, legal[rng() % legal.size()]);
+    }
+  }
+}
+
+TEST(GameSymmetryTest, randomAugCode) {
+  std::mt19937 rng(1);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(
+        CHECKERS_AUG_IDENTITY,
+        CheckersRandomAugCode(TOTAL_MAX_MOVE - 1, &rng));
+    int code = CheckersRandomAugCode(40, &rng);
+    EXPECT_TRUE(code >= 0 && code < CHECKERS_NUM_AUG_CODES);
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// elf
+#include "elf/logging/IndexedLoggerFactory.h"
+// checkers
+#include "GameBoard.h"
+
+/*
+  Win/draw/loss endgame tablebase for positions with few pieces.
+
+  There is one table per material (number of pawns and kings of each
+  side), holding 2 bits per position with black to move; positions with
+  white to move are looked up turned by 180 degrees with the colours
+  swapped. Pieces are indexed by square of the GameBoard masks, without
+  the unused bits.
+
+  Values are those of a game without move limit nor repetition limit
+  (REPEAT_MOVE), "draw" meaning neither side can force a win. Every table also keeps the number of plies in
+  which its decided positions are won, so a caller can tell whether the
+  win comes before TOTAL_MAX_MOVE.
+
+  The file is memory-mapped read-only, so it is shared by every game
+  thread and process using it. It is built with GenerateTablebase.
+*/
+
+// Result for the player to move.
+#define CHECKERS_WDL_UNKNOWN  0
+#define CHECKERS_WDL_LOSS     1
+#define CHECKERS_WDL_DRAW     2
+#define CHECKERS_WDL_WIN      3
+
+struct GameTablebaseResult {
+  int wdl = CHECKERS_WDL_UNKNOWN;
+  // Decided positions of the table end within max_plies plies.
+  int max_plies = 0;
+};
+
+class GameTablebase {
+ public:
+  // Entry of the file per material, followed by the 2-bit values.
+  struct Table {
+    uint32_t material;
+    uint32_t max_plies;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  GameTablebase();
+  ~GameTablebase();
+
+  GameTablebase(const GameTablebase&) = delete;
+  GameTablebase& operator=(const GameTablebase&) = delete;
+
+  // Map a file written by generate(). Return false if it cannot be used.
+  bool load(const std::string& path);
+
+  bool loaded() const {
+    return data_ != nullptr;
+  }
+
+  int maxPieces() const {
+    return max_pieces_;
+  }
+
+  // Return false if the position is not in the tablebase: too many
+  // pieces, or a jump in progress.
+  bool probe(const GameBoard& board, GameTablebaseResult* res)
+      const;
+
+  // Value for black, as GameState::evaluateGame() scores the end of
+  // the game. Draws reach TOTAL_MAX_MOVE, which is scored for white; a
+  // black win is only known if the table ends it before.
+  bool probeValue(const GameBoard& board, float* value) const;
+
+  // Solve every material of at most max_pieces pieces and write them to
+  // path. Each extra piece multiplies the time and size by about 25: 4
+  // pieces take 1.6 MB and a few CPU minutes, 5 pieces 38 MB.
+  static bool generate(
+      const std::string& path,
+      int max_pieces,
+      int num_threads);
+
+ private:
+  void* data_ = nullptr;
+  size_t bytes_ = 0;
+  int max_pieces_ = 0;
+  // Table index of each material, -1 if none.
+  std::vector<int> table_of_;
+  std::vector<Table> tables_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  void unload();
+};
@@ -0,0 +1,155 @@
+#include "GameTablebase.h"
+
+#include <unistd.h>
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const int kMaxPieces = 3;
+
+class GameTablebaseTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    path_ = "/tmp/american_tablebase_test_" + std::to_string(getpid());
+    ASSERT_TRUE(GameTablebase::generate(path_, kMaxPieces, 4));
+  }
+
+  static void TearDownTestCase() {
+    unlink(path_.c_str());
+  }
+
+  static std::string path_;
+};
+
+std::string GameTablebaseTest::path_;
+
+// Random position of at most kMaxPieces pieces, no jump in progress.
+GameBoard randomPosition(std::mt19937* rng) {
+  GameBoard board;
+  ClearBoard(&board);
+  for (int c = 0; c < 2; ++c) {
+    board.forward[c] = 0;
+    board.backward[c] = 0;
+    board.pieces[c] = 0;
+  }
+
+  int n = 2 + (*rng)() % (kMaxPieces - 1);
+  for (int i = 0; i < n; ++i) {
+    // One piece of each side, then random ones.
+    int color = i < 2 ? i : (*rng)() % 2;
+    bool king = (*rng)() % 2;
+    int square;
+    int64_t bit;
+    do {
+      square = (*rng)() % 32;
+      bit = int64_t(1) << (square + square / 8);
+    } while (((board.pieces[0] | board.pieces[1]) & bit) ||
+             (!king && (color == BLACK_PLAYER ? square >= 28 : square < 4)));
+    board.pieces[color] |= bit;
+    // Black pieces move forward, white ones backward, kings both ways.
+    if (color == BLACK_PLAYER || king)
+      board.forward[color] |= bit;
+    if (color == WHITE_PLAYER || king)
+      board.backward[color] |= bit;
+  }
+  board.empty = UNUSED_BITS ^ MASK ^
+      (board.pieces[BLACK_PLAYER] | board.pieces[WHITE_PLAYER]);
+  board.active = (*rng)() % 2 ? BLACK_PLAYER : WHITE_PLAYER;
+  board.passive = 1 - board.active;
+  return board;
+}
+
+// Results reached by every move of the player, following jumps.
+void childResults(
+    const GameTablebase& tb,
+    const GameBoard& board,
+    std::vector<int>* results) {
+  MoveList moves;
+  _get_moves(board, board.active, &moves);
+  for (int i = 0; i < moves.size; ++i) {
+    GameBoard child = board;
+    CheckersPlay(&child, moves.actions[i]);
+    if (child.active == board.active) {
+      childResults(tb, child, results);
+      continue;
+    }
+
+    if (child.pieces[child.active] == 0) {
+      results->push_back(CHECKERS_WDL_LOSS);
+      continue;
+    }
+    GameTablebaseResult res;
+    ASSERT_TRUE(tb.probe(child, &res));
+    results->push_back(res.wdl);
+  }
+}
+
+} // namespace
+
+// Every result follows from the results after each move.
+TEST_F(GameTablebaseTest, consistent) {
+  GameTablebase tb;
+  ASSERT_TRUE(tb.load(path_));
+  EXPECT_EQ(kMaxPieces, tb.maxPieces());
+
+  std::mt19937 rng(0);
+  int count[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 3000; ++i) {
+    GameBoard board = randomPosition(&rng);
+
+    GameTablebaseResult res;
+    ASSERT_TRUE(tb.probe(board, &res));
+    count[res.wdl]++;
+
+    std::vector<int> results;
+    childResults(tb, board, &results);
+    int expected;
+    if (results.empty() ||
+        std::all_of(results.begin(), results.end(), [](int r) {
+          return r == CHECKERS_WDL_WIN;
+        })) {
+      expected = CHECKERS_WDL_LOSS;
+    } else if (std::count(results.begin(), results.end(), CHECKERS_WDL_LOSS)) {
+      expected = CHECKERS_WDL_WIN;
+    } else {
+      expected = CHECKERS_WDL_DRAW;
+    }
+    ASSERT_EQ(expected, res.wdl) << GetTrueStateStr(board);
+    if (res.wdl != CHECKERS_WDL_DRAW) {
+      EXPECT_GT(res.max_plies, 0);
+    }
+  }
+  EXPECT_GT(count[CHECKERS_WDL_WIN], 0);
+  EXPECT_GT(count[CHECKERS_WDL_DRAW], 0);
+  EXPECT_GT(count[CHECKERS_WDL_LOSS], 0);
+}
+
+TEST_F(GameTablebaseTest, outOfTable) {
+  GameTablebase tb;
+  GameTablebaseResult res;
+
+  GameBoard board;
+  ClearBoard(&board);
+  EXPECT_FALSE(tb.probe(board, &res));
+
+  ASSERT_TRUE(tb.load(path_));
+  // Too many pieces.
+  EXPECT_FALSE(tb.probe(board, &res));
+
+  // A jump in progress.
+  std::mt19937 rng(1);
+  board = randomPosition(&rng);
+  board.jump = 1;
+  EXPECT_FALSE(tb.probe(board, &res));
+
+  EXPECT_FALSE(tb.load(path_ + ".missing"));
+  EXPECT_FALSE(tb.loaded());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
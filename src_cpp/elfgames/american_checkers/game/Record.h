@@ -45,6 +45,7 @@ struct GameMsgResult {
   void setJsonFields(json& j) const {
     JSON_SAVE(j, num_move);
     JSON_SAVE(j, reward);
+    JSON_SAVE(j, draw);
     JSON_SAVE(j, using_models);
     JSON_SAVE(j, content);
 
@@ -63,6 +64,7 @@ struct GameMsgResult {
 
     JSON_LOAD(res, j, num_move);
     JSON_LOAD(res, j, reward);
+    JSON_LOAD_OPTIONAL(res, j, draw);
     JSON_LOAD(res, j, content);
     JSON_LOAD_VEC_OPTIONAL(res, j, using_models);
     JSON_LOAD_VEC(res, j, values);
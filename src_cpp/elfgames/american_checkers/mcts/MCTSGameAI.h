@@ -60,6 +60,8 @@ class MCTSGameAI : public elf::ai::tree_search::MCTSAI_T<MCTSGameActor> {
 		auto* engine = getEngine();
 		assert(engine != nullptr);
 
+		// The actors may be in use by pondering.
+		engine->stopPondering();
 		for (size_t i = 0; i < engine->getNumActors(); ++i) {
 			engine->getActor(i).setRequiredVersion(ver);
 		}
@@ -15,6 +15,7 @@
 #include "elf/logging/IndexedLoggerFactory.h"
 // game
 #include "AI.h"
+#include "../game/GameTablebase.h"
 
 struct MCTSActorParams {
 	// "actor_black", "actor_white"
@@ -25,6 +26,8 @@ struct MCTSActorParams {
 	// If -1, then there is no requirement on model version (any model response
 	// can be used).
 	int64_t				required_version = -1;
+	// Exact values of endgames, not owned.
+	const GameTablebase* tablebase = nullptr;
 
 	std::string info() const {
 		std::stringstream ss;
@@ -212,9 +215,24 @@ class MCTSGameActor {
 			// No further action.
 			resp->pi.clear();
 			return EVAL_DONE;
-		} else {
-			return EVAL_NEED_NN;
 		}
+
+		float tablebase_value;
+		if (params_.tablebase != nullptr &&
+				params_.tablebase->probeValue(s.board(), &tablebase_value)) {
+			resp->value = tablebase_value;
+			// Keep the moves so that the search can still pick one, their
+			// positions are in the tablebase as well.
+			std::array<int, TOTAL_NUM_ACTIONS> valid = GetValidMovesBinary(s.board());
+			resp->pi.clear();
+			for (size_t i = 0; i < valid.size(); ++i) {
+				if (valid[i])
+					resp->pi.push_back(std::make_pair(Coord(i), 1.0f));
+			}
+			normalize(&resp->pi);
+			return EVAL_DONE;
+		}
+		return EVAL_NEED_NN;
 	}
 
 	
@@ -25,7 +25,8 @@ void registerPy(pybind11::module& m) {
       .def("getParams", &GameContext::getParams)
       .def("getGame", &GameContext::getGame, ref)
       .def("getClient", &GameContext::getClient, ref)
-      .def("getServer", &GameContext::getServer, ref);
+      .def("getServer", &GameContext::getServer, ref)
+      .def("getArena", &GameContext::getArena, ref);
 
 
   py::class_<DistriServer>(m, "DistriServer")
@@ -35,6 +36,13 @@ void registerPy(pybind11::module& m) {
       .def("setEvalMode", &DistriServer::setEvalMode);
 
 
+  py::class_<LocalArena>(m, "LocalArena")
+      .def("setModels", &LocalArena::setModels)
+      .def("finished", &LocalArena::finished)
+      .def("passed", &LocalArena::passed)
+      .def("info", &LocalArena::info);
+
+
   py::class_<DistriClient>(m, "DistriClient")
       .def("setRequest", &DistriClient::setRequest)
       .def("getGameStats", &DistriClient::getGameStats, ref);
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/*
+  Builds the endgame tablebase probed by the MCTS actors:
+
+    generate_tablebase --output FILE [--max_pieces N] [--threads N]
+
+  Use it with --tablebase_path FILE.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../game/GameTablebase.h"
+
+static void usage(const char* prog) {
+  std::cerr << "Usage: " << prog
+            << " --output FILE [--max_pieces N] [--threads N]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::string output;
+  int max_pieces = 4;
+  int num_threads = 16;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (arg == "--output" && has_value) {
+      output = argv[++i];
+    } else if (arg == "--max_pieces" && has_value) {
+      max_pieces = std::atoi(argv[++i]);
+    } else if (arg == "--threads" && has_value) {
+      num_threads = std::atoi(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (output.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  return GameTablebase::generate(output, max_pieces, num_threads) ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/*
+  Legal move masks throughput, batched against one board at a time:
+
+    legal_masks_bench [--positions N] [--seconds S]
+
+  Positions come from random games. Prints boards/sec of
+  GetValidMovesBinary() and GenerateLegalMasks() for several batch sizes.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../game/GameBoard.h"
+
+namespace {
+
+std::vector<GameBoard> randomPositions(size_t n) {
+  std::mt19937 rng(0);
+  std::vector<GameBoard> boards;
+  while (boards.size() < n) {
+    GameBoard board;
+    ClearBoard(&board);
+    while (boards.size() < n && board._ply < TOTAL_MAX_MOVE) {
+      boards.push_back(board);
+      MoveList moves;
+      _get_moves(board, board.active, &moves);
+      if (moves.size == 0)
+        break;
+      CheckersPlay(&board, moves.actions[rng() % moves.size]);
+    }
+  }
+  return boards;
+}
+
+// Boards/sec of f(first, count, masks) over batches of batch_size.
+template <typename F>
+double boardsPerSecond(
+    const std::vector<GameBoard>& boards,
+    size_t batch_size,
+    double seconds,
+    F f) {
+  using clock = std::chrono::steady_clock;
+  std::vector<uint8_t> masks(batch_size * TOTAL_NUM_ACTIONS);
+  uint64_t done = 0;
+  auto start = clock::now();
+  std::chrono::duration<double> elapsed(0);
+  while (elapsed.count() < seconds) {
+    for (size_t i = 0; i + batch_size <= boards.size(); i += batch_size) {
+      f(&boards[i], batch_size, masks.data());
+      done += batch_size;
+    }
+    elapsed = clock::now() - start;
+  }
+  return done / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t num_positions = 1 << 16;
+  double seconds = 1.0;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--positions" && i + 1 < argc) {
+      num_positions = std::atoi(argv[++i]);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      seconds = std::atof(argv[++i]);
+    } else {
+      std::fprintf(
+          stderr, "Usage: %s [--positions N] [--seconds S]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<GameBoard> boards = randomPositions(num_positions);
+
+  auto per_board = [](const GameBoard* b, size_t n, uint8_t* masks) {
+    for (size_t i = 0; i < n; ++i) {
+      auto valid = GetValidMovesBinary(b[i]);
+      for (size_t a = 0; a < TOTAL_NUM_ACTIONS; ++a) {
+        masks[i * TOTAL_NUM_ACTIONS + a] = valid[a];
+      }
+    }
+  };
+
+  std::printf("%6s %14s %14s\n", "batch", "per board", "batched");
+  for (size_t batch_size : {8, 64, 1024}) {
+    std::printf(
+        "%6zu %14.0f %14.0f\n",
+        batch_size,
+        boardsPerSecond(boards, batch_size, seconds, per_board),
+        boardsPerSecond(boards, batch_size, seconds, GenerateLegalMasks));
+  }
+  return 0;
+}
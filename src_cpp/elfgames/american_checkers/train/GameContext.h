@@ -23,6 +23,7 @@
 #include "../common/record.h"
 #include "../mcts/AI.h"
 #include "data_loader.h"
+#include "LocalArena.h"
 #include "server/DistriServer.h"
 #include "server/ServerGameTrain.h"
 
@@ -33,6 +34,7 @@
 		GameBase - vector of games. The number of which is set by parameter --num_games.
 		DistriServer - .
 		DistriClient - .
+		LocalArena - evaluation games of the arena mode, instead of DistriClient.
 
 		GameFeature - Registers the keys by which Python will access memory in C++ 
 			as well as the methods that will be called while accessing these keys.
@@ -106,9 +108,23 @@ class GameContext {
 			logger_->info("{} ServerGameTrain was created", numGames);
 		} else {
 			// if mode is "selfplay" or "online", set ``eval control`` and ``writer``
+			// if mode is "arena", games come from ``arena`` and report to it.
+			GameNotifierBase* notifier = nullptr;
+			if (gameOptions.mode == "arena") {
+				arena_.reset(new LocalArena(contextOptions, gameOptions, gameClient));
+				notifier = arena_.get();
+			} else {
+				client_.reset(new DistriClient(contextOptions, gameOptions, gameClient));
+				dispatcher = client_->getDispatcher();
+				notifier = client_->getGameNotifier();
+			}
 
-			client_.reset(new DistriClient(contextOptions, gameOptions, gameClient));
-			dispatcher = client_->getDispatcher();
+			// Shared by all games, read-only.
+			if (!gameOptions.tablebase_path.empty()) {
+				tablebase_.reset(new GameTablebase());
+				if (!tablebase_->load(gameOptions.tablebase_path))
+					tablebase_.reset();
+			}
 
 			//  Push into the vector _games of size num_game Train or Selfplay;
 			for (int i = 0; i < numGames; ++i) {
@@ -118,7 +134,9 @@ class GameContext {
 						contextOptions,
 						gameOptions,
 						dispatcher,
-						client_->getGameNotifier()));
+						notifier,
+						tablebase_.get(),
+						arena_.get()));
 			}
 			logger_->info("{} ClientGameSelfPlay was created", numGames);
 		}
@@ -169,10 +187,15 @@ class GameContext {
 		return client_.get();
 	}
 
+	LocalArena*	getArena() {
+		return arena_.get();
+	}
+
 	~GameContext() {
 		server_.reset(nullptr);
 		client_.reset(nullptr);
 		games_.clear();
+		arena_.reset(nullptr);
 		context_.reset(nullptr);
 	}
 
@@ -187,6 +210,8 @@ class GameContext {
 
 	std::unique_ptr<DistriServer> server_;
 	std::unique_ptr<DistriClient> client_;
+	std::unique_ptr<LocalArena> arena_;
+	std::unique_ptr<GameTablebase> tablebase_;
 
 	GameFeature gameFeature_;
 
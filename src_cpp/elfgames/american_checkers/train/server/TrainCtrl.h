@@ -8,7 +8,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -308,8 +310,23 @@ class TrainCtrl : public DataInterface {
     rq_ctrl.num_reader = gameOptions.num_reader;
     rq_ctrl.ctrl.queue_min_size = gameOptions.q_min_size;
     rq_ctrl.ctrl.queue_max_size = gameOptions.q_max_size;
+    rq_ctrl.ctrl.prioritized = gameOptions.replay_prioritized;
+    rq_ctrl.ctrl.recency_half_life = gameOptions.replay_recency_half_life;
+    rq_ctrl.ctrl.version_half_life = gameOptions.replay_version_half_life;
 
     replay_buffer_.reset(new ReplayBuffer(rq_ctrl));
+    if (gameOptions.replay_prioritized) {
+      bool by_length = gameOptions.replay_weight_by_length;
+      replay_buffer_->setWeightFunction(
+          [by_length](const GameRecord& r) -> float {
+            float w = r.pri > 0 ? r.pri : 1.0;
+            if (by_length)
+              w *= r.result.num_move;
+            return w;
+          });
+      replay_buffer_->setVersionFunction(
+          [](const GameRecord& r) -> int64_t { return r.request.vers.black_ver; });
+    }
     logger_->info(
         "Finished initializing replay_buffer(ReplayBuffer). info :\n{}", replay_buffer_->info());
     
@@ -15,10 +15,14 @@ ClientGameSelfPlay::ClientGameSelfPlay(
     const ContextOptions& context_options,
     const CheckersGameOptions& game_options,
     ThreadedDispatcher* dispatcher,
-    CheckersGameNotifierBase* checkers_notifier)
+    CheckersGameNotifierBase* checkers_notifier,
+    const CheckersTablebase* tablebase,
+    CheckersGameRequesterBase* arena)
     : GameBase(game_idx, client, context_options, game_options),
       dispatcher_(dispatcher),
       checkers_notifier_(checkers_notifier),
+      tablebase_(tablebase),
+      arena_(arena),
       _checkers_state_ext(game_idx, game_options),
       logger_(elf::logging::getIndexedLogger(
           MAGENTA_B + std::string("|++|") + COLOR_END + 
@@ -58,6 +62,7 @@ MCTSCheckersAI* ClientGameSelfPlay::init_checkers_ai(
   params.actor_name = actor_name;
   params.seed = _rng();
   params.required_version = model_ver;
+  params.tablebase = tablebase_;
 
   elf::ai::tree_search::TSOptions mcts_opt = mcts_options;
   // My
@@ -83,12 +88,25 @@ MCTSCheckersAI* ClientGameSelfPlay::init_checkers_ai(
     mcts_opt.num_rollouts_per_thread = mcts_rollout_per_thread_override;
   }
 
+  // Pondering is up to this client, whatever the request says. In selfplay
+  // of one model the same ai plays both colours on one tree, so there is
+  // no opponent's turn to ponder on.
+  mcts_opt.ponder_rollouts_per_thread =
+      (_game_options.mode == "play" || !_checkers_state_ext.currRequest().vers.is_selfplay())
+      ? _context_options.mcts_options.ponder_rollouts_per_thread
+      : 0;
+
   if (mcts_opt.verbose) {
     mcts_opt.log_prefix = "ts-game" + std::to_string(_game_idx) + "-mcts";
     logger_->warn("Log prefix {}", mcts_opt.log_prefix);
   }
 
-  return new MCTSCheckersAI(mcts_opt, [&](int) { return new CheckersMCTSActor(client_, params); });
+  // The threads of each tree (see TSOptions::num_trees) get their own seed.
+  return new MCTSCheckersAI(mcts_opt, [&](int i) {
+    MCTSActorParams tree_params = params;
+    tree_params.seed += i % std::max(1, mcts_opt.num_trees);
+    return new CheckersMCTSActor(client_, tree_params);
+  });
 }
 
 Coord ClientGameSelfPlay::mcts_make_diverse_move(MCTSCheckersAI* mcts_checkers_ai, Coord c) {
@@ -121,9 +139,22 @@ Coord ClientGameSelfPlay::mcts_update_info(MCTSCheckersAI* mcts_checkers_ai, Coo
   return c;
 }
 
+// The game is over once the tablebase knows who wins before the move
+// limit and the draw rules. Draws are played on until the draw rules end
+// them.
+bool ClientGameSelfPlay::tablebase_result(float* final_value) const {
+  const CheckersState& s = _checkers_state_ext.state();
+  return tablebase_ != nullptr &&
+      tablebase_->probeWin(s.packedBoard(), s.noProgressPlies(), final_value);
+}
+
 void ClientGameSelfPlay::finish_game() {
+  finish_game(_checkers_state_ext.state().evaluateGame());
+}
+
+void ClientGameSelfPlay::finish_game(float final_value) {
   // My code
-  _checkers_state_ext.setFinalValue();
+  _checkers_state_ext.setFinalValue(final_value);
   // show board
   _checkers_state_ext.showFinishInfo();
 
@@ -140,10 +171,30 @@ void ClientGameSelfPlay::finish_game() {
   if (checkers_notifier_ != nullptr){
     checkers_notifier_->OnGameEnd(_checkers_state_ext);
   }
+  _arena_waiting = true;
   // My code
   _checkers_state_ext.restart();
 }
 
+// Take the next game from the arena once the previous one is over.
+bool ClientGameSelfPlay::arena_request() {
+  if (!_arena_waiting)
+    return true;
+
+  MsgRequest request;
+  if (!arena_->OnGameRequest(_game_idx, &request))
+    return false;
+
+  // The ais are kept while the models and colours stay the same.
+  bool same_request = !_checkers_state_ext.currRequest().vers.wait() &&
+      request == _checkers_state_ext.currRequest();
+  _checkers_state_ext.setRequest(request);
+  if (!same_request)
+    restart();
+  _arena_waiting = false;
+  return true;
+}
+
 void ClientGameSelfPlay::setAsync() {
   checkers_ai1->setRequiredVersion(-1);
   if (checkers_ai2 != nullptr)
@@ -158,7 +209,7 @@ void ClientGameSelfPlay::restart() {
 
   checkers_ai1.reset(nullptr);
   checkers_ai2.reset(nullptr);
-  if (_game_options.mode == "selfplay") {
+  if (_game_options.mode == "selfplay" || _game_options.mode == "arena") {
     checkers_ai1.reset(init_checkers_ai(
         "checkers_actor_black",
         checkers_request.vers.mcts_opt,
@@ -258,9 +309,11 @@ void ClientGameSelfPlay::act() {
     using std::placeholders::_2;
     auto f = std::bind(&ClientGameSelfPlay::OnReceive, this, _1, _2);
 
-    do {
-      dispatcher_->checkMessage(_checkers_state_ext.currRequest().vers.wait(), f);
-    } while (_checkers_state_ext.currRequest().vers.wait());
+    if (dispatcher_ != nullptr) {
+      do {
+        dispatcher_->checkMessage(_checkers_state_ext.currRequest().vers.wait(), f);
+      } while (_checkers_state_ext.currRequest().vers.wait());
+    }
 
     // Check request every 5 times.
     // Update current state.
@@ -333,6 +386,11 @@ void ClientGameSelfPlay::act() {
       return;
     }
   }
+  if (arena_ != nullptr && !arena_request()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return;
+  }
+
   int current_player = cs.currentPlayer();
   Coord move = M_INVALID;
 
@@ -372,8 +430,14 @@ void ClientGameSelfPlay::act() {
     return;
   }
 
+  float tablebase_value;
   if (cs.terminated()) {
     finish_game();
+  } else if (tablebase_result(&tablebase_value)) {
+    finish_game(tablebase_value);
+  } else if (!use_policy_network_only) {
+    // Search on while the opponent is to move.
+    curr_ai->ponder(cs);
   }
 }
 
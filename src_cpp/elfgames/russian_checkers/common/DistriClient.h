@@ -283,7 +283,8 @@ class CheckersGameNotifier : public CheckersGameNotifierBase {
     // Add state to records.
     guardedRecords_.feed(s);
 
-    CheckersFinishReason reason = s.state().getPly() >= TOTAL_MAX_MOVE ? MAX_STEP : 
+    CheckersFinishReason reason =
+    s.state().getPly() >= TOTAL_MAX_MOVE || s.state().drawn() ? MAX_STEP : 
     (s.state().currentPlayer() == WHITE_PLAYER) ? BLACK_WIN : WHITE_WIN;
 
     game_stats_.feedWinRate(reason, s.state().getFinalValue());
@@ -13,6 +13,7 @@
 // checkers
 #include "../game/CheckersState.h"
 #include "../game/CheckersStateExt.h"
+#include "../game/CheckersPosition.h"
 
 /*
   This Class responsible for data exchange between C++ and python.
@@ -139,6 +140,63 @@ class GameFeature {
     *ver = s._curr_request.vers.black_ver;
   }
 
+  // Training from positions materialized in the replay buffer.
+  static void extractSampleState(
+      const CheckersTrainSample& s, 
+      float* f) {
+    s.position.extractFeatures(f);
+  }
+
+  static void extractSampleMoveIdx(
+      const CheckersTrainSample& s, 
+      int* move_idx) {
+    *move_idx = s.position.move_idx;
+  }
+
+  static void extractSampleNumMove(
+      const CheckersTrainSample& s, 
+      int* num_move) {
+    *num_move = s.num_move;
+  }
+
+  static void extractSamplePredictedValue(
+      const CheckersTrainSample& s, 
+      float* predicted_value) {
+    *predicted_value = s.position.predicted_value;
+  }
+
+  static void extractSampleAugCode(
+      const CheckersTrainSample& s, 
+      int* aug_code) {
+    *aug_code = s.aug_code;
+  }
+
+  static void extractSampleWinner(
+      const CheckersTrainSample& s, 
+      float* winner) {
+    *winner = s.winner;
+  }
+
+  static void extractSampleMCTSPi(
+      const CheckersTrainSample& s, 
+      float* mcts_scores) {
+    s.position.extractPolicy(mcts_scores, s.played_move);
+  }
+
+  static void extractSampleOfflineAction(
+      const CheckersTrainSample& s, 
+      int64_t* offline_a) {
+    for (size_t i = 0; i < s.future_moves.size(); ++i) {
+      offline_a[i] = s.future_moves[i];
+    }
+  }
+
+  static void extractSampleSelfplayVersion(
+      const CheckersTrainSample& s, 
+      int64_t* ver) {
+    *ver = s.selfplay_ver;
+  }
+
   static void extractCheckersAIModelBlackVersion(
       const ModelPair& msg, 
       int64_t* ver) {
@@ -165,7 +223,8 @@ class GameFeature {
     // Binds methods to this key.
     // We use these methods to fill the memory and pass this info to the Python.
     checkers_s.addFunction<CheckersFeature>(extractCheckersState)
-      .addFunction<CheckersStateExtOffline>(extractCheckersStateExt);
+      .addFunction<CheckersStateExtOffline>(extractCheckersStateExt)
+      .addFunction<CheckersTrainSample>(extractSampleState);
 
 
     // Register the rest of the keys 
@@ -202,6 +261,17 @@ class GameFeature {
         .addFunction<int64_t>("checkers_selfplay_ver", extractCheckersStateSelfplayVersion)
         ;
 
+    e.addClass<CheckersTrainSample>()
+        .addFunction<int32_t>("checkers_move_idx", extractSampleMoveIdx)
+        .addFunction<int32_t>("checkers_num_move", extractSampleNumMove)
+        .addFunction<int32_t>("checkers_aug_code", extractSampleAugCode)
+        .addFunction<float>("checkers_predicted_value", extractSamplePredictedValue)
+        .addFunction<float>("checkers_winner", extractSampleWinner)
+        .addFunction<float>("checkers_mcts_scores", extractSampleMCTSPi)
+        .addFunction<int64_t>("checkers_offline_a", extractSampleOfflineAction)
+        .addFunction<int64_t>("checkers_selfplay_ver", extractSampleSelfplayVersion)
+        ;
+
     e.addClass<ModelPair>()
         .addFunction<int64_t>("checkers_black_ver", extractCheckersAIModelBlackVersion)
         .addFunction<int64_t>("checkers_white_ver", extractCheckersAIModelWhiteVersion);
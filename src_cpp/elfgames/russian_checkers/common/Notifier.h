@@ -24,4 +24,15 @@ class CheckersGameNotifierBase {
   using MCTSResult = elf::ai::tree_search::MCTSResultT<Coord>;
   virtual void OnGameEnd(const CheckersStateExt&) {}
   virtual void OnStateUpdate(const ThreadState&) {}
-};
\ No newline at end of file
+};
+
+/*
+  from this class inherit LocalArena, which hands out games to the
+  threads in the arena mode instead of a server.
+*/
+class CheckersGameRequesterBase {
+ public:
+  // Fill in the request of the next game of thread game_idx. Return
+  // false if it has none yet.
+  virtual bool OnGameRequest(int game_idx, MsgRequest* request) = 0;
+};
@@ -1,5 +1,7 @@
 #include "CheckersBoard.h"
 
+#include "elf/utils/bitplanes.h"
+
 #define myassert(p, text) \
   do {                    \
     if (!(p)) {           \
@@ -179,6 +181,179 @@ void CheckersCopyBoard(CheckersBoard* dst, const CheckersBoard* src) {
 
 
 
+namespace {
+
+inline int packedSquare(int y, int x) {
+  return y * 4 + x / 2;
+}
+
+// Random keys of the Zobrist hash: [black pawn, white pawn, black king,
+// white king][square], white to move and pending jump square.
+struct ZobristKeys {
+  uint64_t pieces[4][32];
+  uint64_t white_to_move;
+  uint64_t next_bit[32];
+
+  ZobristKeys() {
+    // splitmix64, so the keys do not depend on the standard library.
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    auto next = [&x]() {
+      uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    };
+    for (auto& keys : pieces)
+      for (auto& k : keys)
+        k = next();
+    white_to_move = next();
+    for (auto& k : next_bit)
+      k = next();
+  }
+};
+
+const ZobristKeys& zobristKeys() {
+  static const ZobristKeys keys;
+  return keys;
+}
+
+// Squares of one byte of a packed mask: two rows of 4 dark squares,
+// starting at x = 1 on the even row and x = 0 on the odd one.
+struct PackedRowsTable {
+  uint16_t squares[256];
+
+  PackedRowsTable() {
+    for (int b = 0; b < 256; b++) {
+      squares[b] = 0;
+      for (int k = 0; k < 4; k++) {
+        if (b & (1 << k))
+          squares[b] |= 1 << (2 * k + 1);
+        if (b & (1 << (k + 4)))
+          squares[b] |= 1 << (8 + 2 * k);
+      }
+    }
+  }
+};
+
+const PackedRowsTable& packedRowsTable() {
+  static const PackedRowsTable table;
+  return table;
+}
+
+uint64_t hashMask(uint32_t mask, const uint64_t* keys) {
+  uint64_t h = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    h ^= keys[__builtin_ctz(mask)];
+  }
+  return h;
+}
+
+} // namespace
+
+
+void PackBoard(const CheckersBoard& board, CheckersPackedBoard* packed) {
+  const ZobristKeys& keys = zobristKeys();
+
+  packed->pawns[0] = packed->pawns[1] = 0;
+  packed->kings[0] = packed->kings[1] = 0;
+  for (int y = 0; y < 8; y++) {
+    for (int x = (y + 1) % 2; x < 8; x += 2) {
+      uint32_t bit = 1u << packedSquare(y, x);
+      switch (board.board[y][x]) {
+        case BLACK_PAWN: packed->pawns[0] |= bit; break;
+        case WHITE_PAWN: packed->pawns[1] |= bit; break;
+        case BLACK_KING: packed->kings[0] |= bit; break;
+        case WHITE_KING: packed->kings[1] |= bit; break;
+      }
+    }
+  }
+
+  packed->ply = board._ply;
+  packed->last_move = board._last_move;
+  packed->current_player = board.current_player;
+  packed->next_bit = board.next_bit_y == -1
+      ? -1
+      : packedSquare(board.next_bit_y, board.next_bit_x);
+  packed->game_ended = board.game_ended;
+
+  packed->hash = hashMask(packed->pawns[0], keys.pieces[0]) ^
+      hashMask(packed->pawns[1], keys.pieces[1]) ^
+      hashMask(packed->kings[0], keys.pieces[2]) ^
+      hashMask(packed->kings[1], keys.pieces[3]);
+  if (packed->current_player == WHITE_PLAYER)
+    packed->hash ^= keys.white_to_move;
+  if (packed->next_bit != -1)
+    packed->hash ^= keys.next_bit[packed->next_bit];
+}
+
+
+void UnpackBoard(const CheckersPackedBoard& packed, CheckersBoard* board) {
+  const int pieces[2][2] = {{BLACK_PAWN, WHITE_PAWN}, {BLACK_KING, WHITE_KING}};
+  const uint32_t* masks[2] = {packed.pawns, packed.kings};
+
+  memset(board->board, 0, sizeof(board->board));
+  for (int kind = 0; kind < 2; kind++) {
+    for (int color = 0; color < 2; color++) {
+      for (uint32_t m = masks[kind][color]; m != 0; m &= m - 1) {
+        int sq = __builtin_ctz(m);
+        int y = sq / 4;
+        board->board[y][sq % 4 * 2 + (y + 1) % 2] = pieces[kind][color];
+      }
+    }
+  }
+
+  board->current_player = packed.current_player;
+  board->game_ended = packed.game_ended;
+  if (packed.next_bit == -1) {
+    board->next_bit_y = -1;
+    board->next_bit_x = -1;
+  } else {
+    board->next_bit_y = packed.next_bit / 4;
+    board->next_bit_x = packed.next_bit % 4 * 2 + (board->next_bit_y + 1) % 2;
+  }
+  board->_last_move = packed.last_move;
+  board->_ply = packed.ply;
+}
+
+
+bool SamePosition(const CheckersPackedBoard& b1, const CheckersPackedBoard& b2) {
+  return b1.hash == b2.hash
+      && b1.pawns[0] == b2.pawns[0] && b1.pawns[1] == b2.pawns[1]
+      && b1.kings[0] == b2.kings[0] && b1.kings[1] == b2.kings[1]
+      && b1.current_player == b2.current_player
+      && b1.next_bit == b2.next_bit
+      && b1.game_ended == b2.game_ended;
+}
+
+
+
+uint64_t PackedToSquares(uint32_t mask) {
+  const uint16_t* squares = packedRowsTable().squares;
+
+  return uint64_t(squares[mask & 0xff])
+      | uint64_t(squares[(mask >> 8) & 0xff]) << 16
+      | uint64_t(squares[(mask >> 16) & 0xff]) << 32
+      | uint64_t(squares[mask >> 24]) << 48;
+}
+
+
+std::array<uint64_t, 4> GetObservationMasks(const CheckersPackedBoard& packed) {
+  int active = packed.current_player == BLACK_PLAYER ? 0 : 1;
+  int passive = 1 - active;
+  // GetObservation(board, WHITE_PLAYER) turns the board by 180 degrees.
+  auto observe = [](uint32_t mask, bool turned) {
+    uint64_t squares = PackedToSquares(mask);
+    return turned ? elf_utils::reverse_bits(squares) : squares;
+  };
+
+  return {observe(packed.pawns[passive], active == 1),
+          observe(packed.kings[passive], active == 1),
+          observe(packed.pawns[active], active == 0),
+          observe(packed.kings[active], active == 0)};
+}
+
+
+
 std::vector<std::array<int, 2>> getJumps(CheckersBoard board) {
   std::vector<std::array<int, 2>> result;
   std::vector<std::array<int, 2>> tmp;
@@ -1,5 +1,7 @@
 #pragma once 
 
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <queue>
@@ -59,6 +61,11 @@ constexpr uint64_t TOTAL_NUM_ACTIONS = 280;
 constexpr int TOTAL_MAX_MOVE = 250;
 // max num of repeat moves for board
 constexpr int REPEAT_MOVE = 4;
+// The game is drawn when a position occurs for the REPEAT_POSITION-th
+// time, or after NO_PROGRESS_MAX_MOVE plies (15 moves of each side)
+// without a capture nor a pawn move.
+constexpr int REPEAT_POSITION = 3;
+constexpr int NO_PROGRESS_MAX_MOVE = 30;
 
 // action index;
 typedef unsigned short  Coord;
@@ -79,7 +86,23 @@ typedef struct {
 } CheckersBoard;
 
 
-
+// Compact copy of a CheckersBoard, 32 bytes instead of ~280. Kept by
+// CheckersState so that copying states (e.g. for every MCTS node) is
+// cheap. Each mask has one bit per dark square (y * 4 + x / 2).
+typedef struct {
+  // [0] black, [1] white.
+  uint32_t pawns[2];
+  uint32_t kings[2];
+  // Zobrist hash of the pieces, player to move and pending jump.
+  uint64_t hash;
+
+  int16_t   ply;
+  uint16_t  last_move;
+  int8_t    current_player;
+  // Square of the piece that has to keep jumping, -1 if none.
+  int8_t    next_bit;
+  bool      game_ended;
+} CheckersPackedBoard;
 
 bool  CheckersTryPlay(CheckersBoard board, Coord action);
 bool  CheckersIsOver(CheckersBoard board);
@@ -88,6 +111,18 @@ void  ClearBoard(CheckersBoard *board);
 
 void  CheckersCopyBoard(CheckersBoard* dst, const CheckersBoard* src);
 
+void  PackBoard(const CheckersBoard& board, CheckersPackedBoard* packed);
+void  UnpackBoard(const CheckersPackedBoard& packed, CheckersBoard* board);
+// Same position (ply and last move are not compared).
+bool  SamePosition(const CheckersPackedBoard& b1, const CheckersPackedBoard& b2);
+// Packed mask to a mask of board squares (bit = y * 8 + x).
+uint64_t PackedToSquares(uint32_t mask);
+// Square masks of the four piece planes of CheckersFeature, the same
+// cells GetObservation() marks with 1 and 3 for the active player, then
+// for the passive one. GetObservation(board, player) marks the pieces
+// of -player, so the first two planes hold the passive player's pieces.
+std::array<uint64_t, 4> GetObservationMasks(const CheckersPackedBoard& packed);
+
 std::vector<std::array<int, 2>> getAllMoves(CheckersBoard board);
 
 std::array<int, TOTAL_NUM_ACTIONS>  GetValidMovesBinary(CheckersBoard board);
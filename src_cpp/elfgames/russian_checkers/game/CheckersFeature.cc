@@ -1,6 +1,8 @@
 #include "CheckersFeature.h"
 #include "CheckersState.h"
 
+#include "elf/utils/bitplanes.h"
+
 static float* board_plane(float* features, int idx) {
   return features + idx * CHECKERS_BOARD_SIZE * CHECKERS_BOARD_SIZE;
 }
@@ -8,30 +10,6 @@ static float* board_plane(float* features, int idx) {
 // features param will taken from parent function 
 #define LAYER(idx) board_plane(features, idx)
 
-void CheckersFeature::getKings(int player, float* data) const {
-  std::array<std::array<int, 8>, 8> observation;
-  observation = GetObservation(s_.board(), player);
-  
-  for (int y = 0; y < CHECKERS_BOARD_SIZE; ++y) {
-    for (int x = 0; x < CHECKERS_BOARD_SIZE; ++x) {
-      if (observation[y][x] == 3)
-        data[y * CHECKERS_BOARD_SIZE + x] = 1;
-    }
-  }
-}
-
-void CheckersFeature::getPawns(int player, float* data) const {
-  std::array<std::array<int, 8>, 8> observation;
-  observation = GetObservation(s_.board(), player);
-  
-  for (int y = 0; y < CHECKERS_BOARD_SIZE; ++y) {
-    for (int x = 0; x < CHECKERS_BOARD_SIZE; ++x) {
-      if (observation[y][x] == 1)
-        data[y * CHECKERS_BOARD_SIZE + x] = 1;
-    }
-  }
-}
-
 // void CheckersFeature::getHistory(int player, float* data) const {
 //   const Board* _board = &s_.board();
 
@@ -55,28 +33,16 @@ void CheckersFeature::extract(std::vector<float>* features) const {
 }
 
 void CheckersFeature::extract(float* features) const {
-  const CheckersBoard* _board = &s_.board();
-  int passive_player, active_player;
-
-  active_player = _board->current_player;
-  if (active_player == WHITE_PLAYER)
-    passive_player = BLACK_PLAYER;
-  else 
-    passive_player = WHITE_PLAYER;
+  const CheckersPackedBoard& board = s_.packedBoard();
+  std::array<uint64_t, 4> masks = GetObservationMasks(board);
 
-  std::fill(features, features + CHECKERS_NUM_FEATURES * kBoardRegion, 0.0);
-
-  // Save the current board state to game state.
-  getPawns(active_player, LAYER(0));
-  getKings(active_player, LAYER(1));
-  getPawns(passive_player, LAYER(2));
-  getKings(passive_player, LAYER(3));
+  // Every cell is written, no need to clear the slot first.
+  for (int i = 0; i < 4; ++i) {
+    elf_utils::bits_to_plane(masks[i], LAYER(i));
+  }
 
   // the player on move
-  float* black_indicator = LAYER(4);
-  float* white_indicator = LAYER(5);
-  if (active_player == BLACK_PLAYER)
-    std::fill(black_indicator, black_indicator + kBoardRegion, 1.0);
-  else
-    std::fill(white_indicator, white_indicator + kBoardRegion, 1.0);
+  bool black = board.current_player == BLACK_PLAYER;
+  std::fill(LAYER(4), LAYER(4) + kBoardRegion, black ? 1.0 : 0.0);
+  std::fill(LAYER(5), LAYER(5) + kBoardRegion, black ? 0.0 : 1.0);
 }
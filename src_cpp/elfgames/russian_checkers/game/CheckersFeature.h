@@ -15,7 +15,7 @@ struct CheckersBoardHistory {
 
     for (int y = 0; y < 8; y++) {
       for (int x = 0; x < 8; x++) {
-          board[y][x] != b.board[y][x];
+          board[y][x] = b.board[y][x];
       }
     }
     current_player = b.current_player;
@@ -40,9 +40,6 @@ class CheckersFeature {
   const CheckersState& s_;
   static constexpr int64_t kBoardRegion = CHECKERS_BOARD_SIZE * CHECKERS_BOARD_SIZE;
 
-  // Compute features.
-  void getPawns(int player, float* data) const;
-  void getKings(int player, float* data) const;
   // void getHistory(int player, float* data) const;
 };
 
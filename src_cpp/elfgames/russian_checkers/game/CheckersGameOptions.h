@@ -28,6 +28,8 @@ struct CheckersGameOptions {
   //    Instead, it will get the action from the neural network to proceed.
   // mode == "offline": offline training
   // mode == "selfplay": self play.
+  // mode == "arena": evaluation of two models in this process, see
+  //    LocalArena.
   std::string mode;
 
   // Use mcts engine.
@@ -48,6 +50,38 @@ struct CheckersGameOptions {
   int q_max_size = 1000;
   int num_reader = 50;
 
+  // Sample games from the replay buffer by weight instead of uniformly.
+  // Weight = record priority (if > 0) * #positions (if by_length),
+  // halved every version_half_life model versions the game is behind the
+  // newest selfplay game (if > 0), and every recency_half_life inserted
+  // games (if > 0).
+  bool replay_prioritized = false;
+  float replay_recency_half_life = 0.0;
+  float replay_version_half_life = 0.0;
+  bool replay_weight_by_length = false;
+
+  // If not empty, training positions are kept in memory-mapped segment
+  // files in this directory instead of the in-RAM replay buffer.
+  std::string replay_store_dir;
+  // Positions per segment file.
+  int replay_store_segment_size = 65536;
+  // Keep positions of the last N selfplay versions, 0 keeps everything.
+  int replay_store_num_versions = 0;
+  // Positions (over both win stores) required before training starts.
+  // Plays the role of q_min_size, which counts games per reader queue.
+  int replay_store_min_positions = 20000;
+  // Sample a uniform game, then one of its positions, as the replay buffer
+  // does. Otherwise positions are uniform, which favors long games.
+  bool replay_store_per_game = true;
+
+  // Apply a random symmetry (CheckersSymmetry.h) to each train sample.
+  bool train_augment = false;
+
+  // Endgame tablebase built by russian_checkers_tablebase. If set, MCTS
+  // leaves in it are not sent to the network and selfplay games stop
+  // once they are won.
+  std::string tablebase_path;
+
   // Second puct used for ai2, if -1 then use the same puct.
   float       white_puct = -1.0;
   int white_mcts_rollout_per_batch = -1;
@@ -55,6 +89,15 @@ struct CheckersGameOptions {
 
   int eval_num_games = 400;
   float eval_thres = 0.55;
+  // Sequential test of the new model being eval_sprt_elo1 rather than
+  // eval_sprt_elo0 Elo stronger, with error rates eval_sprt_alpha (false
+  // pass) and eval_sprt_beta (false fail). Evaluation stops once decided,
+  // or after eval_num_games games compared against eval_thres.
+  bool eval_sprt = true;
+  float eval_sprt_elo0 = 0.0;
+  float eval_sprt_elo1 = 35.0;
+  float eval_sprt_alpha = 0.05;
+  float eval_sprt_beta = 0.05;
 
   // Default it is 20 min. During intergration test we could make it shorter.
   int client_max_delay_sec = 1200;
@@ -117,6 +160,14 @@ struct CheckersGameOptions {
     ss << "Eval num games: " << eval_num_games << std::endl;
     ss << std::setw(30) << std::right;
     ss << "Eval Threshold: " << eval_thres << std::endl;
+    if (eval_sprt) {
+      ss << std::setw(30) << std::right;
+      ss << "Eval SPRT elo0/elo1: " << eval_sprt_elo0 << "/"
+         << eval_sprt_elo1 << std::endl;
+      ss << std::setw(30) << std::right;
+      ss << "Eval SPRT alpha/beta: " << eval_sprt_alpha << "/"
+         << eval_sprt_beta << std::endl;
+    }
     ss << std::setw(30) << std::right;
     ss << "Eval num Threads: " << eval_num_threads << std::endl;
 
@@ -163,6 +214,36 @@ struct CheckersGameOptions {
     ss << std::setw(30) << std::right;
     ss << "Q_max_size: " << q_max_size << std::endl;
 
+    if (replay_prioritized) {
+      ss << std::setw(30) << std::right;
+      ss << "Prioritized replay: "
+         << "[recency_half_life=" << replay_recency_half_life << "]"
+         << "[version_half_life=" << replay_version_half_life << "]"
+         << "[weight_by_length="
+         << elf_utils::print_bool(replay_weight_by_length) << "]"
+         << std::endl;
+    }
+
+    if (!replay_store_dir.empty()) {
+      ss << std::setw(30) << std::right;
+      ss << "Replay store: " << replay_store_dir
+         << "[segment_size=" << replay_store_segment_size << "]"
+         << "[num_versions=" << replay_store_num_versions << "]"
+         << "[min_positions=" << replay_store_min_positions << "]"
+         << "[per_game=" << elf_utils::print_bool(replay_store_per_game)
+         << "]"
+         << std::endl;
+    }
+
+    ss << std::setw(30) << std::right;
+    ss << "Train augment: " << elf_utils::print_bool(train_augment)
+       << std::endl;
+
+    if (!tablebase_path.empty()) {
+      ss << std::setw(30) << std::right;
+      ss << "Tablebase: " << tablebase_path << std::endl;
+    }
+
     ss << std::setw(30) << std::right;
     ss << "Verbose: " << elf_utils::print_bool(verbose) << std::endl;
 
@@ -216,6 +297,17 @@ struct CheckersGameOptions {
       q_min_size,
       q_max_size,
       num_reader,
+      replay_prioritized,
+      replay_recency_half_life,
+      replay_version_half_life,
+      replay_weight_by_length,
+      replay_store_dir,
+      replay_store_segment_size,
+      replay_store_num_versions,
+      replay_store_min_positions,
+      replay_store_per_game,
+      train_augment,
+      tablebase_path,
       dump_record_prefix,
       use_mcts_ai2,
       num_reset_ranking,
@@ -232,6 +324,11 @@ struct CheckersGameOptions {
       white_mcts_rollout_per_batch,
       white_mcts_rollout_per_thread,
       eval_thres,
+      eval_sprt,
+      eval_sprt_elo0,
+      eval_sprt_elo1,
+      eval_sprt_alpha,
+      eval_sprt_beta,
       keep_prev_selfplay,
       expected_num_clients,
       human_plays_for);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "CheckersBoard.h"
+
+/*
+  Perft: number of leaf nodes of the move tree to a given depth, walked
+  with GetValidMovesBinary + CheckersPlay only. Every action is one ply,
+  so a multi-jump counts as several plies (next_bit_y/x keeps the same
+  player to move).
+
+  Used as a correctness oracle for the move generator (see
+  CheckersPerftTest.cc) and as its speed gate (see tools/Perft.cc).
+*/
+
+struct PerftResult {
+  uint64_t nodes = 0;
+  double seconds = 0;
+
+  double nodesPerSecond() const {
+    return seconds > 0 ? nodes / seconds : 0;
+  }
+};
+
+uint64_t CheckersPerft(const CheckersBoard& board, int depth);
+
+// Leaf count below each legal action of the board.
+std::vector<std::pair<Coord, uint64_t>> CheckersPerftDivide(
+    const CheckersBoard& board,
+    int depth);
+
+// Timed perft. Subtrees are spread over num_threads threads
+// (num_threads <= 0 means all cores).
+PerftResult CheckersPerftBenchmark(
+    const CheckersBoard& board,
+    int depth,
+    int num_threads = 1);
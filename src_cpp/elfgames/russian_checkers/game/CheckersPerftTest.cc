@@ -0,0 +1,119 @@
+#include "CheckersPerft.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// rows[0] is the top of GetTrueObservationStr. 'w'/'W' white pawn/king,
+// 'b'/'B' black pawn/king, anything else is an empty square.
+CheckersBoard boardFromRows(const std::string rows[8], int player) {
+  CheckersBoard board;
+  ClearBoard(&board);
+  board.current_player = player;
+  for (int y = 0; y < 8; y++) {
+    for (int x = 0; x < 8; x++) {
+      switch (rows[y][x]) {
+        case 'w': board.board[y][x] = WHITE_PAWN; break;
+        case 'W': board.board[y][x] = WHITE_KING; break;
+        case 'b': board.board[y][x] = BLACK_PAWN; break;
+        case 'B': board.board[y][x] = BLACK_KING; break;
+        default: board.board[y][x] = EMPTY;
+      }
+    }
+  }
+  return board;
+}
+
+void expectPerft(
+    const CheckersBoard& board,
+    const std::vector<uint64_t>& expected) {
+  for (size_t depth = 1; depth <= expected.size(); ++depth) {
+    EXPECT_EQ(expected[depth - 1], CheckersPerft(board, depth))
+        << "depth " << depth;
+  }
+}
+
+} // namespace
+
+// Depths 1-4 agree with the published draughts counts, deeper ones pin
+// the current generator (multi-jumps count one ply per jump).
+TEST(CheckersPerftTest, startPosition) {
+  CheckersBoard board;
+  ClearBoard(&board);
+  expectPerft(board, {7, 49, 302, 1469, 7350, 36644, 177113});
+}
+
+// Pawns capture backwards too, and capturing is mandatory.
+TEST(CheckersPerftTest, pawnCapture) {
+  const std::string rows[8] = {
+      ".w......",
+      "........",
+      ".w......",
+      "..b.....",
+      "...w....",
+      "........",
+      "........",
+      "......b.",
+  };
+  CheckersBoard board = boardFromRows(rows, BLACK_PLAYER);
+  EXPECT_EQ(2u, CheckersPerft(board, 1));
+  expectPerft(board, {2, 7, 23, 67, 186, 559, 1842});
+}
+
+// A king flies over empty squares and has to land where it can keep
+// capturing.
+TEST(CheckersPerftTest, kingCapture) {
+  const std::string rows[8] = {
+      "........",
+      "......w.",
+      "...w....",
+      "........",
+      "...w....",
+      "........",
+      "........",
+      "B.......",
+  };
+  CheckersBoard board = boardFromRows(rows, BLACK_PLAYER);
+  EXPECT_EQ(1u, CheckersPerft(board, 1));
+  expectPerft(board, {1, 3, 6, 43, 59, 349, 549});
+}
+
+// A pawn reaching the last row becomes a king.
+TEST(CheckersPerftTest, promotion) {
+  const std::string rows[8] = {
+      "........",
+      "........",
+      "........",
+      "..b.....",
+      "........",
+      "........",
+      ".w......",
+      "........",
+  };
+  CheckersBoard board = boardFromRows(rows, WHITE_PLAYER);
+  expectPerft(board, {2, 4, 28, 55, 460, 753, 6703});
+}
+
+TEST(CheckersPerftTest, divideSumsToPerft) {
+  CheckersBoard board;
+  ClearBoard(&board);
+  uint64_t sum = 0;
+  for (const auto& p : CheckersPerftDivide(board, 5)) {
+    sum += p.second;
+  }
+  EXPECT_EQ(CheckersPerft(board, 5), sum);
+}
+
+TEST(CheckersPerftTest, benchmarkThreads) {
+  CheckersBoard board;
+  ClearBoard(&board);
+  EXPECT_EQ(36644u, CheckersPerftBenchmark(board, 6, 1).nodes);
+  EXPECT_EQ(36644u, CheckersPerftBenchmark(board, 6, 4).nodes);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,161 @@
+#include "CheckersPosition.h"
+#include "CheckersState.h"
+#include "../sgf/sgf.h"
+
+#include "elf/utils/bitplanes.h"
+
+static constexpr int64_t kBoardRegion =
+    CHECKERS_BOARD_SIZE * CHECKERS_BOARD_SIZE;
+
+///////////// CheckersPosition ////////////////////
+void CheckersPosition::extractFeatures(float* features) const {
+  for (size_t i = 0; i < planes.size(); ++i) {
+    elf_utils::bits_to_plane(planes[i], features + i * kBoardRegion);
+  }
+
+  // the player on move
+  float* black_indicator = features + 4 * kBoardRegion;
+  float* white_indicator = features + 5 * kBoardRegion;
+  bool black = current_player == BLACK_PLAYER;
+  std::fill(black_indicator, black_indicator + kBoardRegion, black ? 1.0 : 0.0);
+  std::fill(white_indicator, white_indicator + kBoardRegion, black ? 0.0 : 1.0);
+}
+
+void CheckersPosition::extractPolicy(float* pi, Coord played_move) const {
+  if (has_policy) {
+    for (size_t i = 0; i < TOTAL_NUM_ACTIONS; ++i) {
+      pi[i] = policy[i] * policy_scale;
+    }
+  } else {
+    std::fill(pi, pi + TOTAL_NUM_ACTIONS, 0.0);
+    pi[played_move] = 1.0;
+  }
+}
+
+///////////// CheckersGamePositions ////////////////////
+CheckersGamePositions CheckersGamePositions::fromRecord(
+    const CheckersRecord& r,
+    int num_future_actions) {
+  CheckersGamePositions g;
+
+  g.moves = str2coords(r.result.content);
+  g.winner = r.result.reward > 0 ? 1.0 : -1.0;
+  g.selfplay_ver = r.request.vers.black_ver;
+  g.pri = r.pri;
+
+  // Same range as CheckersStateExtOffline::switchRandomMove().
+  int num_positions =
+      (int)g.moves.size() - std::max(num_future_actions, 1) + 1;
+  if (num_positions <= 0)
+    return g;
+  g.positions.resize(num_positions);
+
+  CheckersState state;
+  for (int i = 0; i < num_positions; ++i) {
+    if (i > 0)
+      state.forward(g.moves[i - 1]);
+
+    CheckersPosition& p = g.positions[i];
+    p.planes = GetObservationMasks(state.packedBoard());
+    p.current_player = state.currentPlayer();
+
+    p.move_idx = state.getPly() - 1;
+    p.predicted_value = (size_t)p.move_idx < r.result.values.size()
+        ? r.result.values[p.move_idx]
+        : 0.0;
+
+    p.has_policy = false;
+    p.policy_scale = 0.0;
+    if ((size_t)p.move_idx < r.result.policies.size()) {
+      const auto& prob = r.result.policies[p.move_idx].prob;
+      float sum_v = 0.0;
+      for (size_t k = 0; k < TOTAL_NUM_ACTIONS; ++k) {
+        p.policy[k] = prob[k];
+        sum_v += prob[k];
+      }
+      if (sum_v > 0) {
+        p.has_policy = true;
+        p.policy_scale = 1.0 / sum_v;
+      }
+    }
+  }
+  return g;
+}
+
+///////////// CheckersStoredPosition ////////////////////
+std::vector<CheckersStoredPosition> CheckersStoredPosition::fromGame(
+    const CheckersGamePositions& g) {
+  std::vector<CheckersStoredPosition> res(g.positions.size());
+
+  for (size_t i = 0; i < g.positions.size(); ++i) {
+    CheckersStoredPosition& p = res[i];
+    p.position = g.positions[i];
+    p.winner = g.winner;
+    p.selfplay_ver = g.selfplay_ver;
+    p.num_move = g.moves.size();
+    for (int k = 0; k < kMaxFutureActions; ++k) {
+      size_t m = p.position.move_idx + k;
+      p.future_moves[k] = m < g.moves.size() ? g.moves[m] : 0;
+    }
+  }
+  return res;
+}
+
+///////////// CheckersTrainSample ////////////////////
+void CheckersTrainSample::fromGame(
+    const CheckersGamePositions& g,
+    size_t idx,
+    int num_future_actions) {
+  position = g.positions[idx];
+  aug_code = CHECKERS_AUG_IDENTITY;
+  winner = g.winner;
+  selfplay_ver = g.selfplay_ver;
+  num_move = g.moves.size();
+
+  auto move_at = [&g](size_t m) -> Coord {
+    return m < g.moves.size() ? g.moves[m] : 0;
+  };
+  played_move = move_at(position.move_idx);
+  future_moves.resize(num_future_actions);
+  for (size_t i = 0; i < future_moves.size(); ++i) {
+    future_moves[i] = move_at(position.move_idx + i);
+  }
+}
+
+void CheckersTrainSample::fromStored(
+    const CheckersStoredPosition& p,
+    int num_future_actions) {
+  position = p.position;
+  aug_code = CHECKERS_AUG_IDENTITY;
+  winner = p.winner;
+  selfplay_ver = p.selfplay_ver;
+  num_move = p.num_move;
+  played_move = p.future_moves[0];
+
+  future_moves.assign(num_future_actions, 0);
+  int n = std::min(num_future_actions, CheckersStoredPosition::kMaxFutureActions);
+  std::copy(p.future_moves, p.future_moves + n, future_moves.begin());
+}
+
+void CheckersTrainSample::augment(int code) {
+  aug_code = code;
+  if (code != CHECKERS_AUG_FLIP_COLORS)
+    return;
+
+  // Piece planes do not change, the player on move and the values
+  // (black's point of view) do.
+  position.current_player = -position.current_player;
+  position.predicted_value = -position.predicted_value;
+  winner = -winner;
+
+  if (position.has_policy) {
+    auto policy = position.policy;
+    for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+      position.policy[CheckersAugmentAction(c, code)] = policy[c];
+    }
+  }
+  played_move = CheckersAugmentAction(played_move, code);
+  for (auto& m : future_moves) {
+    m = CheckersAugmentAction(m, code);
+  }
+}
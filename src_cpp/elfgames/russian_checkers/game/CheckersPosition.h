@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// checkers
+#include "CheckersBoard.h"
+#include "CheckersSymmetry.h"
+#include "../common/record.h"
+#include "Record.h"
+
+/*
+  One training position, materialized once when a game record enters
+  the replay buffer, so the server never replays moves to sample it.
+*/
+struct CheckersPosition {
+  // Piece masks (bit = y * 8 + x) of the first four planes of
+  // CheckersFeature::extract(), see GetObservationMasks().
+  std::array<uint64_t, 4> planes;
+  int current_player;
+
+  // Ply - 1 of the position, same as checkers_move_idx.
+  int move_idx;
+  float predicted_value;
+
+  // Quantized MCTS policy, policy_scale normalizes it to sum to 1.
+  // Without a stored policy, the target is the played move.
+  bool has_policy;
+  float policy_scale;
+  std::array<unsigned char, TOTAL_NUM_ACTIONS> policy;
+
+  // Fills CHECKERS_NUM_FEATURES * 64 floats.
+  void extractFeatures(float* features) const;
+  // Fills TOTAL_NUM_ACTIONS floats, played_move is used without a policy.
+  void extractPolicy(float* pi, Coord played_move) const;
+};
+
+/*
+  All sampleable positions of one game.
+  This is what the server replay buffer stores.
+*/
+struct CheckersGamePositions {
+  std::vector<Coord> moves;
+  std::vector<CheckersPosition> positions;
+
+  float winner = 0.0;
+  int64_t selfplay_ver = -1;
+  // CheckersRecord::pri, used by prioritized replay.
+  float pri = 0.0;
+
+  // Replays the game once, keeping every position which has
+  // num_future_actions moves after it.
+  static CheckersGamePositions fromRecord(
+      const CheckersRecord& r,
+      int num_future_actions);
+};
+
+/*
+  Fixed-size position record of the on-disk replay store.
+*/
+struct CheckersStoredPosition {
+  static constexpr int kMaxFutureActions = 8;
+
+  CheckersPosition position;
+  float winner;
+  int64_t selfplay_ver;
+  int num_move;
+  // Starts with the move played from this position.
+  Coord future_moves[kMaxFutureActions];
+
+  // One record per position of g.
+  static std::vector<CheckersStoredPosition> fromGame(
+      const CheckersGamePositions& g);
+};
+
+/*
+  Sampled position, copied out of the replay buffer and
+  bound to the "train" batch.
+*/
+struct CheckersTrainSample {
+  CheckersPosition position;
+  Coord played_move = 0;
+  // Moves starting from this position (checkers_offline_a).
+  std::vector<Coord> future_moves;
+
+  float winner = 0.0;
+  int64_t selfplay_ver = -1;
+  int num_move = 0;
+  // Symmetry applied by augment(), see CheckersSymmetry.h.
+  int aug_code = CHECKERS_AUG_IDENTITY;
+
+  void fromGame(
+      const CheckersGamePositions& g,
+      size_t idx,
+      int num_future_actions);
+  void fromStored(const CheckersStoredPosition& p, int num_future_actions);
+  // Turns the sample into the same position under the symmetry aug_code.
+  void augment(int aug_code);
+};
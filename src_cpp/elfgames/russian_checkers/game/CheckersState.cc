@@ -6,33 +6,49 @@ bool CheckersState::forward(const Coord& c) {
     throw std::range_error("CheckersState::forward(): move is M_INVALID");
   if (terminated() || c > TOTAL_NUM_ACTIONS)
     return false;
-  if (!CheckersTryPlay(_board, c))
+  CheckersBoard b = board();
+  if (!CheckersTryPlay(b, c))
     return false;
 
-  
-  CheckersPlay(&_board, c);
-  _moves.push_back(c);
-  // _history.emplace_back(_board);
-  // if (_history.size() > MAX_CHECKERS_HISTORY)
-  //   _history.pop_front();
+  CheckersPackedBoard prev = _board;
+  CheckersPlay(&b, c);
+  PackBoard(b, &_board);
+  _moves.push_back(c, _board.hash);
+  updateDrawRules(prev);
   return true;
 }
 
+void CheckersState::updateDrawRules(const CheckersPackedBoard& prev) {
+  // Pawns only move forward and pieces are never added, so no position
+  // before a pawn move or a capture comes back.
+  bool progress = prev.pawns[0] != _board.pawns[0] ||
+      prev.pawns[1] != _board.pawns[1] ||
+      __builtin_popcount(prev.kings[0] | prev.kings[1]) !=
+          __builtin_popcount(_board.kings[0] | _board.kings[1]);
+  _no_progress = progress ? 0 : _no_progress + 1;
+  // The initial position has all the pawns, so it never comes back and
+  // is not in _moves.
+  _repetitions = _moves.repetitions(_no_progress);
+}
+
 bool CheckersState::checkMove(const Coord& c) const {
-  return CheckersTryPlay(_board, c);
+  return CheckersTryPlay(board(), c);
 }
 
 void CheckersState::reset() {  
-  ClearBoard(&_board);
+  CheckersBoard b;
+  ClearBoard(&b);
+  PackBoard(b, &_board);
   _moves.clear();
-  // _history.clear();
+  _no_progress = 0;
+  _repetitions = 1;
   _final_value = 0.0;
 }
 
 std::string CheckersState::showBoard() const {
   std::stringstream ss;
 
-  ss  << GetTrueObservationStr(_board);
+  ss  << GetTrueObservationStr(board());
   if (lastMove() != M_INVALID)
     ss  << "\nLast move\t: " << moves::m_to_h.find(lastMove())->second;
   else
@@ -42,18 +58,21 @@ std::string CheckersState::showBoard() const {
     ss << GREEN_C << "Black" << COLOR_END;
   else
     ss << RED_C << "White" << COLOR_END;
-  ss << "\nmove num\t: " << _board._ply << "\n";
+  ss << "\nmove num\t: " << getPly() << "\n";
   return ss.str();
 }
 
 // Eval game call on each node in tree.
 // Should return 0 if state is not terminate,
-// because we eval current state by value func on each step
+// because we eval current state by value func on each step.
+// Draws by rule are 0 as well.
 float CheckersState::evaluateGame() const {
   float final_score = 0.0;
 
   if (terminated()) {
-    if (getPly() >= TOTAL_MAX_MOVE)
+    if (drawn())
+      final_score = 0;
+    else if (getPly() >= TOTAL_MAX_MOVE)
       final_score = -1;
     else if (this->currentPlayer() == BLACK_PLAYER)
       final_score = -1;
@@ -70,10 +89,7 @@ bool CheckersState::moves_since(size_t* next_move_number,
     // The move number is not right.
     return false;
   }
-  moves->clear();
-  for (size_t i = *next_move_number; i < _moves.size(); ++i) {
-    moves->push_back(_moves[i]);
-  }
+  *moves = _moves.since(*next_move_number);
   *next_move_number = _moves.size();
   return true;
 }
\ No newline at end of file
@@ -1,22 +1,78 @@
 #pragma once
 
+#include <memory>
+
 // checkers
 #include "CheckersBoard.h"
 #include "CheckersFeature.h"
 
+/*
+  Moves of a game, as a persistent list: a copy shares all the moves of
+  the original and only pushes its own. So copying a state (e.g. for
+  every MCTS node) does not copy the game history, the history is only
+  stored once by the root and rebuilt on demand.
+
+  Each move keeps the hash of the position it leads to, for the
+  repetition rule.
+*/
+class CheckersMoveHistory {
+ public:
+  size_t size() const {
+    return _last ? _last->size : 0;
+  }
+
+  void push_back(Coord c, uint64_t hash) {
+    _last = std::make_shared<const Node>(Node{c, size() + 1, hash, _last});
+  }
+
+  void clear() {
+    _last.reset();
+  }
+
+  // Number of the positions after the last n + 1 moves which are the
+  // position after the last move.
+  int repetitions(size_t n) const {
+    if (!_last)
+      return 0;
+    int count = 0;
+    const Node* node = _last.get();
+    for (size_t i = 0; i <= n && node != nullptr; ++i) {
+      if (node->hash == _last->hash)
+        count++;
+      node = node->prev.get();
+    }
+    return count;
+  }
+
+  // Moves from move number `from` (0-based) to the last one.
+  std::vector<Coord> since(size_t from) const {
+    size_t n = size();
+    std::vector<Coord> moves(n > from ? n - from : 0);
+    const Node* node = _last.get();
+    for (size_t i = moves.size(); i > 0; --i) {
+      moves[i - 1] = node->move;
+      node = node->prev.get();
+    }
+    return moves;
+  }
+
+ private:
+  struct Node {
+    Coord move;
+    size_t size;
+    uint64_t hash;
+    std::shared_ptr<const Node> prev;
+  };
+
+  std::shared_ptr<const Node> _last;
+};
+
 class CheckersState {
  public:
 
   CheckersState() {
     reset();
   }
-  
-  CheckersState(const CheckersState& s)
-      : _history(s._history),
-        _moves(s._moves),
-        _final_value(s._final_value) {
-    CheckersCopyBoard(&_board, &s._board);
-  }
 
   bool forward(const Coord& c);
   bool checkMove(const Coord& c) const;
@@ -33,26 +89,53 @@ class CheckersState {
     return _final_value;
   }
 
-  const CheckersBoard& board() const {
+  // Unpacked board.
+  CheckersBoard board() const {
+    CheckersBoard b;
+    UnpackBoard(_board, &b);
+    return b;
+  }
+
+  const CheckersPackedBoard& packedBoard() const {
     return _board;
   }
 
+  uint64_t hash() const {
+    return _board.hash;
+  }
+
   // Note that ply started from 1.
   bool justStarted() const {
-    return _board._ply == 1;
+    return _board.ply == 1;
   }
 
   // move number
   int getPly() const {
-    return _board._ply;
+    return _board.ply;
+  }
+
+  // Drawn by repetition or by NO_PROGRESS_MAX_MOVE.
+  bool drawn() const {
+    return _repetitions >= REPEAT_POSITION ||
+        _no_progress >= NO_PROGRESS_MAX_MOVE;
+  }
+
+  // Number of times the current position occurred.
+  int repetitions() const {
+    return _repetitions;
+  }
+
+  // Plies since the last capture or pawn move.
+  int noProgressPlies() const {
+    return _no_progress;
   }
 
   bool terminated() const {
-    return CheckersIsOver(_board) || getPly() >= TOTAL_MAX_MOVE ;
+    return getPly() >= TOTAL_MAX_MOVE || drawn() || CheckersIsOver(board());
   }
 
   int lastMove() const {
-    return _board._last_move;
+    return _board.last_move;
   }
 
   int currentPlayer() const {
@@ -60,35 +143,36 @@ class CheckersState {
   }
 
   // Moves history in vector
-  const std::vector<Coord>& getAllMoves() const {
-    return _moves;
+  std::vector<Coord> getAllMoves() const {
+    return _moves.since(0);
   }
 
   // Moves history in string
   std::string getAllMovesString() const {
     std::stringstream ss;
-    for (const Coord& c : _moves) {
+    for (const Coord& c : getAllMoves()) {
       ss << "[" << c << "] ";
     }
     return ss.str();
   }
 
-  // const std::deque<BoardHistory>& getHistory() const {
-  //   return _history;
-  // }
-
   // delete!!!!!!
   std::array<std::array<int, 8>, 8> getBoard() const {
-    return GetTrueObservation(_board);
+    return GetTrueObservation(board());
   }
 
  protected:
-  CheckersBoard _board;
+  CheckersPackedBoard _board;
 
-  // History for our net(dont use now)
-  std::deque<CheckersBoardHistory> _history;
   // history of moves for current board
-  std::vector<Coord> _moves;
+  CheckersMoveHistory _moves;
+
+  // Only the positions since the last capture or pawn move can occur
+  // again, their hashes are in _moves.
+  uint8_t _no_progress = 0;
+  uint8_t _repetitions = 1;
+
+  void updateDrawRules(const CheckersPackedBoard& prev);
 
   float _final_value = 0.0;
 };
@@ -94,10 +94,19 @@ void CheckersStateExt::showFinishInfo() const {
       _seq,
       used_model);
 
-  if (_state.getPly() >= TOTAL_MAX_MOVE) {
+  if (_state.drawn()) {
+    _logger->info(
+      "Draw by {} at {} move(Draw++)",
+      _state.repetitions() >= REPEAT_POSITION ? "repetition" : "no progress",
+      _state.getPly());
+  } else if (_state.getPly() >= TOTAL_MAX_MOVE) {
     _logger->info(
       "Ply: {} exceeds thread_state. Restarting the game(Draw++)", 
       _state.getPly());
+  } else if (!_state.terminated()) {
+    _logger->info("{} won by the tablebase at {} move",
+      _state.getFinalValue() > 0 ? "Black" : "White",
+      _state.getPly());
   } else if (_state.currentPlayer() == WHITE_PLAYER) {
     _logger->info("{}Black{} win at {} move", 
       GREEN_C, 
@@ -135,3 +144,7 @@ void CheckersStateExt::setFinalValue() {
   _state.setFinalValue(final_value);
 }
 
+void CheckersStateExt::setFinalValue(float final_value) {
+  _state.setFinalValue(final_value);
+}
+
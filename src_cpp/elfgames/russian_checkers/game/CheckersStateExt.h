@@ -42,6 +42,8 @@ struct CheckersStateExt {
   const CheckersGameOptions& gameOptions() const;
   void saveCurrentTree(const std::string& tree_info) const;
   void setFinalValue();
+  // Result of a game stopped before its end, for black.
+  void setFinalValue(float final_value);
 
   // packing the result of the game in json for sending to the server
   CheckersRecord dumpRecord() const {
@@ -58,6 +60,7 @@ struct CheckersStateExt {
         std::vector<int64_t>(_using_models.begin(), _using_models.end());
     r.result.policies = _mcts_policies;
     r.result.num_move = _state.getPly() - 1;
+    r.result.draw = _state.getPly() >= TOTAL_MAX_MOVE || _state.drawn();
     r.result.values = _predicted_values;
 
     // std::cout << "GoStateExtOffline::dumpRecord" << std::endl;
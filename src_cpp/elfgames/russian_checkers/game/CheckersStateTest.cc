@@ -0,0 +1,208 @@
+#include "CheckersState.h"
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+bool sameBoard(const CheckersBoard& b1, const CheckersBoard& b2) {
+  return memcmp(b1.board, b2.board, sizeof(b1.board)) == 0 &&
+      b1.current_player == b2.current_player &&
+      b1.next_bit_y == b2.next_bit_y && b1.next_bit_x == b2.next_bit_x &&
+      b1._ply == b2._ply && b1._last_move == b2._last_move;
+}
+
+// Random legal move, M_INVALID if there is none.
+Coord randomMove(const CheckersBoard& board, std::mt19937* rng) {
+  auto valid = GetValidMovesBinary(board);
+  std::vector<Coord> legal;
+  for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+    if (valid[c])
+      legal.push_back(c);
+  }
+  return legal.empty() ? M_INVALID : legal[(*rng)() % legal.size()];
+}
+
+// Same pieces, same player to move and same pending jump.
+bool samePosition(const CheckersBoard& b1, const CheckersBoard& b2) {
+  return memcmp(b1.board, b2.board, sizeof(b1.board)) == 0 &&
+      b1.current_player == b2.current_player &&
+      b1.next_bit_y == b2.next_bit_y && b1.next_bit_x == b2.next_bit_x;
+}
+
+// A pawn moved or a piece was captured.
+bool progress(const CheckersBoard& before, const CheckersBoard& after) {
+  int pieces_before = 0;
+  int pieces_after = 0;
+  for (int y = 0; y < CHECKERS_BOARD_SIZE; ++y) {
+    for (int x = 0; x < CHECKERS_BOARD_SIZE; ++x) {
+      bool pawn_before = std::abs(before.board[y][x]) == WHITE_PAWN;
+      bool pawn_after = std::abs(after.board[y][x]) == WHITE_PAWN;
+      if (pawn_before != pawn_after ||
+          (pawn_before && before.board[y][x] != after.board[y][x]))
+        return true;
+      pieces_before += before.board[y][x] != 0;
+      pieces_after += after.board[y][x] != 0;
+    }
+  }
+  return pieces_before != pieces_after;
+}
+
+// Cells where GetObservation(board, player) is piece, as 0/1 floats.
+void observationPlane(
+    const CheckersBoard& board,
+    int player,
+    int piece,
+    float* data) {
+  auto observation = GetObservation(board, player);
+  for (int y = 0; y < CHECKERS_BOARD_SIZE; ++y) {
+    for (int x = 0; x < CHECKERS_BOARD_SIZE; ++x) {
+      data[y * CHECKERS_BOARD_SIZE + x] = observation[y][x] == piece ? 1 : 0;
+    }
+  }
+}
+
+} // namespace
+
+// The packed board of the state follows the full board move by move.
+TEST(CheckersStateTest, packedBoard) {
+  std::mt19937 rng(0);
+  for (int game = 0; game < 20; ++game) {
+    CheckersState state;
+    CheckersBoard board;
+    ClearBoard(&board);
+
+    while (!state.terminated()) {
+      Coord c = randomMove(board, &rng);
+      ASSERT_NE(M_INVALID, c);
+      ASSERT_TRUE(state.forward(c));
+      CheckersPlay(&board, c);
+      ASSERT_TRUE(sameBoard(board, state.board()));
+
+      CheckersPackedBoard packed;
+      PackBoard(board, &packed);
+      EXPECT_TRUE(SamePosition(packed, state.packedBoard()));
+    }
+  }
+}
+
+TEST(CheckersStateTest, hash) {
+  CheckersState s1, s2;
+  EXPECT_EQ(s1.hash(), s2.hash());
+
+  // Same moves, same position.
+  std::vector<Coord> moves;
+  std::mt19937 rng(1);
+  for (int i = 0; i < 4; ++i) {
+    Coord c = randomMove(s1.board(), &rng);
+    s1.forward(c);
+    moves.push_back(c);
+  }
+  EXPECT_NE(s1.hash(), s2.hash());
+  for (Coord c : moves) {
+    s2.forward(c);
+  }
+  EXPECT_EQ(s1.hash(), s2.hash());
+  EXPECT_TRUE(SamePosition(s1.packedBoard(), s2.packedBoard()));
+}
+
+// Draw rules follow the full boards of random games.
+TEST(CheckersStateTest, drawRules) {
+  std::mt19937 rng(4);
+  int draws = 0;
+  for (int game = 0; game < 50; ++game) {
+    CheckersState state;
+    std::vector<CheckersBoard> since_progress = {state.board()};
+
+    while (!state.terminated()) {
+      CheckersBoard before = state.board();
+      ASSERT_TRUE(state.forward(randomMove(before, &rng)));
+      CheckersBoard board = state.board();
+      if (progress(before, board))
+        since_progress.clear();
+      since_progress.push_back(board);
+
+      int repetitions = std::count_if(
+          since_progress.begin(),
+          since_progress.end(),
+          [&](const CheckersBoard& b) { return samePosition(b, board); });
+      ASSERT_EQ(repetitions, state.repetitions());
+      ASSERT_EQ((int)since_progress.size() - 1, state.noProgressPlies());
+      ASSERT_EQ(
+          repetitions >= REPEAT_POSITION ||
+              (int)since_progress.size() > NO_PROGRESS_MAX_MOVE,
+          state.drawn());
+    }
+    if (state.drawn()) {
+      draws++;
+      EXPECT_EQ(0.0, state.evaluateGame());
+    }
+  }
+  EXPECT_GT(draws, 0);
+}
+
+// Copies share the moves played before the copy, but not after.
+TEST(CheckersStateTest, movesHistory) {
+  std::mt19937 rng(2);
+  CheckersState root;
+  std::vector<Coord> played;
+  for (int i = 0; i < 10; ++i) {
+    Coord c = randomMove(root.board(), &rng);
+    root.forward(c);
+    played.push_back(c);
+  }
+
+  CheckersState child = root;
+  Coord c = randomMove(child.board(), &rng);
+  child.forward(c);
+
+  EXPECT_EQ(played, root.getAllMoves());
+  played.push_back(c);
+  EXPECT_EQ(played, child.getAllMoves());
+
+  size_t next_move_number = 8;
+  std::vector<Coord> moves;
+  EXPECT_TRUE(child.moves_since(&next_move_number, &moves));
+  EXPECT_EQ(std::vector<Coord>(played.begin() + 8, played.end()), moves);
+  EXPECT_EQ(11u, next_move_number);
+
+  EXPECT_TRUE(root.moves_since(&next_move_number, &moves) == false);
+}
+
+// Planes built from the packed board are the GetObservation() ones.
+TEST(CheckersStateTest, features) {
+  const int kRegion = CHECKERS_BOARD_SIZE * CHECKERS_BOARD_SIZE;
+  std::mt19937 rng(3);
+  for (int game = 0; game < 10; ++game) {
+    CheckersState state;
+
+    while (!state.terminated()) {
+      CheckersBoard board = state.board();
+      int active = board.current_player;
+      int passive = active == WHITE_PLAYER ? BLACK_PLAYER : WHITE_PLAYER;
+
+      std::vector<float> expected(CHECKERS_NUM_FEATURES * kRegion, 0.0);
+      observationPlane(board, active, 1, &expected[0 * kRegion]);
+      observationPlane(board, active, 3, &expected[1 * kRegion]);
+      observationPlane(board, passive, 1, &expected[2 * kRegion]);
+      observationPlane(board, passive, 3, &expected[3 * kRegion]);
+      int indicator = active == BLACK_PLAYER ? 4 : 5;
+      std::fill_n(&expected[indicator * kRegion], kRegion, 1.0);
+
+      // Stale values in the slot must be overwritten.
+      std::vector<float> features(expected.size(), -1.0);
+      CheckersFeature(state).extract(features.data());
+      ASSERT_EQ(expected, features);
+
+      Coord c = randomMove(board, &rng);
+      ASSERT_NE(M_INVALID, c);
+      state.forward(c);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
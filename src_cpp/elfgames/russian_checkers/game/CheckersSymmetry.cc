@@ -0,0 +1,45 @@
+#include "CheckersSymmetry.h"
+
+namespace {
+
+// Action of every move turned by 180 degrees.
+struct FlipTable {
+  Coord action[TOTAL_NUM_ACTIONS];
+
+  FlipTable() {
+    std::map<std::pair<int, int>, Coord> index;
+    for (const auto& a : moves::i_to_m) {
+      index[{a.second[0], a.second[1]}] = a.first;
+    }
+    for (const auto& a : moves::i_to_m) {
+      action[a.first] = index.at({63 - a.second[0], 63 - a.second[1]});
+    }
+  }
+};
+
+const FlipTable& flipTable() {
+  static const FlipTable table;
+  return table;
+}
+
+} // namespace
+
+
+Coord CheckersAugmentAction(Coord action, int aug_code) {
+  if (aug_code != CHECKERS_AUG_FLIP_COLORS || action >= TOTAL_NUM_ACTIONS)
+    return action;
+  return flipTable().action[action];
+}
+
+
+bool CheckersCanFlipColors(int num_move) {
+  // Ply starts from 1.
+  return num_move + 1 < TOTAL_MAX_MOVE;
+}
+
+
+int CheckersRandomAugCode(int num_move, std::mt19937* rng) {
+  if (!CheckersCanFlipColors(num_move))
+    return CHECKERS_AUG_IDENTITY;
+  return (*rng)() % CHECKERS_NUM_AUG_CODES;
+}
@@ -0,0 +1,123 @@
+#include "CheckersSymmetry.h"
+#include "CheckersPosition.h"
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+uint32_t reverse32(uint32_t m) {
+  uint32_t r = 0;
+  for (int i = 0; i < 32; ++i) {
+    if (m & (1u << i))
+      r |= 1u << (31 - i);
+  }
+  return r;
+}
+
+// The board turned by 180 degrees with the colours swapped.
+CheckersBoard flipColors(const CheckersBoard& board) {
+  CheckersPackedBoard packed;
+  PackBoard(board, &packed);
+
+  CheckersPackedBoard flipped = packed;
+  for (int color = 0; color < 2; ++color) {
+    flipped.pawns[color] = reverse32(packed.pawns[1 - color]);
+    flipped.kings[color] = reverse32(packed.kings[1 - color]);
+  }
+  flipped.current_player = -packed.current_player;
+  if (packed.next_bit != -1)
+    flipped.next_bit = 31 - packed.next_bit;
+
+  CheckersBoard res;
+  UnpackBoard(flipped, &res);
+  return res;
+}
+
+} // namespace
+
+// Legal actions, game end and feature planes agree with the flipped board.
+TEST(CheckersSymmetryTest, flipColors) {
+  std::mt19937 rng(0);
+  for (int game = 0; game < 20; ++game) {
+    CheckersBoard board;
+    ClearBoard(&board);
+
+    while (board._ply < TOTAL_MAX_MOVE) {
+      CheckersBoard flipped = flipColors(board);
+      auto valid = GetValidMovesBinary(board);
+      auto flipped_valid = GetValidMovesBinary(flipped);
+      std::vector<Coord> legal;
+      for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+        Coord f = CheckersAugmentAction(c, CHECKERS_AUG_FLIP_COLORS);
+        ASSERT_EQ(c, CheckersAugmentAction(f, CHECKERS_AUG_FLIP_COLORS));
+        ASSERT_EQ(valid[c], flipped_valid[f]) << "action " << c;
+        if (valid[c])
+          legal.push_back(c);
+      }
+
+      CheckersPackedBoard packed, flipped_packed;
+      PackBoard(board, &packed);
+      PackBoard(flipped, &flipped_packed);
+      ASSERT_EQ(GetObservationMasks(packed), GetObservationMasks(flipped_packed));
+
+      if (legal.empty())
+        break;
+      CheckersPlay(&board, legal[rng() % legal.size()]);
+    }
+  }
+}
+
+TEST(CheckersSymmetryTest, augmentSample) {
+  CheckersTrainSample sample;
+  sample.position.planes = {1, 2, 3, 4};
+  sample.position.current_player = BLACK_PLAYER;
+  sample.position.predicted_value = 0.5;
+  sample.position.has_policy = true;
+  sample.position.policy_scale = 0.25;
+  sample.position.policy.fill(0);
+  sample.position.policy[0] = 3;
+  sample.position.policy[1] = 1;
+  sample.played_move = 0;
+  sample.future_moves = {0, 1};
+  sample.winner = 1.0;
+
+  CheckersTrainSample flipped = sample;
+  flipped.augment(CHECKERS_AUG_FLIP_COLORS);
+  EXPECT_EQ(CHECKERS_AUG_FLIP_COLORS, flipped.aug_code);
+  EXPECT_EQ(sample.position.planes, flipped.position.planes);
+  EXPECT_EQ(WHITE_PLAYER, flipped.position.current_player);
+  EXPECT_EQ(-0.5, flipped.position.predicted_value);
+  EXPECT_EQ(-1.0, flipped.winner);
+
+  Coord f0 = CheckersAugmentAction(0, CHECKERS_AUG_FLIP_COLORS);
+  Coord f1 = CheckersAugmentAction(1, CHECKERS_AUG_FLIP_COLORS);
+  EXPECT_EQ(3, flipped.position.policy[f0]);
+  EXPECT_EQ(1, flipped.position.policy[f1]);
+  EXPECT_EQ(f0, flipped.played_move);
+  EXPECT_EQ(std::vector<Coord>({f0, f1}), flipped.future_moves);
+
+  // Flipping twice gives the sample back.
+  flipped.augment(CHECKERS_AUG_FLIP_COLORS);
+  EXPECT_EQ(sample.position.policy, flipped.position.policy);
+  EXPECT_EQ(sample.future_moves, flipped.future_moves);
+  EXPECT_EQ(sample.winner, flipped.winner);
+  EXPECT_EQ(sample.position.current_player, flipped.position.current_player);
+}
+
+TEST(CheckersSymmetryTest, randomAugCode) {
+  std::mt19937 rng(1);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(
+        CHECKERS_AUG_IDENTITY,
+        CheckersRandomAugCode(TOTAL_MAX_MOVE - 1, &rng));
+    int code = CheckersRandomAugCode(40, &rng);
+    EXPECT_TRUE(code >= 0 && code < CHECKERS_NUM_AUG_CODES);
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,749 @@
+#include "CheckersTablebase.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include "elf/utils/bitplanes.h"
+
+namespace {
+
+const char kMagic[8] = "RCKTB02";
+
+struct FileHeader {
+  char magic[8];
+  uint32_t max_pieces;
+  uint32_t num_tables;
+};
+
+// Pawns are crowned on the last row, so black pawns never stand on row
+// 0 and white pawns never on row 7.
+constexpr uint32_t kPawnSquares[2] = {0xfffffff0u, 0x0fffffffu};
+constexpr int kNumPawnSquares = 28;
+
+// Build-time marker of indices with overlapping pawns.
+constexpr uint8_t kInvalid = 0xff;
+constexpr int kMaxPlies = 255;
+// Plies to the next capture or pawn move of a position that cannot make
+// one before NO_PROGRESS_MAX_MOVE.
+constexpr int kNoZeroing = NO_PROGRESS_MAX_MOVE + 1;
+
+struct Binomial {
+  uint64_t c[33][33] = {};
+
+  Binomial() {
+    for (int n = 0; n <= 32; n++) {
+      c[n][0] = 1;
+      for (int k = 1; k <= n; k++)
+        c[n][k] = c[n - 1][k - 1] + c[n - 1][k];
+    }
+  }
+};
+
+uint64_t choose(int n, int k) {
+  static const Binomial binomial;
+  return k < 0 || k > n ? 0 : binomial.c[n][k];
+}
+
+// Mask of the positions of the bits of mask among the bits of allowed.
+uint32_t compress(uint32_t mask, uint32_t allowed) {
+  uint32_t res = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    int sq = __builtin_ctz(mask);
+    res |= 1u << __builtin_popcount(allowed & ((1u << sq) - 1));
+  }
+  return res;
+}
+
+// Inverse of compress().
+uint32_t expand(uint32_t mask, uint32_t allowed) {
+  uint32_t res = 0;
+  int pos = 0;
+  for (; allowed != 0; allowed &= allowed - 1, pos++) {
+    if (mask & (1u << pos))
+      res |= allowed & -allowed;
+  }
+  return res;
+}
+
+// Colex rank of a k-subset.
+uint64_t rankSubset(uint32_t mask) {
+  uint64_t r = 0;
+  for (int i = 1; mask != 0; mask &= mask - 1, i++) {
+    r += choose(__builtin_ctz(mask), i);
+  }
+  return r;
+}
+
+uint32_t unrankSubset(uint64_t r, int k) {
+  uint32_t mask = 0;
+  for (int i = k; i > 0; i--) {
+    int p = i - 1;
+    while (choose(p + 1, i) <= r)
+      p++;
+    mask |= 1u << p;
+    r -= choose(p, i);
+  }
+  return mask;
+}
+
+uint32_t reverse32(uint32_t mask) {
+  return elf_utils::reverse_bits(mask) >> 32;
+}
+
+// Number of pawns and kings of each side, [0] black, [1] white.
+struct Material {
+  int pawns[2];
+  int kings[2];
+
+  static Material of(const CheckersPackedBoard& b) {
+    return {{__builtin_popcount(b.pawns[0]), __builtin_popcount(b.pawns[1])},
+            {__builtin_popcount(b.kings[0]), __builtin_popcount(b.kings[1])}};
+  }
+
+  uint32_t key() const {
+    return pawns[0] | kings[0] << 4 | pawns[1] << 8 | kings[1] << 12;
+  }
+
+  Material swapped() const {
+    return {{pawns[1], pawns[0]}, {kings[1], kings[0]}};
+  }
+
+  int numPieces() const {
+    return pawns[0] + pawns[1] + kings[0] + kings[1];
+  }
+
+  int numPawns() const {
+    return pawns[0] + pawns[1];
+  }
+
+  // Black pawns, white pawns, then black and white kings on the squares
+  // left free.
+  uint64_t size() const {
+    int free = 32 - pawns[0] - pawns[1];
+    return choose(kNumPawnSquares, pawns[0]) *
+        choose(kNumPawnSquares, pawns[1]) * choose(free, kings[0]) *
+        choose(free - kings[0], kings[1]);
+  }
+
+  uint64_t index(const CheckersPackedBoard& b) const {
+    uint32_t pawn_mask = b.pawns[0] | b.pawns[1];
+    uint32_t free = ~pawn_mask;
+    int free_count = 32 - pawns[0] - pawns[1];
+    uint64_t idx = rankSubset(compress(b.pawns[0], kPawnSquares[0]));
+    idx = idx * choose(kNumPawnSquares, pawns[1]) +
+        rankSubset(compress(b.pawns[1], kPawnSquares[1]));
+    idx = idx * choose(free_count, kings[0]) +
+        rankSubset(compress(b.kings[0], free));
+    idx = idx * choose(free_count - kings[0], kings[1]) +
+        rankSubset(compress(b.kings[1], free & ~b.kings[0]));
+    return idx;
+  }
+
+  // Return false if the pawns of index overlap.
+  bool position(uint64_t idx, CheckersPackedBoard* b) const {
+    int free_count = 32 - pawns[0] - pawns[1];
+    uint64_t n_wk = choose(free_count - kings[0], kings[1]);
+    uint64_t n_bk = choose(free_count, kings[0]);
+    uint64_t n_wp = choose(kNumPawnSquares, pawns[1]);
+
+    uint64_t r_wk = idx % n_wk;
+    idx /= n_wk;
+    uint64_t r_bk = idx % n_bk;
+    idx /= n_bk;
+    uint64_t r_wp = idx % n_wp;
+    uint64_t r_bp = idx / n_wp;
+
+    b->pawns[0] = expand(unrankSubset(r_bp, pawns[0]), kPawnSquares[0]);
+    b->pawns[1] = expand(unrankSubset(r_wp, pawns[1]), kPawnSquares[1]);
+    if (b->pawns[0] & b->pawns[1])
+      return false;
+    uint32_t free = ~(b->pawns[0] | b->pawns[1]);
+    b->kings[0] = expand(unrankSubset(r_bk, kings[0]), free);
+    b->kings[1] = expand(unrankSubset(r_wk, kings[1]), free & ~b->kings[0]);
+    return true;
+  }
+};
+
+// The position turned by 180 degrees with the colours swapped.
+CheckersPackedBoard flipColors(const CheckersPackedBoard& b) {
+  CheckersPackedBoard res = b;
+  for (int c = 0; c < 2; c++) {
+    res.pawns[c] = reverse32(b.pawns[1 - c]);
+    res.kings[c] = reverse32(b.kings[1 - c]);
+  }
+  res.current_player = -b.current_player;
+  return res;
+}
+
+// Black to move, no capture in progress.
+CheckersPackedBoard blackToMove() {
+  CheckersPackedBoard b;
+  memset(&b, 0, sizeof(b));
+  b.ply = 1;
+  b.last_move = M_INVALID;
+  b.current_player = BLACK_PLAYER;
+  b.next_bit = -1;
+  b.game_ended = false;
+  return b;
+}
+
+struct BuildTable {
+  Material material;
+  uint64_t size;
+  // Result, plies to the end and plies to the next capture or pawn move,
+  // per position.
+  std::vector<uint8_t> wdl;
+  std::vector<uint8_t> plies;
+  std::vector<uint8_t> dtz;
+  int max_plies = 0;
+  bool solved = false;
+};
+
+// Children results of a position, from the side of the player to move.
+// The winner takes the shortest way to the next capture or pawn move, the
+// loser the longest.
+struct Outcome {
+  int num_children = 0;
+  bool unknown = false;
+  bool all_win = true;
+  bool win = false;
+  int win_plies = kMaxPlies;
+  int loss_plies = 0;
+  int win_dtz = kNoZeroing;
+  int loss_dtz = 0;
+
+  // progress: the move captures or moves a pawn, which resets the count
+  // of NO_PROGRESS_MAX_MOVE from the child on.
+  void add(int child_wdl, int plies, int child_dtz, bool progress) {
+    num_children++;
+    plies = std::min(plies, kMaxPlies);
+    int dtz = progress ? (child_dtz < kNoZeroing ? 1 : kNoZeroing)
+                       : std::min(1 + child_dtz, kNoZeroing);
+    if (child_wdl == CHECKERS_WDL_LOSS) {
+      win = true;
+      win_plies = std::min(win_plies, plies);
+      win_dtz = std::min(win_dtz, dtz);
+    } else if (child_wdl == CHECKERS_WDL_WIN) {
+      loss_plies = std::max(loss_plies, plies);
+      loss_dtz = std::max(loss_dtz, dtz);
+    } else {
+      all_win = false;
+      if (child_wdl == CHECKERS_WDL_UNKNOWN)
+        unknown = true;
+    }
+  }
+
+  void result(uint8_t* wdl, uint8_t* plies, uint8_t* dtz) const {
+    *dtz = 0;
+    if (num_children == 0) {
+      *wdl = CHECKERS_WDL_LOSS;
+      *plies = 0;
+    } else if (win) {
+      *wdl = CHECKERS_WDL_WIN;
+      *plies = win_plies;
+      *dtz = win_dtz;
+    } else if (unknown) {
+      *wdl = CHECKERS_WDL_UNKNOWN;
+      *plies = 0;
+    } else if (all_win) {
+      *wdl = CHECKERS_WDL_LOSS;
+      *plies = loss_plies;
+      *dtz = loss_dtz;
+    } else {
+      *wdl = CHECKERS_WDL_DRAW;
+      *plies = 0;
+    }
+  }
+};
+
+/*
+  Retrograde-free solver: the tables of a material and of its colour
+  swap (the ones reached by quiet moves) are evaluated from their
+  children until nothing changes, everything left undecided is a draw.
+  Captures and crowning lead to materials solved before.
+
+  The plies to the next capture or pawn move of the decided positions are
+  then evaluated the same way. Those which cannot make one before
+  NO_PROGRESS_MAX_MOVE, or lead to a position which cannot, are drawn by
+  the rule and stored as draws.
+*/
+class Builder {
+ public:
+  Builder(int max_pieces, int max_pawns, int num_threads)
+      : max_pieces_(max_pieces),
+        num_threads_(std::max(num_threads, 1)),
+        table_of_(1 << 16, -1),
+        logger_(elf::logging::getIndexedLogger(
+            MAGENTA_B + std::string("|++|") + COLOR_END +
+                "CheckersTablebaseBuilder-",
+            "")) {
+    for (int n = 2; n <= max_pieces_; n++) {
+      for (int bp = 0; bp <= n; bp++) {
+        for (int bk = 0; bp + bk <= n; bk++) {
+          for (int wp = 0; bp + bk + wp <= n; wp++) {
+            int wk = n - bp - bk - wp;
+            if (bp + bk == 0 || wp + wk == 0 || bp + wp > max_pawns)
+              continue;
+            BuildTable t;
+            t.material = {{bp, wp}, {bk, wk}};
+            t.size = t.material.size();
+            tables_.push_back(std::move(t));
+          }
+        }
+      }
+    }
+    // Captures remove pieces and crowning removes pawns, so children
+    // come first.
+    std::stable_sort(
+        tables_.begin(),
+        tables_.end(),
+        [](const BuildTable& t1, const BuildTable& t2) {
+          return std::make_pair(t1.material.numPieces(), t1.material.numPawns())
+              < std::make_pair(t2.material.numPieces(), t2.material.numPawns());
+        });
+    for (size_t i = 0; i < tables_.size(); i++) {
+      table_of_[tables_[i].material.key()] = i;
+    }
+  }
+
+  bool run(const std::string& path) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < tables_.size(); i++) {
+      if (tables_[i].solved)
+        continue;
+      int j = table_of_[tables_[i].material.swapped().key()];
+      solve(i, j);
+      total += tables_[i].size + (j != (int)i ? tables_[j].size : 0);
+    }
+    logger_->info(
+        "Solved {} tables, {} positions", tables_.size(), total);
+    return write(path);
+  }
+
+ private:
+  int max_pieces_;
+  int num_threads_;
+  std::vector<int> table_of_;
+  std::vector<BuildTable> tables_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  // Result of a position reached after a move, with the opponent to move.
+  void lookup(const CheckersPackedBoard& b, int* wdl, int* plies, int* dtz)
+      const {
+    CheckersPackedBoard child =
+        b.current_player == WHITE_PLAYER ? flipColors(b) : b;
+    if ((child.pawns[0] | child.kings[0]) == 0) {
+      *wdl = CHECKERS_WDL_LOSS;
+      *plies = 0;
+      *dtz = 0;
+      return;
+    }
+    Material m = Material::of(child);
+    const BuildTable& t = tables_[table_of_[m.key()]];
+    uint64_t idx = m.index(child);
+    *wdl = t.wdl[idx];
+    *plies = t.plies[idx];
+    *dtz = t.dtz[idx];
+  }
+
+  // Add the positions reached by every move from root, following captures
+  // to the end since the same player keeps moving.
+  void expand(
+      const CheckersPackedBoard& root,
+      const CheckersBoard& board,
+      int plies,
+      Outcome* outcome) const {
+    std::array<int, TOTAL_NUM_ACTIONS> valid = GetValidMovesBinary(board);
+    for (Coord a = 0; a < TOTAL_NUM_ACTIONS; a++) {
+      if (!valid[a])
+        continue;
+      CheckersBoard child = board;
+      CheckersPlay(&child, a);
+      if (child.current_player == board.current_player) {
+        expand(root, child, plies + 1, outcome);
+        continue;
+      }
+      CheckersPackedBoard packed;
+      PackBoard(child, &packed);
+      int wdl, child_plies, child_dtz;
+      lookup(packed, &wdl, &child_plies, &child_dtz);
+      // Same test as CheckersState::updateDrawRules().
+      bool progress = packed.pawns[0] != root.pawns[0] ||
+          packed.pawns[1] != root.pawns[1] ||
+          __builtin_popcount(packed.kings[0] | packed.kings[1]) !=
+              __builtin_popcount(root.kings[0] | root.kings[1]);
+      outcome->add(wdl, plies + 1 + child_plies, child_dtz, progress);
+    }
+  }
+
+  void evaluate(
+      const Material& m,
+      uint64_t idx,
+      uint8_t* wdl,
+      uint8_t* plies,
+      uint8_t* dtz) const {
+    CheckersPackedBoard b = blackToMove();
+    m.position(idx, &b);
+    CheckersBoard board;
+    UnpackBoard(b, &board);
+
+    Outcome outcome;
+    expand(b, board, 0, &outcome);
+    outcome.result(wdl, plies, dtz);
+  }
+
+  // Call fn on every index of a table of the given size, with all the
+  // threads. Return the number of calls which returned true.
+  template <typename F>
+  uint64_t parallelCount(uint64_t size, F fn) const {
+    const uint64_t kChunk = 4096;
+    std::atomic<uint64_t> next(0);
+    std::atomic<uint64_t> count(0);
+
+    auto worker = [&]() {
+      uint64_t n = 0;
+      while (true) {
+        uint64_t begin = next.fetch_add(kChunk);
+        if (begin >= size)
+          break;
+        uint64_t end = std::min(begin + kChunk, size);
+        for (uint64_t i = begin; i < end; i++) {
+          if (fn(i))
+            n++;
+        }
+      }
+      count += n;
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads_; i++) {
+      threads.emplace_back(worker);
+    }
+    for (auto& th : threads) {
+      th.join();
+    }
+    return count.load();
+  }
+
+  // Evaluate all undecided positions of table t once. Return the number
+  // of positions decided.
+  uint64_t iterate(BuildTable* t, std::vector<uint8_t>* wdl,
+      std::vector<uint8_t>* plies) const {
+    return parallelCount(t->size, [&](uint64_t i) {
+      if (t->wdl[i] != CHECKERS_WDL_UNKNOWN)
+        return false;
+      uint8_t dtz;
+      evaluate(t->material, i, &(*wdl)[i], &(*plies)[i], &dtz);
+      return (*wdl)[i] != CHECKERS_WDL_UNKNOWN;
+    });
+  }
+
+  // Evaluate the plies to the next capture or pawn move of all decided
+  // positions of table t once. Return the number of positions changed.
+  uint64_t iterateZeroing(BuildTable* t, std::vector<uint8_t>* dtz) const {
+    return parallelCount(t->size, [&](uint64_t i) {
+      if (t->wdl[i] != CHECKERS_WDL_WIN && t->wdl[i] != CHECKERS_WDL_LOSS)
+        return false;
+      uint8_t wdl, plies;
+      evaluate(t->material, i, &wdl, &plies, &(*dtz)[i]);
+      return (*dtz)[i] != t->dtz[i];
+    });
+  }
+
+  void solve(int i, int j) {
+    std::vector<BuildTable*> pair = {&tables_[i]};
+    if (j != i)
+      pair.push_back(&tables_[j]);
+
+    for (BuildTable* t : pair) {
+      t->wdl.assign(t->size, CHECKERS_WDL_UNKNOWN);
+      t->plies.assign(t->size, 0);
+      t->dtz.assign(t->size, kNoZeroing);
+      CheckersPackedBoard b = blackToMove();
+      for (uint64_t idx = 0; idx < t->size; idx++) {
+        if (!t->material.position(idx, &b))
+          t->wdl[idx] = kInvalid;
+      }
+    }
+
+    // Both tables read the previous values of each other, so each pass
+    // writes into a copy.
+    int passes = 0;
+    while (true) {
+      uint64_t decided = 0;
+      std::vector<std::vector<uint8_t>> wdl, plies;
+      for (BuildTable* t : pair) {
+        wdl.push_back(t->wdl);
+        plies.push_back(t->plies);
+      }
+      for (size_t k = 0; k < pair.size(); k++) {
+        decided += iterate(pair[k], &wdl[k], &plies[k]);
+      }
+      for (size_t k = 0; k < pair.size(); k++) {
+        pair[k]->wdl.swap(wdl[k]);
+        pair[k]->plies.swap(plies[k]);
+      }
+      passes++;
+      if (decided == 0)
+        break;
+    }
+    for (BuildTable* t : pair) {
+      for (uint8_t& v : t->wdl) {
+        if (v == CHECKERS_WDL_UNKNOWN)
+          v = CHECKERS_WDL_DRAW;
+      }
+    }
+
+    // The plies to the next capture or pawn move only decrease from
+    // kNoZeroing, and are settled the same way.
+    int zeroing_passes = 0;
+    while (true) {
+      uint64_t changed = 0;
+      std::vector<std::vector<uint8_t>> dtz;
+      for (BuildTable* t : pair) {
+        dtz.push_back(t->dtz);
+      }
+      for (size_t k = 0; k < pair.size(); k++) {
+        changed += iterateZeroing(pair[k], &dtz[k]);
+      }
+      for (size_t k = 0; k < pair.size(); k++) {
+        pair[k]->dtz.swap(dtz[k]);
+      }
+      zeroing_passes++;
+      if (changed == 0)
+        break;
+    }
+
+    for (BuildTable* t : pair) {
+      uint64_t count[4] = {0, 0, 0, 0};
+      uint64_t no_progress = 0;
+      for (uint64_t idx = 0; idx < t->size; idx++) {
+        uint8_t& v = t->wdl[idx];
+        if (v == kInvalid)
+          continue;
+        if (v != CHECKERS_WDL_DRAW && t->dtz[idx] >= kNoZeroing) {
+          v = CHECKERS_WDL_DRAW;
+          no_progress++;
+        }
+        if (v == CHECKERS_WDL_DRAW)
+          t->dtz[idx] = 0;
+        else
+          t->max_plies = std::max<int>(t->max_plies, t->plies[idx]);
+        count[v]++;
+      }
+      t->solved = true;
+      const Material& m = t->material;
+      logger_->info(
+          "Material B {}p{}k W {}p{}k: {} positions, {}+{} passes, "
+          "win {} draw {} ({} by no progress) loss {}, max plies {}",
+          m.pawns[0], m.kings[0], m.pawns[1], m.kings[1],
+          t->size, passes, zeroing_passes,
+          count[CHECKERS_WDL_WIN], count[CHECKERS_WDL_DRAW], no_progress,
+          count[CHECKERS_WDL_LOSS], t->max_plies);
+    }
+  }
+
+  bool write(const std::string& path) {
+    std::ofstream oo(path, std::ios::binary | std::ios::trunc);
+    if (!oo) {
+      logger_->error("Cannot write {}", path);
+      return false;
+    }
+
+    FileHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.max_pieces = max_pieces_;
+    header.num_tables = tables_.size();
+
+    // Data of each table follows the headers, a byte per position: the
+    // result in the 2 low bits, the plies to the next capture or pawn move
+    // above.
+    CheckersTablebase::Table info;
+    uint64_t offset = sizeof(header) + tables_.size() * sizeof(info);
+
+    oo.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const BuildTable& t : tables_) {
+      info.material = t.material.key();
+      info.max_plies = t.max_plies;
+      info.offset = offset;
+      info.size = t.size;
+      oo.write(reinterpret_cast<const char*>(&info), sizeof(info));
+      offset += t.size;
+    }
+    for (const BuildTable& t : tables_) {
+      std::vector<uint8_t> packed(t.size, 0);
+      for (uint64_t idx = 0; idx < t.size; idx++) {
+        if (t.wdl[idx] != kInvalid)
+          packed[idx] = t.wdl[idx] | t.dtz[idx] << 2;
+      }
+      oo.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+    }
+    oo.close();
+    if (!oo) {
+      logger_->error("Cannot write {}", path);
+      return false;
+    }
+    logger_->info("Wrote {} ({} bytes)", path, offset);
+    return true;
+  }
+};
+
+} // namespace
+
+
+CheckersTablebase::CheckersTablebase()
+    : logger_(elf::logging::getIndexedLogger(
+          MAGENTA_B + std::string("|++|") + COLOR_END + "CheckersTablebase-",
+          "")) {
+}
+
+CheckersTablebase::~CheckersTablebase() {
+  unload();
+}
+
+void CheckersTablebase::unload() {
+  if (data_ != nullptr)
+    ::munmap(data_, bytes_);
+  data_ = nullptr;
+  bytes_ = 0;
+  max_pieces_ = 0;
+  table_of_.clear();
+  tables_.clear();
+}
+
+bool CheckersTablebase::load(const std::string& path) {
+  unload();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    logger_->error("Cannot open {}: {}", path, strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+    logger_->error("Cannot read {}", path);
+    ::close(fd);
+    return false;
+  }
+  void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    logger_->error("Cannot map {}: {}", path, strerror(errno));
+    return false;
+  }
+  data_ = addr;
+  bytes_ = st.st_size;
+
+  const char* base = static_cast<const char*>(data_);
+  FileHeader header;
+  memcpy(&header, base, sizeof(header));
+  size_t tables_end = sizeof(header) + header.num_tables * sizeof(Table);
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      tables_end > bytes_) {
+    logger_->error("{} is not a russian checkers tablebase", path);
+    unload();
+    return false;
+  }
+
+  tables_.resize(header.num_tables);
+  memcpy(tables_.data(), base + sizeof(header), tables_.size() * sizeof(Table));
+  table_of_.assign(1 << 16, -1);
+  for (size_t i = 0; i < tables_.size(); i++) {
+    const Table& t = tables_[i];
+    if (t.material >= table_of_.size() || t.offset + t.size > bytes_) {
+      logger_->error("{} is truncated", path);
+      unload();
+      return false;
+    }
+    table_of_[t.material] = i;
+  }
+  max_pieces_ = header.max_pieces;
+
+  logger_->info(
+      "Loaded {}: {} tables, up to {} pieces",
+      path, tables_.size(), max_pieces_);
+  return true;
+}
+
+bool CheckersTablebase::probe(
+    const CheckersPackedBoard& board,
+    CheckersTablebaseResult* res) const {
+  if (data_ == nullptr || board.next_bit != -1)
+    return false;
+
+  const CheckersPackedBoard b =
+      board.current_player == WHITE_PLAYER ? flipColors(board) : board;
+  Material m = Material::of(b);
+  if (m.numPieces() > max_pieces_)
+    return false;
+  int t = table_of_[m.key()];
+  if (t < 0)
+    return false;
+
+  const Table& table = tables_[t];
+  uint64_t idx = m.index(b);
+  const uint8_t* bytes = static_cast<const uint8_t*>(data_) + table.offset;
+  int wdl = bytes[idx] & 3;
+  if (wdl == CHECKERS_WDL_UNKNOWN)
+    return false;
+
+  res->wdl = wdl;
+  res->max_plies = table.max_plies;
+  res->dtz = bytes[idx] >> 2;
+  return true;
+}
+
+bool CheckersTablebase::probeValue(
+    const CheckersPackedBoard& board,
+    int no_progress_plies,
+    float* value) const {
+  CheckersTablebaseResult res;
+  if (!probe(board, &res))
+    return false;
+  if (res.wdl == CHECKERS_WDL_DRAW) {
+    *value = 0.0;
+    return true;
+  }
+  return probeWin(board, no_progress_plies, value);
+}
+
+bool CheckersTablebase::probeWin(
+    const CheckersPackedBoard& board,
+    int no_progress_plies,
+    float* value) const {
+  CheckersTablebaseResult res;
+  if (!probe(board, &res) || res.wdl == CHECKERS_WDL_DRAW)
+    return false;
+
+  // The table counts the plies without progress from the next capture or
+  // pawn move on; until then, no_progress_plies are already played.
+  if (res.dtz > NO_PROGRESS_MAX_MOVE - no_progress_plies)
+    return false;
+  bool black_wins = board.current_player == BLACK_PLAYER
+      ? res.wdl == CHECKERS_WDL_WIN
+      : res.wdl == CHECKERS_WDL_LOSS;
+  if (black_wins && board.ply + res.max_plies >= TOTAL_MAX_MOVE)
+    return false;
+  *value = black_wins ? 1.0 : -1.0;
+  return true;
+}
+
+bool CheckersTablebase::generate(
+    const std::string& path,
+    int max_pieces,
+    int num_threads,
+    int max_pawns) {
+  if (max_pieces < 2 || max_pieces > 8 || max_pawns < 0)
+    return false;
+  Builder builder(max_pieces, max_pawns, num_threads);
+  return builder.run(path);
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// elf
+#include "elf/logging/IndexedLoggerFactory.h"
+// checkers
+#include "CheckersBoard.h"
+
+/*
+  Win/draw/loss endgame tablebase for positions with few pieces.
+
+  There is one table per material (number of pawns and kings of each
+  side), holding a byte per position with black to move; positions with
+  white to move are looked up turned by 180 degrees with the colours
+  swapped. Pieces are indexed by dark square (y * 4 + x / 2), see
+  CheckersPackedBoard.
+
+  Values are those of a game with the NO_PROGRESS_MAX_MOVE draw rule, from
+  a position just after a capture or a pawn move, but without move limit
+  nor repetitions, "draw" meaning neither side can force a win. Each
+  decided position keeps the number of plies to the next capture or pawn
+  move on the way, so a caller can tell whether it comes before the rule
+  draws the game. Every table also keeps the number of plies in which its
+  decided positions are won, for TOTAL_MAX_MOVE.
+
+  The file is memory-mapped read-only, so it is shared by every game
+  thread and process using it. It is built with GenerateTablebase.
+*/
+
+// Result for the player to move.
+#define CHECKERS_WDL_UNKNOWN  0
+#define CHECKERS_WDL_LOSS     1
+#define CHECKERS_WDL_DRAW     2
+#define CHECKERS_WDL_WIN      3
+
+struct CheckersTablebaseResult {
+  int wdl = CHECKERS_WDL_UNKNOWN;
+  // Decided positions of the table end within max_plies plies.
+  int max_plies = 0;
+  // Plies to the next capture or pawn move, the winner hurrying and the
+  // loser delaying it. At most NO_PROGRESS_MAX_MOVE.
+  int dtz = 0;
+};
+
+class CheckersTablebase {
+ public:
+  // Entry of the file per material, followed by the values.
+  struct Table {
+    uint32_t material;
+    uint32_t max_plies;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  CheckersTablebase();
+  ~CheckersTablebase();
+
+  CheckersTablebase(const CheckersTablebase&) = delete;
+  CheckersTablebase& operator=(const CheckersTablebase&) = delete;
+
+  // Map a file written by generate(). Return false if it cannot be used.
+  bool load(const std::string& path);
+
+  bool loaded() const {
+    return data_ != nullptr;
+  }
+
+  int maxPieces() const {
+    return max_pieces_;
+  }
+
+  // Return false if the position is not in the tablebase: too many
+  // pieces, or a capture in progress.
+  bool probe(const CheckersPackedBoard& board, CheckersTablebaseResult* res)
+      const;
+
+  // Value for black, as CheckersState::evaluateGame() scores the end of
+  // the game. Draws are 0, as the draw rules end them. A win is only
+  // known if its next capture or pawn move comes before
+  // NO_PROGRESS_MAX_MOVE plies without progress, no_progress_plies being
+  // already played, and a black win before TOTAL_MAX_MOVE, which is
+  // scored for white.
+  bool probeValue(
+      const CheckersPackedBoard& board,
+      int no_progress_plies,
+      float* value) const;
+
+  // Same for a decided position only: false for draws.
+  bool probeWin(
+      const CheckersPackedBoard& board,
+      int no_progress_plies,
+      float* value) const;
+
+  // Solve every material of at most max_pieces pieces and max_pawns pawns
+  // and write them to path. Each extra piece multiplies the time and size
+  // by about 25: 4 pieces take 6.4 MB and a few CPU minutes, 5 pieces
+  // 150 MB. Captures and crowning never add pawns, so fewer pawns still
+  // make a complete tablebase, e.g. kings only with max_pawns = 0.
+  static bool generate(
+      const std::string& path,
+      int max_pieces,
+      int num_threads,
+      int max_pawns = 8);
+
+ private:
+  void* data_ = nullptr;
+  size_t bytes_ = 0;
+  int max_pieces_ = 0;
+  // Table index of each material, -1 if none.
+  std::vector<int> table_of_;
+  std::vector<Table> tables_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  void unload();
+};
@@ -0,0 +1,319 @@
+#include "CheckersTablebase.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const int kMaxPieces = 3;
+
+class CheckersTablebaseTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    path_ = "/tmp/checkers_tablebase_test_" + std::to_string(getpid());
+    ASSERT_TRUE(CheckersTablebase::generate(path_, kMaxPieces, 4));
+  }
+
+  static void TearDownTestCase() {
+    unlink(path_.c_str());
+  }
+
+  static std::string path_;
+};
+
+std::string CheckersTablebaseTest::path_;
+
+// Tables of kings only, one piece more.
+class CheckersKingsTablebaseTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    path_ = "/tmp/checkers_kings_tablebase_test_" + std::to_string(getpid());
+    ASSERT_TRUE(CheckersTablebase::generate(path_, kMaxPieces + 1, 4, 0));
+  }
+
+  static void TearDownTestCase() {
+    unlink(path_.c_str());
+  }
+
+  static std::string path_;
+};
+
+std::string CheckersKingsTablebaseTest::path_;
+
+// Random position of at most kMaxPieces pieces, no capture in progress.
+CheckersPackedBoard randomPosition(std::mt19937* rng) {
+  CheckersBoard board;
+  ClearBoard(&board);
+  memset(board.board, 0, sizeof(board.board));
+
+  int n = 2 + (*rng)() % (kMaxPieces - 1);
+  for (int i = 0; i < n; ++i) {
+    // One piece of each side, then random ones.
+    int color = i < 2 ? i : (*rng)() % 2;
+    bool king = (*rng)() % 2;
+    int y, x;
+    do {
+      y = (*rng)() % 8;
+      x = (*rng)() % 4 * 2 + (y + 1) % 2;
+    } while (board.board[y][x] != 0 ||
+             (!king && y == (color == 0 ? 0 : 7)));
+    int piece = king ? WHITE_KING : WHITE_PAWN;
+    board.board[y][x] = color == 0 ? -piece : piece;
+  }
+  board.current_player = (*rng)() % 2 ? BLACK_PLAYER : WHITE_PLAYER;
+
+  CheckersPackedBoard packed;
+  PackBoard(board, &packed);
+  return packed;
+}
+
+struct ChildResult {
+  int wdl;
+  // Plies to the next capture or pawn move of the position, through this
+  // child.
+  int dtz;
+};
+
+// Results reached by every move of the player from root, following
+// captures.
+void childResults(
+    const CheckersTablebase& tb,
+    const CheckersPackedBoard& root,
+    const CheckersBoard& board,
+    std::vector<ChildResult>* results) {
+  auto valid = GetValidMovesBinary(board);
+  for (Coord a = 0; a < TOTAL_NUM_ACTIONS; ++a) {
+    if (!valid[a])
+      continue;
+    CheckersBoard child = board;
+    CheckersPlay(&child, a);
+    if (child.current_player == board.current_player) {
+      childResults(tb, root, child, results);
+      continue;
+    }
+
+    CheckersPackedBoard packed;
+    PackBoard(child, &packed);
+    bool progress = packed.pawns[0] != root.pawns[0] ||
+        packed.pawns[1] != root.pawns[1] ||
+        __builtin_popcount(packed.kings[0] | packed.kings[1]) !=
+            __builtin_popcount(root.kings[0] | root.kings[1]);
+    int opponent = child.current_player == BLACK_PLAYER ? 0 : 1;
+    if ((packed.pawns[opponent] | packed.kings[opponent]) == 0) {
+      results->push_back({CHECKERS_WDL_LOSS, 1});
+      continue;
+    }
+    CheckersTablebaseResult res;
+    ASSERT_TRUE(tb.probe(packed, &res));
+    EXPECT_LE(res.dtz, NO_PROGRESS_MAX_MOVE);
+    results->push_back({res.wdl, progress ? 1 : 1 + res.dtz});
+  }
+}
+
+// Position of kings only, black to move.
+CheckersPackedBoard kingsPosition(
+    const std::vector<int>& black,
+    const std::vector<int>& white) {
+  CheckersBoard board;
+  ClearBoard(&board);
+  memset(board.board, 0, sizeof(board.board));
+  // Dark squares, y * 4 + x / 2 as in CheckersPackedBoard.
+  for (int sq : black) {
+    board.board[sq / 4][sq % 4 * 2 + (sq / 4 + 1) % 2] = -WHITE_KING;
+  }
+  for (int sq : white) {
+    board.board[sq / 4][sq % 4 * 2 + (sq / 4 + 1) % 2] = WHITE_KING;
+  }
+  board.current_player = BLACK_PLAYER;
+
+  CheckersPackedBoard packed;
+  PackBoard(board, &packed);
+  return packed;
+}
+
+} // namespace
+
+// Every result follows from the results after each move, the winner
+// making progress as soon as it can and the loser as late as it can,
+// within NO_PROGRESS_MAX_MOVE.
+TEST_F(CheckersTablebaseTest, consistent) {
+  CheckersTablebase tb;
+  ASSERT_TRUE(tb.load(path_));
+  EXPECT_EQ(kMaxPieces, tb.maxPieces());
+
+  std::mt19937 rng(0);
+  int count[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 3000; ++i) {
+    CheckersPackedBoard packed = randomPosition(&rng);
+    CheckersBoard board;
+    UnpackBoard(packed, &board);
+
+    CheckersTablebaseResult res;
+    ASSERT_TRUE(tb.probe(packed, &res));
+    count[res.wdl]++;
+
+    std::vector<ChildResult> results;
+    childResults(tb, packed, board, &results);
+    int win_dtz = NO_PROGRESS_MAX_MOVE + 1;
+    int loss_dtz = 0;
+    bool all_win = true;
+    for (const ChildResult& r : results) {
+      if (r.wdl == CHECKERS_WDL_LOSS) {
+        win_dtz = std::min(win_dtz, r.dtz);
+      }
+      if (r.wdl == CHECKERS_WDL_WIN) {
+        loss_dtz = std::max(loss_dtz, r.dtz);
+      } else {
+        all_win = false;
+      }
+    }
+    int expected = CHECKERS_WDL_DRAW;
+    int expected_dtz = 0;
+    if (win_dtz <= NO_PROGRESS_MAX_MOVE) {
+      expected = CHECKERS_WDL_WIN;
+      expected_dtz = win_dtz;
+    } else if (all_win && loss_dtz <= NO_PROGRESS_MAX_MOVE) {
+      expected = CHECKERS_WDL_LOSS;
+      expected_dtz = loss_dtz;
+    }
+    ASSERT_EQ(expected, res.wdl) << GetTrueObservationStr(board);
+    EXPECT_EQ(expected_dtz, res.dtz) << GetTrueObservationStr(board);
+    if (res.wdl != CHECKERS_WDL_DRAW) {
+      EXPECT_GT(res.max_plies, 0);
+    }
+  }
+  EXPECT_GT(count[CHECKERS_WDL_WIN], 0);
+  EXPECT_GT(count[CHECKERS_WDL_DRAW], 0);
+  EXPECT_GT(count[CHECKERS_WDL_LOSS], 0);
+}
+
+// A king-only win is only trusted while its next capture comes before
+// NO_PROGRESS_MAX_MOVE draws the game.
+TEST_F(CheckersTablebaseTest, noProgressBudget) {
+  CheckersTablebase tb;
+  ASSERT_TRUE(tb.load(path_));
+
+  std::mt19937 rng(2);
+  CheckersPackedBoard packed;
+  CheckersTablebaseResult res;
+  do {
+    packed = randomPosition(&rng);
+    ASSERT_TRUE(tb.probe(packed, &res));
+  } while (packed.pawns[0] != 0 || packed.pawns[1] != 0 ||
+           __builtin_popcount(packed.kings[0] | packed.kings[1]) != 3 ||
+           res.wdl == CHECKERS_WDL_DRAW || res.dtz < 2);
+
+  float expected = (packed.current_player == BLACK_PLAYER) ==
+          (res.wdl == CHECKERS_WDL_WIN)
+      ? 1.0
+      : -1.0;
+  float value = 0.0;
+  for (int plies = 0; plies < NO_PROGRESS_MAX_MOVE; ++plies) {
+    bool in_time = res.dtz <= NO_PROGRESS_MAX_MOVE - plies;
+    EXPECT_EQ(in_time, tb.probeWin(packed, plies, &value)) << plies;
+    EXPECT_EQ(in_time, tb.probeValue(packed, plies, &value)) << plies;
+    if (in_time) {
+      EXPECT_EQ(expected, value);
+    }
+  }
+
+  // Draws stay 0 whatever the count, but are not a result.
+  do {
+    packed = randomPosition(&rng);
+    ASSERT_TRUE(tb.probe(packed, &res));
+  } while (res.wdl != CHECKERS_WDL_DRAW);
+  EXPECT_FALSE(tb.probeWin(packed, 0, &value));
+  ASSERT_TRUE(tb.probeValue(packed, NO_PROGRESS_MAX_MOVE - 1, &value));
+  EXPECT_EQ(0.0, value);
+}
+
+// Three kings catch a lone king off the main road in a few moves, however
+// long the kings have been moving.
+TEST_F(CheckersKingsTablebaseTest, threeKingsWinMidRun) {
+  CheckersTablebase tb;
+  ASSERT_TRUE(tb.load(path_));
+
+  // Black kings on the first row, the white king on the seventh: the
+  // first capture comes 14 plies later, while the longest win of the
+  // table takes 25.
+  CheckersPackedBoard packed = kingsPosition({0, 1, 3}, {25});
+  CheckersTablebaseResult res;
+  ASSERT_TRUE(tb.probe(packed, &res));
+  ASSERT_EQ(CHECKERS_WDL_WIN, res.wdl);
+  EXPECT_EQ(14, res.dtz);
+  EXPECT_GT(res.max_plies, NO_PROGRESS_MAX_MOVE / 2);
+
+  float value = 0.0;
+  EXPECT_TRUE(tb.probeWin(packed, NO_PROGRESS_MAX_MOVE / 2, &value));
+  EXPECT_EQ(1.0, value);
+
+  // Most wins of three kings against one still are, halfway through a
+  // run without progress.
+  std::mt19937 rng(3);
+  int wins = 0;
+  int in_time = 0;
+  for (int i = 0; i < 2000; ++i) {
+    std::vector<int> squares;
+    while (squares.size() < 4) {
+      int sq = rng() % 32;
+      if (std::find(squares.begin(), squares.end(), sq) == squares.end()) {
+        squares.push_back(sq);
+      }
+    }
+    packed = kingsPosition({squares[0], squares[1], squares[2]}, {squares[3]});
+    ASSERT_TRUE(tb.probe(packed, &res));
+    if (res.wdl != CHECKERS_WDL_WIN) {
+      continue;
+    }
+    wins++;
+    if (tb.probeWin(packed, NO_PROGRESS_MAX_MOVE / 2, &value)) {
+      in_time++;
+    }
+  }
+  EXPECT_GT(wins, 1000);
+  EXPECT_GT(in_time, wins * 2 / 3);
+
+  // Pawns are not in the tables.
+  CheckersBoard board;
+  ClearBoard(&board);
+  memset(board.board, 0, sizeof(board.board));
+  board.board[2][1] = -WHITE_PAWN;
+  board.board[5][0] = WHITE_KING;
+  board.current_player = BLACK_PLAYER;
+  PackBoard(board, &packed);
+  EXPECT_FALSE(tb.probe(packed, &res));
+}
+
+TEST_F(CheckersTablebaseTest, outOfTable) {
+  CheckersTablebase tb;
+  CheckersTablebaseResult res;
+
+  CheckersBoard board;
+  ClearBoard(&board);
+  CheckersPackedBoard packed;
+  PackBoard(board, &packed);
+  EXPECT_FALSE(tb.probe(packed, &res));
+
+  ASSERT_TRUE(tb.load(path_));
+  // Too many pieces.
+  EXPECT_FALSE(tb.probe(packed, &res));
+
+  // A capture in progress.
+  std::mt19937 rng(1);
+  packed = randomPosition(&rng);
+  packed.next_bit = 0;
+  EXPECT_FALSE(tb.probe(packed, &res));
+
+  EXPECT_FALSE(tb.load(path_ + ".missing"));
+  EXPECT_FALSE(tb.loaded());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
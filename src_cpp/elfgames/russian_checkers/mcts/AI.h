@@ -45,21 +45,7 @@ struct StateTrait<CheckersState, Coord> {
 
 
   static bool equals(const CheckersState& s1, const CheckersState& s2) {
-    CheckersBoard b1 = s1.board();
-    CheckersBoard b2 = s2.board();
-
-    int res = 0;
-    for (int y = 0; y < 8; y++) {
-      for (int x = 0; x < 8; x++) {
-          res += (b1.board[y][x] != b2.board[y][x]);
-      }
-    }
-    res += (b1.next_bit_y != b2.next_bit_y);
-    res += (b1.next_bit_x != b2.next_bit_x);
-    res += (b1.current_player != b2.current_player);
-    res += (b1.game_ended != b2.game_ended);
-    // res += (b1.must_bit != b2.must_bit);
-    return res == 0;
+    return SamePosition(s1.packedBoard(), s2.packedBoard());
   }
 
   static bool moves_since(
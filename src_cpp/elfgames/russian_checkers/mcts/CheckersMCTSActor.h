@@ -15,6 +15,7 @@
 #include "elf/logging/IndexedLoggerFactory.h"
 // checkers
 #include "AI.h"
+#include "../game/CheckersTablebase.h"
 
 struct MCTSActorParams {
 	// "checkers_actor_black", "checkers_actor_white"
@@ -25,6 +26,8 @@ struct MCTSActorParams {
 	// If -1, then there is no requirement on model version (any model response
 	// can be used).
 	int64_t				required_version = -1;
+	// Exact values of endgames, not owned.
+	const CheckersTablebase* tablebase = nullptr;
 
 	std::string info() const {
 		std::stringstream ss;
@@ -208,13 +211,30 @@ class CheckersMCTSActor {
 				*oo_ << "Moves[" << s.getAllMoves().size()
 						 << "]: " << s.getAllMovesString() << std::endl;
 			}
-			resp->value = final_value > 0 ? 1.0 : -1.0;
+			// 0 for a draw by repetition or without progress.
+			resp->value = final_value;
 			// No further action.
 			resp->pi.clear();
 			return EVAL_DONE;
-		} else {
-			return EVAL_NEED_NN;
 		}
+
+		float tablebase_value;
+		if (params_.tablebase != nullptr &&
+				params_.tablebase->probeValue(
+						s.packedBoard(), s.noProgressPlies(), &tablebase_value)) {
+			resp->value = tablebase_value;
+			// Keep the moves so that the search can still pick one, their
+			// positions are in the tablebase as well.
+			std::array<int, TOTAL_NUM_ACTIONS> valid = GetValidMovesBinary(s.board());
+			resp->pi.clear();
+			for (size_t i = 0; i < valid.size(); ++i) {
+				if (valid[i])
+					resp->pi.push_back(std::make_pair(Coord(i), 1.0f));
+			}
+			normalize(&resp->pi);
+			return EVAL_DONE;
+		}
+		return EVAL_NEED_NN;
 	}
 
 	
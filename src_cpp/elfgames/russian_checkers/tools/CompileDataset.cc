@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/*
+  Compiles saved selfplay JSON files into position shards:
+
+    compile_dataset --output DIR [--threads N] [--num_future_actions N]
+                    [--shard_size N] [--seed N] INPUT...
+
+  INPUT is a JSON file or a directory of JSON files. Train on the result
+  with --mode offline_train --replay_store_dir DIR.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../train/offline/DatasetCompiler.h"
+
+static void usage(const char* prog) {
+  std::cerr << "Usage: " << prog
+            << " --output DIR [--threads N] [--num_future_actions N]"
+               " [--shard_size N] [--seed N] INPUT..."
+            << std::endl;
+}
+
+int main(int argc, char** argv) {
+  DatasetCompilerOptions options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (arg == "--output" && has_value) {
+      options.output_dir = argv[++i];
+    } else if (arg == "--threads" && has_value) {
+      options.num_threads = std::atoi(argv[++i]);
+    } else if (arg == "--num_future_actions" && has_value) {
+      options.num_future_actions = std::atoi(argv[++i]);
+    } else if (arg == "--shard_size" && has_value) {
+      options.shard_size = std::atoi(argv[++i]);
+    } else if (arg == "--seed" && has_value) {
+      options.seed = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg.compare(0, 2, "--") == 0) {
+      usage(argv[0]);
+      return 1;
+    } else {
+      options.inputs.push_back(arg);
+    }
+  }
+
+  if (options.output_dir.empty() || options.inputs.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  DatasetCompiler compiler(options);
+  return compiler.run() ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/*
+  Move generator perft and throughput from the start position:
+
+    perft [--depth N] [--threads N] [--divide]
+
+  Prints the leaf count of every depth up to N with nodes/sec on one
+  thread and on --threads threads (default: all cores).
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "../game/CheckersPerft.h"
+
+int main(int argc, char** argv) {
+  int depth = 7;
+  int num_threads = std::thread::hardware_concurrency();
+  bool divide = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--depth" && i + 1 < argc) {
+      depth = std::atoi(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      num_threads = std::atoi(argv[++i]);
+    } else if (arg == "--divide") {
+      divide = true;
+    } else {
+      std::fprintf(
+          stderr, "Usage: %s [--depth N] [--threads N] [--divide]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  CheckersBoard board;
+  ClearBoard(&board);
+
+  if (divide) {
+    uint64_t total = 0;
+    for (const auto& p : CheckersPerftDivide(board, depth)) {
+      std::printf("%4d: %llu\n", p.first, (unsigned long long)p.second);
+      total += p.second;
+    }
+    std::printf("total: %llu\n", (unsigned long long)total);
+    return 0;
+  }
+
+  std::printf(
+      "%5s %14s %14s %14s\n", "depth", "nodes", "nps(1)", "nps(threads)");
+  for (int d = 1; d <= depth; ++d) {
+    PerftResult single = CheckersPerftBenchmark(board, d, 1);
+    PerftResult multi = CheckersPerftBenchmark(board, d, num_threads);
+    if (single.nodes != multi.nodes) {
+      std::fprintf(stderr, "Node count mismatch at depth %d\n", d);
+      return 1;
+    }
+    std::printf(
+        "%5d %14llu %14.0f %14.0f\n",
+        d,
+        (unsigned long long)single.nodes,
+        single.nodesPerSecond(),
+        multi.nodesPerSecond());
+  }
+  return 0;
+}
@@ -13,6 +13,7 @@
 // elf
 #include "elf/ai/tree_search/tree_search_options.h"
 #include "elf/logging/IndexedLoggerFactory.h"
+#include "elf/utils/sprt.h"
 #include "elf/utils/utils.h"
 // checkers
 #include "CtrlUtils.h"
@@ -39,6 +40,11 @@ class ModelPerfomance {
 			const ModelPair& p)
 			: gameOptions_(gameOptions),
 				curr_pair_(p),
+				sprt_(
+						gameOptions.eval_sprt_elo0,
+						gameOptions.eval_sprt_elo1,
+						gameOptions.eval_sprt_alpha,
+						gameOptions.eval_sprt_beta),
 				logger_(elf::logging::getIndexedLogger(
 							MAGENTA_B + std::string("|++|") + COLOR_END + 
 							"ModelPerfomance-", 
@@ -82,6 +88,12 @@ class ModelPerfomance {
 		return total_games == 0 ? 0.0 : static_cast<float>(win_games) / total_games;
 	}
 
+	// Log-likelihood ratio of the new model being eval_sprt_elo1 rather
+	// than eval_sprt_elo0 Elo stronger.
+	double llr() const {
+		return sprt_.llr(n_win(), draw_, n_done() - n_win());
+	}
+
 	EvalResult eval_result() const {
 		return eval_result_;
 	}
@@ -95,6 +107,7 @@ class ModelPerfomance {
 				<< "[Lost=" << n_done() - n_win() << "]"
 				<< "[Total=" << n_done() << "]"
 				<< "[Draw=" << draw_ << "]"
+				<< "[LLR=" << llr() << "]"
 				<< "; Requests:"
 			 	<< "[sent=" << sent_ << "]"
 			 	<< "[recieved=" << recv_ << "];"
@@ -131,7 +144,7 @@ class ModelPerfomance {
 	*/
 	void feedInfo(const ClientInfo& c, const CheckersRecord& r) {
 		// мое
-		if (r.result.num_move >= TOTAL_MAX_MOVE - 1) {
+		if (r.result.draw) {
 			draw_++;
 		}
 		else if (r.request.client_ctrl.player_swap) {
@@ -197,6 +210,7 @@ class ModelPerfomance {
  private:
 	const CheckersGameOptions&	gameOptions_;
 	const ModelPair							curr_pair_;
+	const elf_utils::Sprt		sprt_;
 
 	// For each machine + game_id, the list of rewards.
 	// Note that game_id decides whether we swap the player or not.
@@ -237,6 +251,19 @@ class ModelPerfomance {
 		const auto& report = games_->win_count();
 		const auto& swap_report = swap_games_->win_count();
 
+		// Stop as soon as the test is decided, the fixed number of games
+		// being the most it can take.
+		if (gameOptions_.eval_sprt) {
+			switch (sprt_.test(n_win(), draw_, n_done() - n_win())) {
+				case elf_utils::Sprt::SPRT_H1:
+					return EVAL_BLACK_PASS;
+				case elf_utils::Sprt::SPRT_H0:
+					return EVAL_BLACK_NOTPASS;
+				case elf_utils::Sprt::SPRT_CONTINUE:
+					break;
+			}
+		}
+
 		if (report.n_done() >= half_complete &&
 				swap_report.n_done() >= half_complete) {
 			return wr >= gameOptions_.eval_thres ? EVAL_BLACK_PASS : EVAL_BLACK_NOTPASS;
@@ -341,6 +368,12 @@ class EvalSubCtrl {
 		return best_baseline_model_;
 	}
 
+	// No model is waiting for evaluation.
+	bool idle() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return models_to_eval_.empty();
+	}
+
 	void fillInRequest(const ClientInfo& info, MsgRequest* msg) {
 		std::lock_guard<std::mutex> lock(mutex_);
 
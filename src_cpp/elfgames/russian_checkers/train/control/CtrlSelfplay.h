@@ -49,7 +49,7 @@ struct SelfPlayRecord {
 		const CheckersMsgResult& r = record.result;
 
 		const bool didBlackWin = r.reward > 0;
-		if (r.num_move >= TOTAL_MAX_MOVE - 1)
+		if (r.draw)
 			draw_++;
 		else if (didBlackWin) {
 			black_win_++;
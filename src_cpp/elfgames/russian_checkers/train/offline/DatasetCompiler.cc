@@ -0,0 +1,187 @@
+#include "DatasetCompiler.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+static bool is_directory(const std::string& path) {
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool ends_with(const std::string& s, const std::string& suffix) {
+  return s.size() >= suffix.size() &&
+      s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string DatasetCompilerOptions::info() const {
+  std::stringstream ss;
+  ss << "[output=" << output_dir << "][#inputs=" << inputs.size()
+     << "][threads=" << num_threads
+     << "][num_future_actions=" << num_future_actions
+     << "][shard_size=" << shard_size << "][seed=" << seed << "]";
+  return ss.str();
+}
+
+DatasetCompiler::DatasetCompiler(const DatasetCompilerOptions& options)
+    : options_(options),
+      logger_(elf::logging::getIndexedLogger(
+          MAGENTA_B + std::string("|++|") + COLOR_END + "DatasetCompiler-",
+          "")) {
+  CheckersGameOptions game_options;
+  game_options.replay_store_dir = options_.output_dir;
+  game_options.replay_store_segment_size = options_.shard_size;
+  // Checked by the store against the future moves a record keeps.
+  game_options.checkers_num_future_actions = options_.num_future_actions;
+  store_.reset(new CheckersPositionStore(game_options));
+}
+
+std::vector<std::string> DatasetCompiler::listInputFiles(
+    const std::vector<std::string>& inputs) {
+  std::vector<std::string> files;
+
+  for (const auto& input : inputs) {
+    if (!is_directory(input)) {
+      files.push_back(input);
+      continue;
+    }
+    DIR* d = ::opendir(input.c_str());
+    if (d == nullptr)
+      continue;
+    while (struct dirent* e = ::readdir(d)) {
+      std::string name = e->d_name;
+      if (ends_with(name, ".json"))
+        files.push_back(input + "/" + name);
+    }
+    ::closedir(d);
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+bool DatasetCompiler::run() {
+  logger_->info("Compiling dataset {}", options_.info());
+
+  std::vector<std::string> files = listInputFiles(options_.inputs);
+  // Files of the same model version are next to each other, spread them
+  // over the threads so every shard mixes versions.
+  std::mt19937 rng(options_.seed);
+  std::shuffle(files.begin(), files.end(), rng);
+  logger_->info("{} input files", files.size());
+
+  std::atomic<size_t> next_file(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < std::max(options_.num_threads, 1); ++i) {
+    threads.emplace_back(
+        &DatasetCompiler::compileFiles, this, std::cref(files), &next_file,
+        options_.seed + i + 1);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  writeManifest();
+  logger_->info(
+      "Compiled {} positions of {} games from {} files ({} failed). {}",
+      stats_.num_positions.load(),
+      stats_.num_games.load(),
+      stats_.num_files.load(),
+      stats_.num_failed_files.load(),
+      store_->info());
+  return stats_.num_positions.load() > 0;
+}
+
+void DatasetCompiler::compileFiles(
+    const std::vector<std::string>& files,
+    std::atomic<size_t>* next_file,
+    uint64_t seed) {
+  std::mt19937 rng(seed);
+  // Per winner, flushed shuffled once a shard worth of positions is ready.
+  std::vector<CheckersStoredPosition> buffers[2];
+
+  auto flush = [&](int black_win) {
+    auto& buf = buffers[black_win];
+    std::shuffle(buf.begin(), buf.end(), rng);
+    store_->append(black_win, buf);
+    buf.clear();
+  };
+
+  while (true) {
+    size_t idx = next_file->fetch_add(1);
+    if (idx >= files.size())
+      break;
+
+    std::vector<CheckersRecord> records;
+    if (!CheckersRecord::loadBatchFromJsonFile(files[idx], &records)) {
+      logger_->error("Cannot read {}", files[idx]);
+      stats_.num_failed_files++;
+      continue;
+    }
+
+    for (const auto& r : records) {
+      CheckersGamePositions g =
+          CheckersGamePositions::fromRecord(r, options_.num_future_actions);
+      if (g.positions.empty())
+        continue;
+
+      int black_win = g.winner > 0 ? 1 : 0;
+      auto stored = CheckersStoredPosition::fromGame(g);
+      buffers[black_win].insert(
+          buffers[black_win].end(), stored.begin(), stored.end());
+      if ((int)buffers[black_win].size() >= options_.shard_size)
+        flush(black_win);
+
+      stats_.num_games++;
+      stats_.num_positions += stored.size();
+    }
+
+    size_t n = ++stats_.num_files;
+    if (n % 100 == 0) {
+      logger_->info(
+          "Processed {}/{} files, {} positions",
+          n,
+          files.size(),
+          stats_.num_positions.load());
+    }
+  }
+
+  for (int black_win = 0; black_win < 2; ++black_win) {
+    flush(black_win);
+  }
+}
+
+void DatasetCompiler::writeManifest() const {
+  json j;
+  j["format"] = "CheckersStoredPosition";
+  j["record_size"] = sizeof(CheckersStoredPosition);
+  j["num_future_actions"] = options_.num_future_actions;
+  j["num_files"] = stats_.num_files.load();
+  j["num_failed_files"] = stats_.num_failed_files.load();
+  j["num_games"] = stats_.num_games.load();
+  j["num_positions"] = stats_.num_positions.load();
+
+  j["shards"] = json::array();
+  for (bool black_win : {true, false}) {
+    for (const auto& seg : store_->segments(black_win)) {
+      json s;
+      s["path"] = seg.path;
+      s["black_win"] = black_win;
+      s["count"] = seg.count;
+      s["min_version"] = seg.min_version;
+      s["max_version"] = seg.max_version;
+      j["shards"].push_back(s);
+    }
+  }
+
+  std::ofstream oo(options_.output_dir + "/manifest.json");
+  oo << j.dump(2) << std::endl;
+}
@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// elf
+#include "elf/logging/IndexedLoggerFactory.h"
+// checkers
+#include "../server/PositionStore.h"
+
+struct DatasetCompilerOptions {
+  // JSON files saved by RecordBuffer/RecordBufferSimple, or directories
+  // holding them.
+  std::vector<std::string> inputs;
+  // Output replay store directory, usable with --replay_store_dir.
+  std::string output_dir;
+
+  int num_threads = 16;
+  // Must match --checkers_num_future_actions of the training server.
+  int num_future_actions = 1;
+  // Positions per shard, also the shuffle window of each thread.
+  int shard_size = 65536;
+  uint64_t seed = 0;
+
+  std::string info() const;
+};
+
+struct DatasetStats {
+  std::atomic<size_t> num_files{0};
+  std::atomic<size_t> num_failed_files{0};
+  std::atomic<size_t> num_games{0};
+  std::atomic<size_t> num_positions{0};
+};
+
+/*
+  Converts saved selfplay JSON files into shuffled position shards.
+
+  Shards are CheckersPositionStore segments (fixed-size
+  CheckersStoredPosition records), so the server memory-maps them
+  directly. A manifest.json describing the shards is written next to them.
+*/
+class DatasetCompiler {
+ public:
+  DatasetCompiler(const DatasetCompilerOptions& options);
+
+  // Return false if no position could be compiled.
+  bool run();
+
+  const DatasetStats& stats() const {
+    return stats_;
+  }
+
+  // Expand directories of options.inputs into the list of JSON files.
+  static std::vector<std::string> listInputFiles(
+      const std::vector<std::string>& inputs);
+
+ private:
+  DatasetCompilerOptions options_;
+  DatasetStats stats_;
+  std::unique_ptr<CheckersPositionStore> store_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  void compileFiles(
+      const std::vector<std::string>& files,
+      std::atomic<size_t>* next_file,
+      uint64_t seed);
+  void writeManifest() const;
+};
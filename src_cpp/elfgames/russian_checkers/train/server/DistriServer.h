@@ -66,6 +66,10 @@ class DistriServer {
 		return trainCtrl_->getReplayBuffer();
 	}
 
+	CheckersPositionStore* getPositionStore() {
+		return trainCtrl_->getPositionStore();
+	}
+
 	void ServerWaitForSufficientSelfplay(int64_t selfplay_ver) {
 		trainCtrl_->getThreadedCtrl()->waitForSufficientSelfplay(selfplay_ver);
 	}
@@ -128,7 +132,9 @@ class DistriServer {
 				"info {}",
 				count,
 				gameOptions_.list_files.size(),
-				trainCtrl_->getReplayBuffer()->info());
+				getPositionStore() != nullptr
+						? getPositionStore()->info()
+						: trainCtrl_->getReplayBuffer()->info());
 	}
 
  private:
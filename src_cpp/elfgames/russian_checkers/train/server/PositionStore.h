@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+// elf
+#include "elf/distributed/shared_mmap_store.h"
+#include "elf/logging/IndexedLoggerFactory.h"
+// checkers
+#include "../../game/CheckersGameOptions.h"
+#include "../../game/CheckersPosition.h"
+
+/*
+  On-disk replay window, used instead of the in-RAM ReplayBuffer
+  when --replay_store_dir is set.
+
+  Positions of black and white wins are kept in two stores, so we can
+  balance them the same way ReaderQueuesT::getSamplerWithParity does.
+
+  In offline_train mode the directory usually holds shards compiled by
+  DatasetCompiler, so it is never written to, cleaned nor evicted.
+
+  With replay_store_per_game, a sample is a uniform game, then a uniform
+  position of it, as in the replay buffer. The store has no index of
+  games: a uniform position is kept with probability 1 / (positions of
+  its game), which costs about one read per position of an average game.
+*/
+class CheckersPositionStore {
+ public:
+  using Store = elf::shared::MMapStoreT<CheckersStoredPosition>;
+
+  CheckersPositionStore(const CheckersGameOptions& options)
+      : num_versions_(options.replay_store_num_versions),
+        num_future_actions_(options.checkers_num_future_actions),
+        per_game_(options.replay_store_per_game),
+        read_only_(options.mode == "offline_train"),
+        logger_(elf::logging::getIndexedLogger(
+            MAGENTA_B + std::string("|++|") + COLOR_END +
+            "CheckersPositionStore-",
+            "")) {
+    if (num_future_actions_ > CheckersStoredPosition::kMaxFutureActions) {
+      logger_->critical(
+          "checkers_num_future_actions {} is more than the {} moves a "
+          "stored position keeps",
+          num_future_actions_,
+          CheckersStoredPosition::kMaxFutureActions);
+      throw std::range_error("checkers_num_future_actions too large");
+    }
+    ::mkdir(options.replay_store_dir.c_str(), 0755);
+
+    elf::shared::MMapStoreCtrl ctrl;
+    ctrl.segment_size = options.replay_store_segment_size;
+
+    ctrl.dir = options.replay_store_dir + "/black_win";
+    stores_[0].reset(new Store(ctrl));
+    ctrl.dir = options.replay_store_dir + "/white_win";
+    stores_[1].reset(new Store(ctrl));
+
+    logger_->info("Initialized. {}", info());
+  }
+
+  void append(const CheckersGamePositions& g) {
+    if (g.positions.empty())
+      return;
+    auto records = CheckersStoredPosition::fromGame(g);
+    append(g.winner > 0, records);
+  }
+
+  void append(
+      bool black_win,
+      const std::vector<CheckersStoredPosition>& records) {
+    if (records.empty())
+      return;
+    if (read_only_) {
+      if (!warned_read_only_.exchange(true)) {
+        logger_->warn("Offline positions are read only, new games are dropped");
+      }
+      return;
+    }
+    int64_t min_ver = records[0].selfplay_ver;
+    int64_t max_ver = records[0].selfplay_ver;
+    for (const auto& r : records) {
+      min_ver = std::min(min_ver, r.selfplay_ver);
+      max_ver = std::max(max_ver, r.selfplay_ver);
+    }
+    store(black_win)->Append(records.data(), records.size(), min_ver, max_ver);
+  }
+
+  // Return false if there is no position yet.
+  bool sample(std::mt19937* rng, CheckersStoredPosition* p) const {
+    if (!per_game_)
+      return samplePosition(rng, p);
+
+    // Bounds the search if the stored games are longer than num_move says.
+    const int kMaxTrials = 10000;
+    for (int i = 0; i < kMaxTrials; ++i) {
+      if (!samplePosition(rng, p))
+        return false;
+      // Same count as CheckersGamePositions::fromRecord().
+      int num_positions =
+          p->num_move - std::max(num_future_actions_, 1) + 1;
+      if (num_positions <= 1 || (*rng)() % num_positions == 0)
+        return true;
+    }
+    return true;
+  }
+
+  size_t size() const {
+    return stores_[0]->size() + stores_[1]->size();
+  }
+
+  // Called when a new model is used for selfplay.
+  void onNewVersion(int64_t ver) {
+    if (num_versions_ <= 0 || read_only_)
+      return;
+    for (auto& s : stores_) {
+      s->evictBelowVersion(ver - num_versions_ + 1);
+    }
+  }
+
+  void clear() {
+    if (read_only_) {
+      logger_->info("Offline positions are kept");
+      return;
+    }
+    for (auto& s : stores_) {
+      s->clear();
+    }
+  }
+
+  std::vector<elf::shared::MMapSegmentInfo> segments(bool black_win) const {
+    return store(black_win)->segments();
+  }
+
+  std::string info() const {
+    std::stringstream ss;
+    ss << "[black_win] " << stores_[0]->info() << "; [white_win] "
+       << stores_[1]->info();
+    return ss.str();
+  }
+
+ private:
+  std::array<std::unique_ptr<Store>, 2> stores_;
+  int num_versions_;
+  int num_future_actions_;
+  bool per_game_;
+  bool read_only_;
+  std::atomic<bool> warned_read_only_{false};
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  Store* store(bool black_win) const {
+    return stores_[black_win ? 0 : 1].get();
+  }
+
+  // Uniform position, balancing black and white wins.
+  bool samplePosition(std::mt19937* rng, CheckersStoredPosition* p) const {
+    const float kSafeMargin = 0.45;
+    size_t black = stores_[0]->size();
+    size_t white = stores_[1]->size();
+    float black_ratio = static_cast<float>(black) / (black + white + 1e-6);
+    black_ratio = std::max(black_ratio, kSafeMargin);
+    black_ratio = std::min(black_ratio, 1.0f - kSafeMargin);
+
+    std::uniform_real_distribution<> dis(0.0, 1.0);
+    bool black_win = dis(*rng) <= black_ratio;
+    return store(black_win)->sample(rng, p) ||
+        store(!black_win)->sample(rng, p);
+  }
+};
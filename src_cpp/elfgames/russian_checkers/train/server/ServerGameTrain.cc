@@ -13,16 +13,16 @@ ServerGameTrain::ServerGameTrain(
     elf::GameClient* client,
     const ContextOptions& context_options,
     const CheckersGameOptions& game_options,
-    elf::shared::ReaderQueuesT<CheckersRecord>* readerQueues)
+    elf::shared::ReaderQueuesT<CheckersGamePositions>* readerQueues,
+    CheckersPositionStore* positionStore)
       : GameBase(game_idx, client, context_options, game_options), 
         readerQueues_(readerQueues),
+        positionStore_(positionStore),
         logger_(elf::logging::getIndexedLogger(
           MAGENTA_B + std::string("|++|") + COLOR_END + 
           "ServerGameTrain-" + std::to_string(game_idx) + "-",
           "")) {
-  for (size_t i = 0; i < kNumState; ++i) {
-    _checkers_state_ext.emplace_back(new CheckersStateExtOffline(game_idx, game_options));
-  }
+  _samples.resize(kNumState);
   logger_->info("Was succefully created");
 }
 
@@ -30,22 +30,17 @@ void ServerGameTrain::act() {
   std::vector<elf::FuncsWithState> funcsToSend;
 
   for (size_t i = 0; i < kNumState; ++i) {
-    while (true) {
-      int q_idx;
-      auto sampler = readerQueues_->getSamplerWithParity(&_rng, &q_idx);
-      const CheckersRecord* r = sampler.sample();
-      if (r == nullptr) {
-        continue;
-      }
-      _checkers_state_ext[i]->fromRecord(*r);
-
-      // Random pick one ply.
-      if (_checkers_state_ext[i]->switchRandomMove(&_rng))
-        break;
+    if (positionStore_ != nullptr)
+      sampleFromPositionStore(&_samples[i]);
+    else
+      sampleFromReaderQueues(&_samples[i]);
+    if (_game_options.train_augment) {
+      _samples[i].augment(
+          CheckersRandomAugCode(_samples[i].num_move, &_rng));
     }
 
     funcsToSend.push_back(
-        client_->BindStateToFunctions({"train"}, _checkers_state_ext[i].get()));
+        client_->BindStateToFunctions({"train"}, &_samples[i]));
   }
 
   // client_->sendWait({"train"}, &funcs);
@@ -57,3 +52,30 @@ void ServerGameTrain::act() {
   // VERY DANGEROUS - sending pointers of local objects to a function
   client_->sendBatchWait({"train"}, funcPtrsToSend);
 }
+
+void ServerGameTrain::sampleFromReaderQueues(CheckersTrainSample* sample) {
+  while (true) {
+    int q_idx;
+    auto sampler = readerQueues_->getSamplerWithParity(&_rng, &q_idx);
+    const CheckersGamePositions* g = sampler.sample();
+    if (g == nullptr || g->positions.empty()) {
+      continue;
+    }
+
+    // Random pick one ply.
+    size_t idx = _rng() % g->positions.size();
+    sample->fromGame(*g, idx, _game_options.checkers_num_future_actions);
+    return;
+  }
+}
+
+void ServerGameTrain::sampleFromPositionStore(CheckersTrainSample* sample) {
+  CheckersStoredPosition p;
+  // The warm-up counts positions, not games as q_min_size does.
+  while (positionStore_->size() <
+             (size_t)_game_options.replay_store_min_positions ||
+         !positionStore_->sample(&_rng, &p)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  sample->fromStored(p, _game_options.checkers_num_future_actions);
+}
@@ -8,6 +8,8 @@
 
 #include "../../common/GameBase.h"
 #include "elf/distributed/shared_reader.h"
+#include "../../game/CheckersPosition.h"
+#include "PositionStore.h"
 
 /* 
   server side
@@ -19,15 +21,21 @@ class ServerGameTrain : public GameBase {
       elf::GameClient* client,
       const ContextOptions& context_options,
       const CheckersGameOptions& game_options,
-      elf::shared::ReaderQueuesT<CheckersRecord>* readerQueues);
+      elf::shared::ReaderQueuesT<CheckersGamePositions>* readerQueues,
+      CheckersPositionStore* positionStore = nullptr);
 
   void act() override;
 
  private:
-  elf::shared::ReaderQueuesT<CheckersRecord>* readerQueues_ = nullptr;
+  elf::shared::ReaderQueuesT<CheckersGamePositions>* readerQueues_ = nullptr;
+  // If set, positions are sampled from here instead of readerQueues_.
+  CheckersPositionStore* positionStore_ = nullptr;
 
   static constexpr size_t kNumState = 64;
-  std::vector<std::unique_ptr<CheckersStateExtOffline>> _checkers_state_ext;
+  std::vector<CheckersTrainSample> _samples;
+
+  void sampleFromReaderQueues(CheckersTrainSample* sample);
+  void sampleFromPositionStore(CheckersTrainSample* sample);
 
   std::shared_ptr<spdlog::logger> logger_;
 };
@@ -8,7 +8,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -29,9 +31,11 @@
 #include "../control/CtrlSelfplay.h"
 #include "../../common/GameStats.h"
 #include "../../common/Notifier.h"
+#include "../../game/CheckersPosition.h"
+#include "PositionStore.h"
 
 using namespace std::chrono_literals;
-using ReplayBuffer = elf::shared::ReaderQueuesT<CheckersRecord>;
+using ReplayBuffer = elf::shared::ReaderQueuesT<CheckersGamePositions>;
 using ThreadedCtrlBase = elf::ThreadedCtrlBase;
 using Ctrl = elf::Ctrl;
 using Addr = elf::Addr;
@@ -41,6 +45,7 @@ using Addr = elf::Addr;
   been played to update the current model.
 
   ReplayBuffer - Uses here just for cleaning it if keep_prev_selfplay - false.
+  CheckersPositionStore - Same, and evicts positions out of the version window.
   SelfPlaySubCtrl - Contains selfplay Records received from clients.
   EvalSubCtrl - Contains eval Records received from clients.
 */
@@ -50,10 +55,12 @@ class ThreadedCtrl : public ThreadedCtrlBase {
       Ctrl&             ctrl,
       elf::GameClient*  client,
       ReplayBuffer*     replay_buffer,
+      CheckersPositionStore* position_store,
       const CheckersGameOptions&  gameOptions,
       const elf::ai::tree_search::TSOptions& mcts_opt)
       : ThreadedCtrlBase(ctrl, 10000),
         replay_buffer_(replay_buffer),
+        position_store_(position_store),
         gameOptions_(gameOptions),
         client_(client),
         rng_(time(NULL)),
@@ -217,6 +224,7 @@ class ThreadedCtrl : public ThreadedCtrlBase {
   enum _ModelUpdateStatus { MODEL_UPDATED };
 
   ReplayBuffer*   replay_buffer_ = nullptr;
+  CheckersPositionStore* position_store_ = nullptr;
 
   std::unique_ptr<SelfPlaySubCtrl>  selfplaySubCtrl_;
   std::unique_ptr<EvalSubCtrl>      evalSubCtrl_;
@@ -258,6 +266,10 @@ class ThreadedCtrl : public ThreadedCtrlBase {
     // A better model is found, clean up old games (or not?)
     if (!gameOptions_.keep_prev_selfplay) {
       replay_buffer_->clear();
+      if (position_store_ != nullptr)
+        position_store_->clear();
+    } else if (position_store_ != nullptr) {
+      position_store_->onNewVersion(ver);
     }
 
     // Data now prepared ready,
@@ -280,8 +292,8 @@ class ThreadedCtrl : public ThreadedCtrlBase {
 
 /* 
   server side
-  ReplayBuffer - contains Records of the games that clients played.
-    The new model will be trained from this buffer.
+  ReplayBuffer - contains positions of the games that clients played,
+    materialized once on receive. The new model will be trained from this buffer.
 */
 class TrainCtrl : public DataInterface {
  public:
@@ -292,6 +304,7 @@ class TrainCtrl : public DataInterface {
       const CheckersGameOptions&  gameOptions,
       const elf::ai::tree_search::TSOptions& mcts_opt)
       : ctrl_(ctrl),
+        num_future_actions_(gameOptions.checkers_num_future_actions),
         rng_(time(NULL)),
         selfplay_record_("tc_selfplay"),
         logger_(elf::logging::getIndexedLogger(
@@ -304,13 +317,41 @@ class TrainCtrl : public DataInterface {
     rq_ctrl.num_reader = gameOptions.num_reader;
     rq_ctrl.ctrl.queue_min_size = gameOptions.q_min_size;
     rq_ctrl.ctrl.queue_max_size = gameOptions.q_max_size;
+    rq_ctrl.ctrl.prioritized = gameOptions.replay_prioritized;
+    rq_ctrl.ctrl.recency_half_life = gameOptions.replay_recency_half_life;
+    rq_ctrl.ctrl.version_half_life = gameOptions.replay_version_half_life;
 
     replay_buffer_.reset(new ReplayBuffer(rq_ctrl));
+    if (gameOptions.replay_prioritized) {
+      bool by_length = gameOptions.replay_weight_by_length;
+      replay_buffer_->setWeightFunction(
+          [by_length](const CheckersGamePositions& g) -> float {
+            float w = g.pri > 0 ? g.pri : 1.0;
+            if (by_length)
+              w *= g.positions.size();
+            return w;
+          });
+      replay_buffer_->setVersionFunction(
+          [](const CheckersGamePositions& g) -> int64_t {
+            return g.selfplay_ver;
+          });
+    }
     logger_->info(
         "Finished initializing replay_buffer(ReplayBuffer). info :\n{}", replay_buffer_->info());
+
+    if (!gameOptions.replay_store_dir.empty()) {
+      position_store_.reset(new CheckersPositionStore(gameOptions));
+      logger_->info(
+          "Finished initializing position_store(CheckersPositionStore)");
+    }
     
     threaded_ctrl_.reset(new ThreadedCtrl(
-        ctrl_, client, replay_buffer_.get(), gameOptions, mcts_opt));
+        ctrl_,
+        client,
+        replay_buffer_.get(),
+        position_store_.get(),
+        gameOptions,
+        mcts_opt));
     logger_->info(
         "Finished initializing threaded_ctrl_(ThreadedCtrl)");
 
@@ -335,6 +376,11 @@ class TrainCtrl : public DataInterface {
     return replay_buffer_.get();
   }
 
+  // nullptr if --replay_store_dir is not set.
+  CheckersPositionStore* getPositionStore() {
+    return position_store_.get();
+  }
+
   ThreadedCtrl* getThreadedCtrl() {
     return threaded_ctrl_.get();
   }
@@ -376,9 +422,15 @@ class TrainCtrl : public DataInterface {
           selfplay_res[i] == FeedResult::VERSION_MISMATCH) {
         const CheckersRecord& r = rs.records[i];
 
-        bool black_win = r.result.reward > 0;
-        insert_info +=
-            replay_buffer_->InsertWithParity(CheckersRecord(r), &rng_, black_win);
+        CheckersGamePositions g =
+            CheckersGamePositions::fromRecord(r, num_future_actions_);
+        if (position_store_ != nullptr) {
+          position_store_->append(g);
+        } else {
+          bool black_win = r.result.reward > 0;
+          insert_info +=
+              replay_buffer_->InsertWithParity(std::move(g), &rng_, black_win);
+        }
         selfplay_record_.feed(r);
         selfplay_record_.saveAndClean(1000);
       }
@@ -437,10 +489,12 @@ class TrainCtrl : public DataInterface {
   Ctrl& ctrl_;
 
   std::unique_ptr<ReplayBuffer>   replay_buffer_;
+  std::unique_ptr<CheckersPositionStore> position_store_;
   std::unique_ptr<ClientManager>  client_mgr_;
   std::unique_ptr<ThreadedCtrl>   threaded_ctrl_;
 
   int recv_count_ = 0;
+  int num_future_actions_;
   std::mt19937 rng_;
 
   // SelfCtrl has its own record buffer to save EVERY game it has received.
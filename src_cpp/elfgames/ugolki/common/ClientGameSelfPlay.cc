@@ -15,10 +15,12 @@ ClientGameSelfPlay::ClientGameSelfPlay(
     const ContextOptions& context_options,
     const GameOptions& game_options,
     ThreadedDispatcher* dispatcher,
-    GameNotifierBase* gameNotifier)
+    GameNotifierBase* gameNotifier,
+    GameRequesterBase* arena)
     : GameBase(game_idx, client, context_options, game_options),
       dispatcher_(dispatcher),
       gameNotifier_(gameNotifier),
+      arena_(arena),
       game_state_ext_(game_idx, game_options),
       logger_(elf::logging::getIndexedLogger(
           MAGENTA_B + std::string("|++|") + COLOR_END + 
@@ -83,12 +85,25 @@ MCTSGameAI* ClientGameSelfPlay::init_ai(
     mcts_opt.num_rollouts_per_thread = mcts_rollout_per_thread_override;
   }
 
+  // Pondering is up to this client, whatever the request says. In selfplay
+  // of one model the same ai plays both colours on one tree, so there is
+  // no opponent's turn to ponder on.
+  mcts_opt.ponder_rollouts_per_thread =
+      (_game_options.mode == "play" || !game_state_ext_.currRequest().vers.is_selfplay())
+      ? _context_options.mcts_options.ponder_rollouts_per_thread
+      : 0;
+
   if (mcts_opt.verbose) {
     mcts_opt.log_prefix = "ts-game" + std::to_string(_game_idx) + "-mcts";
     logger_->warn("Log prefix {}", mcts_opt.log_prefix);
   }
 
-  return new MCTSGameAI(mcts_opt, [&](int) { return new MCTSGameActor(client_, params); });
+  // The threads of each tree (see TSOptions::num_trees) get their own seed.
+  return new MCTSGameAI(mcts_opt, [&](int i) {
+    MCTSActorParams tree_params = params;
+    tree_params.seed += i % std::max(1, mcts_opt.num_trees);
+    return new MCTSGameActor(client_, tree_params);
+  });
 }
 
 Coord ClientGameSelfPlay::mcts_make_diverse_move(MCTSGameAI* mcts_ai, Coord c) {
@@ -142,10 +157,30 @@ void ClientGameSelfPlay::finish_game() {
   if (gameNotifier_ != nullptr){
     gameNotifier_->OnGameEnd(game_state_ext_);
   }
+  arena_waiting_ = true;
   // My code
   game_state_ext_.restart();
 }
 
+// Take the next game from the arena once the previous one is over.
+bool ClientGameSelfPlay::arena_request() {
+  if (!arena_waiting_)
+    return true;
+
+  MsgRequest request;
+  if (!arena_->OnGameRequest(_game_idx, &request))
+    return false;
+
+  // The ais are kept while the models and colours stay the same.
+  bool same_request = !game_state_ext_.currRequest().vers.wait() &&
+      request == game_state_ext_.currRequest();
+  game_state_ext_.setRequest(request);
+  if (!same_request)
+    restart();
+  arena_waiting_ = false;
+  return true;
+}
+
 void ClientGameSelfPlay::setAsync() {
   ai1_->setRequiredVersion(-1);
   if (ai2_ != nullptr)
@@ -163,7 +198,7 @@ void ClientGameSelfPlay::restart() {
 
   simple_agent_.reset(new SimpleAgent());
 
-  if (_game_options.mode == "selfplay") {
+  if (_game_options.mode == "selfplay" || _game_options.mode == "arena") {
     ai1_.reset(init_ai(
         "actor_black",
         request.vers.mcts_opt,
@@ -260,9 +295,11 @@ void ClientGameSelfPlay::act() {
     using std::placeholders::_2;
     auto f = std::bind(&ClientGameSelfPlay::OnReceive, this, _1, _2);
 
-    do {
-      dispatcher_->checkMessage(game_state_ext_.currRequest().vers.wait(), f);
-    } while (game_state_ext_.currRequest().vers.wait());
+    if (dispatcher_ != nullptr) {
+      do {
+        dispatcher_->checkMessage(game_state_ext_.currRequest().vers.wait(), f);
+      } while (game_state_ext_.currRequest().vers.wait());
+    }
 
     // Check request every 5 times.
     // Update current state.
@@ -337,8 +374,14 @@ void ClientGameSelfPlay::act() {
     }
   }
 
+  if (arena_ != nullptr && !arena_request()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return;
+  }
+
   int current_player = gameState.currentPlayer();
   Coord move = M_INVALID;
+  MCTSGameAI* ponder_ai = nullptr;
 
   if (model_update_ == 2
         && ((current_player == BLACK_PLAYER && swap_ == true) 
@@ -365,6 +408,7 @@ void ClientGameSelfPlay::act() {
     } else {
       curr_ai->act(gameState, &move);
       move = mcts_make_diverse_move(curr_ai, move);
+      ponder_ai = curr_ai;
     }
     move = mcts_update_info(curr_ai, move);
   }
@@ -385,6 +429,9 @@ void ClientGameSelfPlay::act() {
 
   if (gameState.terminated()) {
     finish_game();
+  } else if (ponder_ai != nullptr) {
+    // Search on while the opponent is to move.
+    ponder_ai->ponder(gameState);
   }
 }
 
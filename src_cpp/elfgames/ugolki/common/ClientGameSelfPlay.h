@@ -42,7 +42,7 @@
   ai1_ - uses MCTS for searching best action. Responsible for
       generating batches for training the neural network.
   ai2_ - also uses MCTS. Initialized only when the client receives
-      a notification from the server to compare two models.
+      a notification from the server (or LocalArena) to compare two models.
   human_player_ - The base class AIClientT that sends batch files from C++ to python 
       and expects to receive an answer. In our case, these are the keys that 
       we registered in the GameFeature.h and game.py files namely by 
@@ -59,7 +59,8 @@ class ClientGameSelfPlay : public GameBase {
       const ContextOptions& context_options,
       const GameOptions& game_options,
       ThreadedDispatcher* dispatcher,
-      GameNotifierBase* gameNotifier = nullptr);
+      GameNotifierBase* gameNotifier = nullptr,
+      GameRequesterBase* arena = nullptr);
 
   bool OnReceive(const MsgRequest& request, RestartReply* reply);
 
@@ -86,14 +87,19 @@ class ClientGameSelfPlay : public GameBase {
   void setAsync();
   Coord mcts_make_diverse_move(MCTSGameAI* mcts_ai, Coord c);
   Coord mcts_update_info(MCTSGameAI* mcts_ai, Coord c);
+  bool arena_request();
   void finish_game();
 
  private:
   ThreadedDispatcher* dispatcher_ = nullptr;
   GameNotifierBase* gameNotifier_ = nullptr;
+  // Hands out the games in the arena mode, instead of dispatcher_.
+  GameRequesterBase* arena_ = nullptr;
   GameStateExt game_state_ext_;
 
   int online_counter_ = 0;
+  // The arena has not handed out the current game yet.
+  bool arena_waiting_ = true;
   std::unique_ptr<MCTSGameAI> ai1_;
   // Opponent ai (used for selfplay evaluation)
   std::unique_ptr<MCTSGameAI> ai2_;
@@ -90,6 +90,18 @@ class GameFeature {
       float* f) {
     // Then send the data to the server.
     extractGameState(s._bf, f);
+
+    // Only the piece planes change, the side-to-move ones are constant.
+    if (s._aug_code == AUG_TRANSPOSE) {
+      for (int i = 0; i < 2 * MAX_HISTORY; ++i) {
+        float* plane = f + (i / 2 * 4 + i % 2) * BOARD_SIZE * BOARD_SIZE;
+        for (int y = 0; y < BOARD_SIZE; ++y) {
+          for (int x = 0; x < y; ++x) {
+            std::swap(plane[y * BOARD_SIZE + x], plane[x * BOARD_SIZE + y]);
+          }
+        }
+      }
+    }
   }
 
   // check it
@@ -108,15 +120,16 @@ class GameFeature {
       const auto& policy = s._mcts_policies[move_to].prob;
       float sum_v = 0.0;
       for (size_t i = 0; i < TOTAL_NUM_ACTIONS; ++i) {
-        mcts_scores[i] = policy[i];
-        sum_v += mcts_scores[i];
+        mcts_scores[AugmentAction(i, s._aug_code)] = policy[i];
+        sum_v += policy[i];
       }
       // Then we normalize.
       for (size_t i = 0; i < TOTAL_NUM_ACTIONS; ++i) {
         mcts_scores[i] /= sum_v;
       }
     } else {
-      mcts_scores[s._offline_all_moves[move_to]] = 1.0;
+      mcts_scores[AugmentAction(
+          s._offline_all_moves[move_to], s._aug_code)] = 1.0;
     }
   }
 
@@ -129,10 +142,16 @@ class GameFeature {
     const size_t move_to = s._state.getPly() - 1;
     for (int i = 0; i < s._game_options.num_future_actions; ++i) {
       Coord m = s._offline_all_moves[move_to + i];
-      offline_a[i] = m;
+      offline_a[i] = AugmentAction(m, s._aug_code);
     }
   }
 
+  static void extractAugCode(
+      const GameStateExtOffline& s, 
+      int* aug_code) {
+    *aug_code = s._aug_code;
+  }
+
   static void extractGameStateSelfplayVersion(
       const GameStateExtOffline& s, 
       int64_t* ver) {
@@ -199,6 +218,7 @@ class GameFeature {
         .addFunction<float>("winner", extractWinner)
         .addFunction<float>("mcts_scores", extractMCTSPi)
         .addFunction<int64_t>("offline_a", extractOfflineAction)
+        .addFunction<int32_t>("aug_code", extractAugCode)
         .addFunction<int64_t>("selfplay_ver", extractGameStateSelfplayVersion)
         ;
 
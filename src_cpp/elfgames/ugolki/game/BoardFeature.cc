@@ -1,6 +1,8 @@
 #include "BoardFeature.h"
 #include "GameState.h"
 
+#include "elf/utils/bitplanes.h"
+
 static float* board_plane(float* features, int idx) {
   return features + idx * BOARD_SIZE * BOARD_SIZE;
 }
@@ -8,18 +10,6 @@ static float* board_plane(float* features, int idx) {
 // features param will taken from parent function 
 #define LAYER(idx) board_plane(features, idx)
 
-void BoardFeature::getPawns(int player, float* data) const {
-  std::array<std::array<int, 8>, 8> observation;
-  observation = GetObservation(s_.board(), player);
-  
-  for (int y = 0; y < BOARD_SIZE; ++y) {
-    for (int x = 0; x < BOARD_SIZE; ++x) {
-      if (observation[y][x] == 1)
-        data[y * BOARD_SIZE + x] = 1;
-    }
-  }
-}
-
 // void BoardFeature::getHistory(int player, float* data) const {
 //   const Board* _board = &s_.board();
 
@@ -43,21 +33,20 @@ void BoardFeature::extract(std::vector<float>* features) const {
 }
 
 void BoardFeature::extract(float* features) const {
-  const GameBoard* _board = &s_.board();
-
-  int active_player = _board->active;
-  int passive_player = (active_player == BLACK_PLAYER) ? WHITE_PLAYER : BLACK_PLAYER;
-
-  std::fill(features, features + NUM_FEATURES * kBoardRegion, 0.0);
-
-  // Save the current board state to game state.
-  getPawns(active_player, LAYER(0));
-  getPawns(passive_player, LAYER(1));
-
-  float* black_indicator = LAYER(2);
-  float* white_indicator = LAYER(3);
-  if (active_player == BLACK_PLAYER)
-    std::fill(black_indicator, black_indicator + kBoardRegion, 1.0);
-  else
-    std::fill(white_indicator, white_indicator + kBoardRegion, 1.0);
+  const GameState::History& history = s_.getHistory();
+  int num_boards = history.size();
+
+  // Current board first, then the previous ones. Missing ones are left
+  // empty.
+  for (int i = 0; i < num_boards; i++) {
+    const GameBoardHistory& board = history[num_boards - 1 - i];
+
+    elf_utils::bits_to_plane(board.masks[0], LAYER(4 * i + 0));
+    elf_utils::bits_to_plane(board.masks[1], LAYER(4 * i + 1));
+    // the player on move
+    bool black = board.active == BLACK_PLAYER;
+    std::fill(LAYER(4 * i + 2), LAYER(4 * i + 3), black ? 1.0 : 0.0);
+    std::fill(LAYER(4 * i + 3), LAYER(4 * i + 4), black ? 0.0 : 1.0);
+  }
+  std::fill(LAYER(4 * num_boards), LAYER(NUM_FEATURES), 0.0);
 }
@@ -5,13 +5,15 @@
 
 #include "GameBoard.h"
 
-// Do not used yet
+// One board of the history, reduced to what the features need.
 struct GameBoardHistory {
-  GameBoard board;
+  // See GetObservationMasks().
+  std::array<uint64_t, 2> masks;
+  int active;
 
-  // Copy position of the pawns and kings on the board.
-  GameBoardHistory(const GameBoard& b) {
-    CopyBoard(&board, &b);
+  GameBoardHistory() = default;
+  GameBoardHistory(const GameBoard& b)
+      : masks(GetObservationMasks(b)), active(b.active) {
   }
 };
 
@@ -33,9 +35,6 @@ class BoardFeature {
   const GameState& s_;
   static constexpr int64_t kBoardRegion = BOARD_SIZE * BOARD_SIZE;
 
-  // Compute features.
-  void getPawns(int player, float* data) const;
-  void getKings(int player, float* data) const;
   // void getHistory(int player, float* data) const;
 };
 
@@ -1,5 +1,8 @@
 #include "GameBoard.h"
 
+#include "elf/utils/bitplanes.h"
+#include "elf/utils/cpu_features.h"
+
 #define myassert(p, text) \
   do {                    \
     if (!(p)) {           \
@@ -66,9 +69,9 @@ bool Play(GameBoard *board, int action_index) {
   int passive;
   int buffer;
 
-  auto index = moves::i_to_m.find(action_index);
-  action = index->second[0];
-  jump = index->second[1] & 2;
+  const auto& move = _action_to_move(action_index);
+  action = move[0];
+  jump = move[1] & 2;
 
   board->_ply++;
   if (action != -1) {
@@ -94,7 +97,9 @@ bool Play(GameBoard *board, int action_index) {
 
     if (jump) {
       // check next jump
-      can_jump = (_jumps_from(*board, board->pieces[active], board->jump_action).size() != 0);
+      MoveList jumps;
+      _jumps_from(*board, board->pieces[active], board->jump_action, &jumps);
+      can_jump = (jumps.size != 0);
       if (can_jump) {
         return false;
       }
@@ -110,26 +115,20 @@ bool Play(GameBoard *board, int action_index) {
 
 
 
-std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(GameBoard board) {
+std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(const GameBoard& board) {
   std::array<int, TOTAL_NUM_ACTIONS> result;
-
-  std::vector<std::array<uint64_t, 2>> moves;  
-  std::stringstream ss;
+  MoveList moves;
 
   result.fill(0);
-  moves = get_legal_moves(board);
-
-  for (auto i = moves.begin(); i != moves.end(); ++i) {
-    ss << (*i)[0] << ", " << (*i)[1];
-    // std::cout << ss.str() << " : |" << moves::m_to_i.find(ss.str())->second << "|" << std::endl;
-    result[moves::m_to_i.find(ss.str())->second] = 1;
-    ss.str("");
+  get_legal_moves(board, &moves);
+  for (int i = 0; i < moves.size; ++i) {
+    result[moves.actions[i]] = 1;
   }
   return result;
 }
 
 
-bool TryPlay(GameBoard board, Coord c) {
+bool TryPlay(const GameBoard& board, Coord c) {
   uint64_t active_pieces;
   uint64_t all_pieces;
   uint64_t empty_pieces;
@@ -138,10 +137,10 @@ bool TryPlay(GameBoard board, Coord c) {
   uint64_t direction;
   uint64_t jump_move; // jump
 
-  auto index = moves::i_to_m.find(c);
-  action = index->second[0];
-  direction = index->second[1] & 1;
-  jump_move = index->second[1] & 2;
+  const auto& move = _action_to_move(c);
+  action = move[0];
+  direction = move[1] & 1;
+  jump_move = move[1] & 2;
 
   uint64_t pawn_pos;
   // check for leaving base both players
@@ -194,25 +193,20 @@ bool TryPlay(GameBoard board, Coord c) {
     // Check for empty cell.
     return empty_pieces & (action ^ pawn_pos);
   } else {
-    // Jump
-    int start_pos = log(pawn_pos) / log(2);
-    int dest_pos = log(action ^ pawn_pos) / log(2);
+    // Jump over the square halfway.
+    int start_pos = __builtin_ctzll(pawn_pos);
+    int dest_pos = __builtin_ctzll(action ^ pawn_pos);
 
-    if (!(empty_pieces & (1UL << dest_pos))) {
+    if (!(empty_pieces & (action ^ pawn_pos))) {
       return false;
     }
-
-    if (direction) {
-      return all_pieces & (1UL << (start_pos + ((dest_pos - start_pos) / 2)));
-    } else {
-      return all_pieces & (1UL << (dest_pos + ((start_pos - dest_pos) / 2)));
-    }
+    return all_pieces & (1UL << ((start_pos + dest_pos) / 2));
   }
   return false;
 
 }
 
-bool IsOver(GameBoard board) {
+bool IsOver(const GameBoard& board) {
   if (board.black_win > 0 && board.white_win > 0) {
     return true;
   } else if (board.black_win == 2 || board.white_win == 2) {
@@ -268,6 +262,15 @@ std::array<std::array<int, 8>, 8> GetObservation(GameBoard board, int player) {
   return (board_out);
 }
 
+std::array<uint64_t, 2> GetObservationMasks(const GameBoard& board) {
+  // GetObservation(board, WHITE_PLAYER) turns the board by 180 degrees.
+  auto observe = [&board](int player) {
+    uint64_t pieces = board.pieces[player];
+    return player == WHITE_PLAYER ? elf_utils::reverse_bits(pieces) : pieces;
+  };
+  return {observe(board.active), observe(board.passive)};
+}
+
 std::array<std::array<int, 8>, 8> GetTrueObservation(GameBoard board) {
   return (GetObservation(board, BLACK_PLAYER));
 }
@@ -310,258 +313,338 @@ void CopyBoard(GameBoard* dst, const GameBoard* src) {
 
 
 // just board logic
-uint64_t _ugolki_right(GameBoard board, uint64_t pieces) {
+namespace {
+
+// Order of the generators below. Right/forward moves go to higher
+// squares, a step moves by kShift squares and a jump by twice as much.
+enum MoveDirection { RIGHT = 0, LEFT, FORWARD, BACKWARD, NUM_MOVE_DIRECTIONS };
+constexpr int kShift[NUM_MOVE_DIRECTIONS] = {1, 1, 8, 8};
+
+// Action index of every step/jump keyed by (jump, direction, origin
+// square), and {move, direction | jump} of every action index. Built once
+// from moves::i_to_m.
+struct MoveTable {
+  int16_t index[2][NUM_MOVE_DIRECTIONS][64];
+  std::array<std::array<uint64_t, 2>, TOTAL_NUM_ACTIONS> move;
+  Coord pass;
+
+  MoveTable() {
+    memset(index, -1, sizeof(index));
+    move.fill({0, 0});
+    for (const auto& a : moves::i_to_m) {
+      move[a.first] = a.second;
+      uint64_t m = a.second[0];
+      if (m == 0) {
+        pass = a.first;
+        continue;
+      }
+      int lo = __builtin_ctzll(m);
+      int hi = 63 - __builtin_clzll(m);
+      bool jump = a.second[1] & 2;
+      bool up = a.second[1] & 1;
+      bool vertical = (hi - lo) >= 8;
+
+      int dir = vertical ? (up ? FORWARD : BACKWARD) : (up ? RIGHT : LEFT);
+      index[jump][dir][up ? lo : hi] = a.first;
+    }
+  }
+};
+
+const MoveTable& moveTable() {
+  static const MoveTable table;
+  return table;
+}
+
+// Append the step/jump of every origin square in mask.
+inline void addMoves(uint64_t mask, bool jump, int dir, MoveList* moves) {
+  const auto& index = moveTable().index[jump][dir];
+  int shift = jump ? 2 * kShift[dir] : kShift[dir];
+  uint64_t pattern = (1UL << shift) | 1;
+  for (uint64_t b = mask; b != 0; b &= b - 1) {
+    int sq = __builtin_ctzll(b);
+    int lo = (dir == RIGHT || dir == FORWARD) ? sq : sq - shift;
+    moves->push(pattern << lo, index[sq]);
+  }
+}
+
+inline uint64_t emptySquares(const GameBoard& board, uint64_t extra = 0) {
+  return ~(board.pieces[BLACK_PLAYER] | board.pieces[WHITE_PLAYER] | extra);
+}
+
+} // namespace
+
+uint64_t _ugolki_right(const GameBoard& board, uint64_t pieces) {
   uint64_t invalid = 0x0101010101010101 >> 1;
-  uint64_t empty = 0xFFFFFFFFFFFFFFFF ^ (board.pieces[BLACK_PLAYER] | board.pieces[WHITE_PLAYER]);
-  return (empty >> 1) & (pieces ^ (pieces & invalid));
+  return (emptySquares(board) >> 1) & (pieces & ~invalid);
 }
-uint64_t _ugolki_left(GameBoard board, uint64_t pieces) {
+uint64_t _ugolki_left(const GameBoard& board, uint64_t pieces) {
   uint64_t invalid = 0x0101010101010101;
-  uint64_t empty = 0xFFFFFFFFFFFFFFFF ^ (board.pieces[BLACK_PLAYER] | board.pieces[WHITE_PLAYER]);
-  return (empty << 1) & (pieces ^ (pieces & invalid));
+  return (emptySquares(board) << 1) & (pieces & ~invalid);
 }
-uint64_t _ugolki_forward(GameBoard board, uint64_t pieces) {
-  uint64_t empty = 0xFFFFFFFFFFFFFFFF ^ (board.pieces[BLACK_PLAYER] | board.pieces[WHITE_PLAYER]);
-  return (empty >> 8) & (pieces);
+uint64_t _ugolki_forward(const GameBoard& board, uint64_t pieces) {
+  return (emptySquares(board) >> 8) & pieces;
 }
-uint64_t _ugolki_backward(GameBoard board, uint64_t pieces) {
-  uint64_t empty = 0xFFFFFFFFFFFFFFFF ^ (board.pieces[BLACK_PLAYER] | board.pieces[WHITE_PLAYER]);
-  return (empty << 8) & (pieces);
+uint64_t _ugolki_backward(const GameBoard& board, uint64_t pieces) {
+  return (emptySquares(board) << 8) & pieces;
 }
-uint64_t _ugolki_right_jumps(GameBoard board, uint64_t pieces, uint64_t invalid_move) {
+uint64_t _ugolki_right_jumps(const GameBoard& board, uint64_t pieces, uint64_t invalid_move) {
   uint64_t invalid = 0x0303030303030303 >> 2;
-  uint64_t all_pieces = board.pieces[WHITE_PLAYER] | board.pieces[BLACK_PLAYER] | invalid_move;
-  uint64_t empty = 0xFFFFFFFFFFFFFFFF ^ all_pieces;
-  return ((empty >> 2) & (pieces ^ (pieces & invalid)) & (all_pieces >> 1));
+  uint64_t empty = emptySquares(board, invalid_move);
+  return ((empty >> 2) & (pieces & ~invalid) & (~empty >> 1));
 }
-uint64_t _ugolki_left_jumps(GameBoard board, uint64_t pieces, uint64_t invalid_move) {
+uint64_t _ugolki_left_jumps(const GameBoard& board, uint64_t pieces, uint64_t invalid_move) {
   uint64_t invalid = 0x0303030303030303;
-  uint64_t all_pieces = board.pieces[WHITE_PLAYER] | board.pieces[BLACK_PLAYER] | invalid_move;
-  uint64_t empty = 0xFFFFFFFFFFFFFFFF ^ all_pieces;
-  return ((empty << 2) & (pieces ^ (pieces & invalid)) & (all_pieces << 1));
+  uint64_t empty = emptySquares(board, invalid_move);
+  return ((empty << 2) & (pieces & ~invalid) & (~empty << 1));
 }
-uint64_t _ugolki_forward_jumps(GameBoard board, uint64_t pieces, uint64_t invalid_move) {
-  uint64_t all_pieces = board.pieces[WHITE_PLAYER] | board.pieces[BLACK_PLAYER] | invalid_move;
-  uint64_t empty = 0xFFFFFFFFFFFFFFFF ^ all_pieces;
-  return ((empty >> 16) & pieces & (all_pieces >> 8));
+uint64_t _ugolki_forward_jumps(const GameBoard& board, uint64_t pieces, uint64_t invalid_move) {
+  uint64_t empty = emptySquares(board, invalid_move);
+  return ((empty >> 16) & pieces & (~empty >> 8));
 }
-uint64_t _ugolki_backward_jumps(GameBoard board, uint64_t pieces, uint64_t invalid_move) {
-  uint64_t all_pieces = board.pieces[WHITE_PLAYER] | board.pieces[BLACK_PLAYER] | invalid_move;
-  uint64_t empty = 0xFFFFFFFFFFFFFFFF ^ all_pieces;
-  return ((empty << 16) & pieces & (all_pieces << 8));
+uint64_t _ugolki_backward_jumps(const GameBoard& board, uint64_t pieces, uint64_t invalid_move) {
+  uint64_t empty = emptySquares(board, invalid_move);
+  return ((empty << 16) & pieces & (~empty << 8));
 }
 
 
-
-
 uint64_t _ugolki_get_move_direction(uint64_t move, uint64_t pieces) {
-  if (move < 0) {
-    move = -move;
-  }
   return (pieces < (pieces ^ move));
 }
 
 
-  // board->pieces[BLACK_PLAYER] = WHITE_BASE;
-  // board->pieces[WHITE_PLAYER] = BLACK_BASE;
-std::vector<std::array<uint64_t, 2>> get_legal_moves(GameBoard board) {
+const std::array<uint64_t, 2>& _action_to_move(Coord action) {
+  return moveTable().move[action];
+}
+
+
+void get_legal_moves(const GameBoard& board, MoveList* moves) {
   int active = board.active;
-  int passive = board.passive;
 
+  moves->clear();
   // check for leaving base both players
   if (board.jump_action != 0) {
-    return _jumps_from(board, board.pieces[active], board.jump_action);
+    _jumps_from(board, board.pieces[active], board.jump_action, moves);
   } else if ((active == BLACK_PLAYER)
       && !(board.pieces[WHITE_PLAYER] & BLACK_BASE)
       && (board.pieces[BLACK_PLAYER] & WHITE_BASE)) {
-    return _get_all_moves(board, board.pieces[BLACK_PLAYER] & WHITE_BASE);
+    _get_all_moves(board, board.pieces[BLACK_PLAYER] & WHITE_BASE, moves);
   } else if ((active == WHITE_PLAYER)
       && !(board.pieces[BLACK_PLAYER] & WHITE_BASE)
       && (board.pieces[WHITE_PLAYER] & BLACK_BASE)) {
-    return _get_all_moves(board, board.pieces[WHITE_PLAYER] & BLACK_BASE);
+    _get_all_moves(board, board.pieces[WHITE_PLAYER] & BLACK_BASE, moves);
+  } else {
+    _get_all_moves(board, board.pieces[active], moves);
   }
-  return _get_all_moves(board, board.pieces[active]);
 }
 
 
-std::vector<std::array<uint64_t, 2>> _get_all_moves(GameBoard board, uint64_t pieces) {
+void _get_all_moves(const GameBoard& board, uint64_t pieces, MoveList* moves) {
   /*
-    Returns a list of all possible moves.
+    Appends all possible moves of pieces: steps, then jumps.
 
     A legal move is represented by an integer with exactly two
     bits turned on: the old position and the new position.
+  */
+  addMoves(_ugolki_right(board, pieces), false, RIGHT, moves);
+  addMoves(_ugolki_left(board, pieces), false, LEFT, moves);
+  addMoves(_ugolki_forward(board, pieces), false, FORWARD, moves);
+  addMoves(_ugolki_backward(board, pieces), false, BACKWARD, moves);
+
+  addMoves(_ugolki_right_jumps(board, pieces), true, RIGHT, moves);
+  addMoves(_ugolki_left_jumps(board, pieces), true, LEFT, moves);
+  addMoves(_ugolki_forward_jumps(board, pieces), true, FORWARD, moves);
+  addMoves(_ugolki_backward_jumps(board, pieces), true, BACKWARD, moves);
+}
+
 
-    Jumps are indicated with a negative sign.
+void _jumps_from(const GameBoard& board, uint64_t pieces, uint64_t jump_action, MoveList* moves) {
+  /*
+      Appends all possible jumps of the piece that made jump_action
+      (it may not jump back to where it came from), and the pass action
+      ending the sequence if there is any.
   */
-  uint64_t rm;
-  uint64_t lm;
-  uint64_t fm;
-  uint64_t bm;
-
-  uint64_t rj;
-  uint64_t lj;
-  uint64_t fj;
-  uint64_t bj;
-
-  std::vector<std::array<uint64_t, 2>> moves;
-  uint64_t buff;
-  std::array<uint64_t, 2> move_buff;
-
-  rm = _ugolki_right(board, pieces);
-  lm = _ugolki_left(board, pieces);
-  fm = _ugolki_forward(board, pieces);
-  bm = _ugolki_backward(board, pieces);
-
-  rj = _ugolki_right_jumps(board, pieces);
-  lj = _ugolki_left_jumps(board, pieces);
-  fj = _ugolki_forward_jumps(board, pieces);
-  bj = _ugolki_backward_jumps(board, pieces);
-
-  std::stringstream ss;
-  if (rm != 0) {
-    buff = rm;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x3UL << i), _ugolki_get_move_direction((0x3UL << i), pieces)};
-        moves.push_back(move_buff);
-      }
-    }
-  }
-  if (lm != 0) {
-    buff = lm;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x3UL << (i-1)), _ugolki_get_move_direction((0x3UL << (i-1)), pieces)};
-        moves.push_back(move_buff);
-      }
-    }
-  }
-  if (fm != 0) {
-    buff = fm;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x101UL << i), _ugolki_get_move_direction((0x101UL << i), pieces)};
-        moves.push_back(move_buff);
-      }
-    }
-  }
-  if (bm != 0) {
-    buff = bm;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x101UL << (i-8)), _ugolki_get_move_direction((0x101UL << (i-8)), pieces)};
-        moves.push_back(move_buff);
-      }
-    }
-  }
+  uint64_t pawn_position = pieces & jump_action;
+  uint64_t invalid_move = jump_action ^ pawn_position;
+  int size = moves->size;
 
+  addMoves(_ugolki_right_jumps(board, pawn_position, invalid_move), true, RIGHT, moves);
+  addMoves(_ugolki_left_jumps(board, pawn_position, invalid_move), true, LEFT, moves);
+  addMoves(_ugolki_forward_jumps(board, pawn_position, invalid_move), true, FORWARD, moves);
+  addMoves(_ugolki_backward_jumps(board, pawn_position, invalid_move), true, BACKWARD, moves);
 
-  if (rj != 0) {
-    buff = rj;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x5UL << i), (_ugolki_get_move_direction((0x5UL << i), pieces) | 2U)};
-        moves.push_back(move_buff);
-      }
-    }
+  if (moves->size != size) {
+    moves->push(0, moveTable().pass);
   }
-  if (lj != 0) {
-    buff = lj;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x5UL << (i-2)), (_ugolki_get_move_direction((0x5UL << (i-2)), pieces) | 2U)};
-        moves.push_back(move_buff);
-      }
-    }
+}
+
+
+// batched legal moves
+namespace {
+
+constexpr uint64_t kNotFirstColumn = ~0x0101010101010101UL;
+constexpr uint64_t kNotFirstColumns = ~0x0303030303030303UL;
+constexpr int kNumDirectionMasks = 2 * NUM_MOVE_DIRECTIONS;
+
+// What get_legal_moves() looks at: the pieces which may move, the square
+// a jumping piece came from, and whether only jumps are allowed.
+struct MovingPieces {
+  uint64_t from;
+  uint64_t came_from;
+  bool jumps_only;
+};
+
+inline MovingPieces movingPieces(const GameBoard& board) {
+  int active = board.active;
+  if (board.jump_action != 0) {
+    uint64_t piece = board.pieces[active] & board.jump_action;
+    return {piece, board.jump_action ^ piece, true};
   }
-  if (fj != 0) {
-    buff = fj;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x10001UL << i), (_ugolki_get_move_direction((0x10001UL << i), pieces) | 2U)};
-        moves.push_back(move_buff);
-      }
-    }
+  if ((active == BLACK_PLAYER)
+      && !(board.pieces[WHITE_PLAYER] & BLACK_BASE)
+      && (board.pieces[BLACK_PLAYER] & WHITE_BASE)) {
+    return {board.pieces[BLACK_PLAYER] & WHITE_BASE, 0, false};
   }
-  if (bj != 0) {
-    buff = bj;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x10001UL << (i-16)), (_ugolki_get_move_direction((0x10001UL << (i-16)), pieces) | 2U)};
-        moves.push_back(move_buff);
-      }
-    }
+  if ((active == WHITE_PLAYER)
+      && !(board.pieces[BLACK_PLAYER] & WHITE_BASE)
+      && (board.pieces[WHITE_PLAYER] & BLACK_BASE)) {
+    return {board.pieces[WHITE_PLAYER] & BLACK_BASE, 0, false};
   }
-  return moves;
+  return {board.pieces[active], 0, false};
 }
 
+// Origin squares of the steps of every direction, then of the jumps, as
+// _ugolki_right() ... _ugolki_backward_jumps(). came_from is only set
+// when steps are not allowed, so it can block steps as well.
+inline void directionMasks(
+    uint64_t occupied,
+    const MovingPieces& p,
+    uint64_t* masks) {
+  uint64_t empty = ~(occupied | p.came_from);
+  uint64_t full = ~empty;
+
+  masks[RIGHT] = (empty >> 1) & p.from & (kNotFirstColumn >> 1);
+  masks[LEFT] = (empty << 1) & p.from & kNotFirstColumn;
+  masks[FORWARD] = (empty >> 8) & p.from;
+  masks[BACKWARD] = (empty << 8) & p.from;
+  masks[NUM_MOVE_DIRECTIONS + RIGHT] =
+      (empty >> 2) & p.from & (kNotFirstColumns >> 2) & (full >> 1);
+  masks[NUM_MOVE_DIRECTIONS + LEFT] =
+      (empty << 2) & p.from & kNotFirstColumns & (full << 1);
+  masks[NUM_MOVE_DIRECTIONS + FORWARD] =
+      (empty >> 16) & p.from & (full >> 8);
+  masks[NUM_MOVE_DIRECTIONS + BACKWARD] =
+      (empty << 16) & p.from & (full << 8);
+}
 
-std::vector<std::array<uint64_t, 2>> _jumps_from(GameBoard board, uint64_t pieces, uint64_t jump_action) {
-  /*
-      Returns list of all possible jumps from the piece indicated.
-
-      The argument piece should be of the form 2**n, where n + 1 is
-      the square of the piece in question (using the internal numeric
-      representaiton of the board).
-  */
-  uint64_t rj;
-  uint64_t lj;
-  uint64_t fj;
-  uint64_t bj;
-  
-  std::vector<std::array<uint64_t, 2>> moves;
-  uint64_t buff;
-  std::array<uint64_t, 2> move_buff;
-  uint64_t pawn_position;
-  uint64_t invalid_move;
-
-  pawn_position = pieces & jump_action;
-  invalid_move = jump_action ^ pawn_position;
-
-  rj = _ugolki_right_jumps(board, pawn_position, invalid_move);
-  lj = _ugolki_left_jumps(board, pawn_position, invalid_move);
-  fj = _ugolki_forward_jumps(board, pawn_position, invalid_move);
-  bj = _ugolki_backward_jumps(board, pawn_position, invalid_move);
-
-  if (rj != 0) {
-    buff = rj;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x5UL << i), (_ugolki_get_move_direction((0x5UL << i), pieces) | 2U)};
-        moves.push_back(move_buff);
+// Turns the direction masks into legal moves, as GetValidMovesBinary().
+// Entry d is masks[d * stride]. out is zeroed.
+inline void addLegalMasks(
+    const MovingPieces& p,
+    const uint64_t* masks,
+    size_t stride,
+    uint8_t* out) {
+  const MoveTable& table = moveTable();
+  bool any_jump = false;
+  for (int jump = p.jumps_only ? 1 : 0; jump < 2; jump++) {
+    for (int d = 0; d < NUM_MOVE_DIRECTIONS; d++) {
+      uint64_t mask = masks[(jump * NUM_MOVE_DIRECTIONS + d) * stride];
+      any_jump |= jump && mask != 0;
+      for (uint64_t b = mask; b != 0; b &= b - 1) {
+        out[table.index[jump][d][__builtin_ctzll(b)]] = 1;
       }
     }
   }
-  if (lj != 0) {
-    buff = lj;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x5UL << (i-2)), (_ugolki_get_move_direction((0x5UL << (i-2)), pieces) | 2U)};
-        moves.push_back(move_buff);
-      }
+  if (p.jumps_only && any_jump)
+    out[table.pass] = 1;
+}
+
+#ifdef ELF_TARGET_AVX2
+ELF_TARGET_AVX2 void generateLegalMasksAVX2(
+    const GameBoard* boards,
+    size_t n,
+    uint8_t* masks) {
+  const __m256i not_first = _mm256_set1_epi64x(kNotFirstColumn);
+  const __m256i not_first2 = _mm256_set1_epi64x(kNotFirstColumns);
+  const __m256i ones = _mm256_set1_epi64x(-1);
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const GameBoard* b = boards + i;
+    MovingPieces p[4];
+    for (int l = 0; l < 4; l++) {
+      p[l] = movingPieces(b[l]);
     }
-  }
-  if (fj != 0) {
-    buff = fj;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x10001UL << i), (_ugolki_get_move_direction((0x10001UL << i), pieces) | 2U)};
-        moves.push_back(move_buff);
-      }
+    __m256i from = _mm256_setr_epi64x(
+        p[0].from, p[1].from, p[2].from, p[3].from);
+    __m256i full = _mm256_setr_epi64x(
+        b[0].pieces[0] | b[0].pieces[1] | p[0].came_from,
+        b[1].pieces[0] | b[1].pieces[1] | p[1].came_from,
+        b[2].pieces[0] | b[2].pieces[1] | p[2].came_from,
+        b[3].pieces[0] | b[3].pieces[1] | p[3].came_from);
+    __m256i empty = _mm256_xor_si256(full, ones);
+
+    __m256i dir[kNumDirectionMasks];
+    dir[RIGHT] = _mm256_and_si256(
+        _mm256_and_si256(_mm256_srli_epi64(empty, 1), from),
+        _mm256_srli_epi64(not_first, 1));
+    dir[LEFT] = _mm256_and_si256(
+        _mm256_and_si256(_mm256_slli_epi64(empty, 1), from), not_first);
+    dir[FORWARD] = _mm256_and_si256(_mm256_srli_epi64(empty, 8), from);
+    dir[BACKWARD] = _mm256_and_si256(_mm256_slli_epi64(empty, 8), from);
+    dir[NUM_MOVE_DIRECTIONS + RIGHT] = _mm256_and_si256(
+        _mm256_and_si256(_mm256_srli_epi64(empty, 2), from),
+        _mm256_and_si256(
+            _mm256_srli_epi64(not_first2, 2), _mm256_srli_epi64(full, 1)));
+    dir[NUM_MOVE_DIRECTIONS + LEFT] = _mm256_and_si256(
+        _mm256_and_si256(_mm256_slli_epi64(empty, 2), from),
+        _mm256_and_si256(not_first2, _mm256_slli_epi64(full, 1)));
+    dir[NUM_MOVE_DIRECTIONS + FORWARD] = _mm256_and_si256(
+        _mm256_and_si256(_mm256_srli_epi64(empty, 16), from),
+        _mm256_srli_epi64(full, 8));
+    dir[NUM_MOVE_DIRECTIONS + BACKWARD] = _mm256_and_si256(
+        _mm256_and_si256(_mm256_slli_epi64(empty, 16), from),
+        _mm256_slli_epi64(full, 8));
+
+    alignas(32) uint64_t lanes[kNumDirectionMasks][4];
+    for (int d = 0; d < kNumDirectionMasks; d++) {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[d]), dir[d]);
     }
-  }
-  if (bj != 0) {
-    buff = bj;
-    for(int i = 0; buff > 0; buff = (buff >> 1), i++) {
-      if ((buff & 1) == 1) {
-        move_buff = {(0x10001UL << (i-16)), (_ugolki_get_move_direction((0x10001UL << (i-16)), pieces) | 2U)};
-        moves.push_back(move_buff);
-      }
+    for (int l = 0; l < 4; l++) {
+      addLegalMasks(
+          p[l], &lanes[0][l], 4, masks + (i + l) * TOTAL_NUM_ACTIONS);
     }
   }
-  if (bj | fj | lj | rj) {
-    move_buff = {0, 0};
-    moves.push_back(move_buff);
+  for (; i < n; i++) {
+    MovingPieces p = movingPieces(boards[i]);
+    uint64_t dir[kNumDirectionMasks];
+    directionMasks(boards[i].pieces[0] | boards[i].pieces[1], p, dir);
+    addLegalMasks(p, dir, 1, masks + i * TOTAL_NUM_ACTIONS);
+  }
+}
+#endif
+
+} // namespace
+
+void GenerateLegalMasksScalar(
+    const GameBoard* boards,
+    size_t n,
+    uint8_t* masks) {
+  memset(masks, 0, n * TOTAL_NUM_ACTIONS);
+  for (size_t i = 0; i < n; i++) {
+    MovingPieces p = movingPieces(boards[i]);
+    uint64_t dir[kNumDirectionMasks];
+    directionMasks(boards[i].pieces[0] | boards[i].pieces[1], p, dir);
+    addLegalMasks(p, dir, 1, masks + i * TOTAL_NUM_ACTIONS);
+  }
+}
+
+void GenerateLegalMasks(const GameBoard* boards, size_t n, uint8_t* masks) {
+#ifdef ELF_TARGET_AVX2
+  if (elf_utils::cpu_has_avx2()) {
+    memset(masks, 0, n * TOTAL_NUM_ACTIONS);
+    generateLegalMasksAVX2(boards, n, masks);
+    return;
   }
-  return moves;
+#endif
+  GenerateLegalMasksScalar(boards, n, masks);
 }
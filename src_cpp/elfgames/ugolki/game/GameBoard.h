@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <bitset>
+#include <cstdint>
 
 #include <queue>
 #include <vector>
@@ -44,8 +46,8 @@
 # define TOTAL_PLAYERS 2
 
 // number of layers
-// (our pawns + enemy pawns) 
-//            * MAX_CHECKERS_HISTORY + black move + white move
+// (our pawns + enemy pawns + black move + white move) * MAX_HISTORY,
+// current board first
 constexpr uint64_t NUM_FEATURES = 4 * MAX_HISTORY;
 
 constexpr uint64_t TOTAL_NUM_ACTIONS = 418;
@@ -80,32 +82,67 @@ typedef struct {
   int _ply;
 } GameBoard;
 
-bool TryPlay(GameBoard board, Coord c);
+// Fixed-capacity move list, so move generation needs no allocation.
+// Each of the 9 pieces has at most 4 moves, plus the pass action.
+struct MoveList {
+  static constexpr int kMaxMoves = 40;
+
+  // Moves as in HashAllMoves.h (old and new position bits on).
+  std::array<uint64_t, kMaxMoves> moves;
+  // Action index of each move.
+  std::array<Coord, kMaxMoves> actions;
+  int size = 0;
+
+  void push(uint64_t move, Coord action) {
+    moves[size] = move;
+    actions[size] = action;
+    size++;
+  }
+
+  void clear() {
+    size = 0;
+  }
+};
+
+bool TryPlay(const GameBoard& board, Coord c);
 bool Play(GameBoard *board, int action_index);
-bool IsOver(GameBoard board);
+bool IsOver(const GameBoard& board);
 
 void ClearBoard(GameBoard *board);
 bool CompareBoards(GameBoard b1, GameBoard b2);
 void CopyBoard(GameBoard* dst, const GameBoard* src);
 
-std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(GameBoard board);
+std::array<int, TOTAL_NUM_ACTIONS> GetValidMovesBinary(const GameBoard& board);
+// GetValidMovesBinary() of n boards at once, as bytes: the moves of
+// boards[i] go to masks[i * TOTAL_NUM_ACTIONS]. Boards are processed four
+// at a time in AVX2 lanes when the CPU has it.
+void GenerateLegalMasks(const GameBoard* boards, size_t n, uint8_t* masks);
+// Same without SIMD, for tests and benchmarks.
+void GenerateLegalMasksScalar(
+    const GameBoard* boards,
+    size_t n,
+    uint8_t* masks);
 
 std::array<std::array<int, 8>, 8> GetTrueObservation(const GameBoard board);
 std::array<std::array<int, 8>, 8> GetObservation(const GameBoard board, int player);
+// Square masks (bit = y * 8 + x) of the cells GetObservation() marks
+// with 1 for the active player, then for the passive one.
+std::array<uint64_t, 2> GetObservationMasks(const GameBoard& board);
 std::string GetTrueObservationStr(const GameBoard board);
-std::vector<std::array<uint64_t, 2>> get_legal_moves(GameBoard board);
+void get_legal_moves(const GameBoard& board, MoveList* moves);
 
 // board logic
-uint64_t _ugolki_right(GameBoard board, uint64_t pieces);
-uint64_t _ugolki_left(GameBoard board, uint64_t pieces);
-uint64_t _ugolki_forward(GameBoard board, uint64_t pieces);
-uint64_t _ugolki_backward(GameBoard board, uint64_t pieces);
-uint64_t _ugolki_right_jumps(GameBoard board, uint64_t pieces, uint64_t invalid_move=0);
-uint64_t _ugolki_left_jumps(GameBoard board, uint64_t pieces, uint64_t invalid_move=0);
-uint64_t _ugolki_forward_jumps(GameBoard board, uint64_t pieces, uint64_t invalid_move=0);
-uint64_t _ugolki_backward_jumps(GameBoard board, uint64_t pieces, uint64_t invalid_move=0);
+uint64_t _ugolki_right(const GameBoard& board, uint64_t pieces);
+uint64_t _ugolki_left(const GameBoard& board, uint64_t pieces);
+uint64_t _ugolki_forward(const GameBoard& board, uint64_t pieces);
+uint64_t _ugolki_backward(const GameBoard& board, uint64_t pieces);
+uint64_t _ugolki_right_jumps(const GameBoard& board, uint64_t pieces, uint64_t invalid_move=0);
+uint64_t _ugolki_left_jumps(const GameBoard& board, uint64_t pieces, uint64_t invalid_move=0);
+uint64_t _ugolki_forward_jumps(const GameBoard& board, uint64_t pieces, uint64_t invalid_move=0);
+uint64_t _ugolki_backward_jumps(const GameBoard& board, uint64_t pieces, uint64_t invalid_move=0);
 uint64_t _ugolki_get_move_direction(uint64_t move, uint64_t pieces);
+// {move, direction | jump} of an action index, same as moves::i_to_m.
+const std::array<uint64_t, 2>& _action_to_move(Coord action);
 
-std::vector<std::array<uint64_t, 2>> _get_all_moves(GameBoard board, uint64_t pieces);
-std::vector<std::array<uint64_t, 2>> _jumps_from(GameBoard board, uint64_t pieces, uint64_t jump_action);
-
+void _get_all_moves(const GameBoard& board, uint64_t pieces, MoveList* moves);
+void _jumps_from(const GameBoard& board, uint64_t pieces, uint64_t jump_action, MoveList* moves);
@@ -0,0 +1,138 @@
+#include "GamePerft.h"
+
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// rows[0] is the top of GetTrueObservationStr. 'b' black piece, 'w' white
+// piece, anything else is an empty square.
+GameBoard boardFromRows(const std::string rows[8], int player) {
+  GameBoard board;
+  ClearBoard(&board);
+  board.active = player;
+  board.passive = 1 - player;
+  board.pieces.fill(0);
+  for (int y = 0; y < 8; y++) {
+    for (int x = 0; x < 8; x++) {
+      uint64_t bit = 1UL << (y * 8 + x);
+      if (rows[y][x] == 'b')
+        board.pieces[BLACK_PLAYER] |= bit;
+      else if (rows[y][x] == 'w')
+        board.pieces[WHITE_PLAYER] |= bit;
+    }
+  }
+  return board;
+}
+
+void expectPerft(const GameBoard& board, const std::vector<uint64_t>& expected) {
+  for (size_t depth = 1; depth <= expected.size(); ++depth) {
+    EXPECT_EQ(expected[depth - 1], GamePerft(board, depth))
+        << "depth " << depth;
+  }
+}
+
+} // namespace
+
+// Counts pin the current generator: a chain of jumps is one ply per jump
+// plus the pass action ending it.
+TEST(GamePerftTest, startPosition) {
+  GameBoard board;
+  ClearBoard(&board);
+  expectPerft(board, {12, 144, 2472, 38092, 637108});
+}
+
+TEST(GamePerftTest, boardFromRows) {
+  const std::string rows[8] = {
+      "www.....",
+      "www.....",
+      "www.....",
+      "........",
+      "........",
+      ".....bbb",
+      ".....bbb",
+      ".....bbb",
+  };
+  GameBoard start;
+  ClearBoard(&start);
+  EXPECT_TRUE(CompareBoards(start, boardFromRows(rows, BLACK_PLAYER)));
+}
+
+// Pieces jump over any piece and may go on jumping or pass.
+TEST(GamePerftTest, jumpChain) {
+  const std::string rows[8] = {
+      "........",
+      "....w...",
+      "........",
+      "....w...",
+      "....b...",
+      "........",
+      "........",
+      "w.......",
+  };
+  GameBoard board = boardFromRows(rows, BLACK_PLAYER);
+  expectPerft(board, {4, 32, 137, 1267, 5372, 50169});
+}
+
+// The game ends once both players had the same number of moves after
+// one of them filled the opposite base.
+TEST(GamePerftTest, endOfGame) {
+  const std::string rows[8] = {
+      "bbb.....",
+      "bbb.....",
+      "bb.b....",
+      "........",
+      "........",
+      ".....www",
+      ".....www",
+      "......ww",
+  };
+  GameBoard board = boardFromRows(rows, BLACK_PLAYER);
+  expectPerft(board, {16, 188, 3164, 48595});
+}
+
+TEST(GamePerftTest, divideSumsToPerft) {
+  GameBoard board;
+  ClearBoard(&board);
+  uint64_t sum = 0;
+  for (const auto& p : GamePerftDivide(board, 4)) {
+    sum += p.second;
+  }
+  EXPECT_EQ(38092u, sum);
+}
+
+TEST(GamePerftTest, benchmarkThreads) {
+  GameBoard board;
+  ClearBoard(&board);
+  EXPECT_EQ(38092u, GamePerftBenchmark(board, 4, 1).nodes);
+  EXPECT_EQ(38092u, GamePerftBenchmark(board, 4, 4).nodes);
+}
+
+// TryPlay checks a single action without generating the moves, it has to
+// agree with the legal mask.
+TEST(GamePerftTest, tryPlayMatchesLegalMoves) {
+  std::mt19937 rng(0);
+  for (int game = 0; game < 20; ++game) {
+    GameBoard board;
+    ClearBoard(&board);
+    for (int ply = 0; ply < TOTAL_MAX_MOVE && !IsOver(board); ++ply) {
+      auto valid = GetValidMovesBinary(board);
+      std::vector<Coord> legal;
+      for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+        ASSERT_EQ((bool)valid[c], TryPlay(board, c)) << "action " << c;
+        if (valid[c])
+          legal.push_back(c);
+      }
+      if (legal.empty())
+        break;
+      Play(&board, legal[rng() % legal.size()]);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
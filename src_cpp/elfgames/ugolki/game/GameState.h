@@ -1,10 +1,15 @@
 #pragma once
 
+// elf
+#include "elf/utils/ring_buffer.h"
+// game
 #include "GameBoard.h"
 #include "BoardFeature.h"
 
 class GameState {
  public:
+  // Last MAX_HISTORY boards, current one included.
+  using History = elf_utils::RingBuffer<GameBoardHistory, MAX_HISTORY>;
 
   GameState() {
     reset();
@@ -72,9 +77,9 @@ class GameState {
     return ss.str();
   }
 
-  // const std::deque<BoardHistory>& getHistory() const {
-  //   return _history;
-  // }
+  const History& getHistory() const {
+    return _history;
+  }
 
   // delete!!!!!!
   std::array<std::array<int, 8>, 8> getBoard() const {
@@ -84,8 +89,8 @@ class GameState {
  protected:
   GameBoard _board;
 
-  // History for our net(dont use now)
-  std::deque<GameBoardHistory> _history;
+  // History for our net
+  History _history;
   // history of moves for current board
   std::vector<Coord> _moves;
 
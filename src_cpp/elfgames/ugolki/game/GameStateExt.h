@@ -9,6 +9,7 @@
 #include "GameState.h"
 #include "BoardFeature.h"
 #include "GameOptions.h"
+#include "GameSymmetry.h"
 #include "../common/record.h"
 #include "../sgf/sgf.h"
 #include "Record.h"
@@ -59,6 +60,7 @@ struct GameStateExt {
         std::vector<int64_t>(_using_models.begin(), _using_models.end());
     r.result.policies = _mcts_policies;
     r.result.num_move = _state.getPly() - 1;
+    r.result.draw = _state.getPly() >= TOTAL_MAX_MOVE;
     r.result.values = _predicted_values;
     _logger->info("Dump Record:{}\n", r.info());
     return r;
@@ -138,6 +140,7 @@ class GameStateExtOffline {
     _curr_request = r.request;
     _seq = r.seq;
     _predicted_values = r.result.values;
+    _aug_code = AUG_IDENTITY;
     _state.reset();
 
     // std::cout << "GoStateExtOffline::fromRecord" << std::endl;
@@ -186,6 +189,15 @@ class GameStateExtOffline {
     return _predicted_values[move_idx];
   }
 
+  // The sample is sent through the symmetry aug_code, see GameSymmetry.h.
+  void setAugCode(int aug_code) {
+    _aug_code = aug_code;
+  }
+
+  int getAugCode() const {
+    return _aug_code;
+  }
+
  private:
   const int _game_idx;
   GameState _state;
@@ -197,6 +209,7 @@ class GameStateExtOffline {
 
   std::vector<Coord> _offline_all_moves;
   float _offline_winner;
+  int _aug_code = AUG_IDENTITY;
 
   std::vector<GameCoordRecord> _mcts_policies;
   std::vector<float> _predicted_values;
@@ -0,0 +1,100 @@
+#include "GameState.h"
+
+#include <deque>
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const int kRegion = BOARD_SIZE * BOARD_SIZE;
+
+// Cells where GetObservation(board, player) is 1, as 0/1 floats.
+void observationPlane(const GameBoard& board, int player, float* data) {
+  auto observation = GetObservation(board, player);
+  for (int y = 0; y < BOARD_SIZE; ++y) {
+    for (int x = 0; x < BOARD_SIZE; ++x) {
+      data[y * BOARD_SIZE + x] = observation[y][x] == 1 ? 1 : 0;
+    }
+  }
+}
+
+// Features of the boards, last one first.
+std::vector<float> expectedFeatures(const std::deque<GameBoard>& boards) {
+  std::vector<float> features(NUM_FEATURES * kRegion, 0.0);
+  for (size_t i = 0; i < boards.size(); ++i) {
+    const GameBoard& board = boards[boards.size() - 1 - i];
+    float* planes = &features[4 * i * kRegion];
+    observationPlane(board, board.active, planes);
+    observationPlane(board, board.passive, planes + kRegion);
+    int indicator = board.active == BLACK_PLAYER ? 2 : 3;
+    std::fill_n(planes + indicator * kRegion, kRegion, 1.0);
+  }
+  return features;
+}
+
+} // namespace
+
+// History planes hold the last MAX_HISTORY boards, copies included.
+TEST(GameStateTest, historyFeatures) {
+  std::mt19937 rng(0);
+  for (int game = 0; game < 20; ++game) {
+    GameState state;
+    std::deque<GameBoard> boards = {state.board()};
+
+    while (!state.terminated()) {
+      // Stale values in the slot must be overwritten.
+      std::vector<float> features(NUM_FEATURES * kRegion, -1.0);
+      GameState copy = state;
+      BoardFeature(copy).extract(features.data());
+      ASSERT_EQ(expectedFeatures(boards), features);
+
+      MoveList moves;
+      get_legal_moves(state.board(), &moves);
+      ASSERT_GT(moves.size, 0);
+      ASSERT_TRUE(state.forward(moves.actions[rng() % moves.size]));
+      boards.push_back(state.board());
+      if (boards.size() > MAX_HISTORY)
+        boards.pop_front();
+    }
+
+    state.reset();
+    ASSERT_EQ(1u, state.getHistory().size());
+  }
+}
+
+// Batched legal moves are GetValidMovesBinary() of every board, with a
+// count of boards which is not a multiple of the SIMD width.
+TEST(GameStateTest, legalMasks) {
+  std::mt19937 rng(1);
+  std::vector<GameBoard> boards;
+  while (boards.size() < 1003) {
+    GameState state;
+    while (boards.size() < 1003 && !state.terminated()) {
+      boards.push_back(state.board());
+      MoveList moves;
+      get_legal_moves(state.board(), &moves);
+      ASSERT_TRUE(state.forward(moves.actions[rng() % moves.size]));
+    }
+  }
+
+  std::vector<uint8_t> masks(boards.size() * TOTAL_NUM_ACTIONS, 2);
+  std::vector<uint8_t> scalar(boards.size() * TOTAL_NUM_ACTIONS, 2);
+  GenerateLegalMasks(boards.data(), boards.size(), masks.data());
+  GenerateLegalMasksScalar(boards.data(), boards.size(), scalar.data());
+  for (size_t i = 0; i < boards.size(); ++i) {
+    auto valid = GetValidMovesBinary(boards[i]);
+    std::vector<uint8_t> expected(valid.begin(), valid.end());
+    const uint8_t* m = &masks[i * TOTAL_NUM_ACTIONS];
+    const uint8_t* s = &scalar[i * TOTAL_NUM_ACTIONS];
+    ASSERT_EQ(expected, std::vector<uint8_t>(m, m + TOTAL_NUM_ACTIONS))
+        << GetTrueObservationStr(boards[i]);
+    ASSERT_EQ(expected, std::vector<uint8_t>(s, s + TOTAL_NUM_ACTIONS))
+        << GetTrueObservationStr(boards[i]);
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
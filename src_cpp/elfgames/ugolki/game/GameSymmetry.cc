@@ -0,0 +1,63 @@
+#include "GameSymmetry.h"
+
+#include <map>
+
+namespace {
+
+// Action of every move transposed.
+struct TransposeTable {
+  Coord action[TOTAL_NUM_ACTIONS];
+
+  TransposeTable() {
+    for (Coord i = 0; i < TOTAL_NUM_ACTIONS; i++) {
+      action[i] = i;
+    }
+    // A move is its two bits, the piece starts on the low one if the
+    // direction bit is set; the jump bit is kept.
+    std::map<std::array<uint64_t, 2>, Coord> index;
+    for (const auto& a : moves::i_to_m) {
+      index[a.second] = a.first;
+    }
+    for (const auto& a : moves::i_to_m) {
+      uint64_t bits = a.second[0];
+      uint64_t flags = a.second[1];
+      if (bits == 0) {
+        // Pass.
+        continue;
+      }
+      int lo = __builtin_ctzll(bits);
+      int hi = 63 - __builtin_clzll(bits);
+      int from = AugmentSquare(flags & 1 ? lo : hi, AUG_TRANSPOSE);
+      int to = AugmentSquare(flags & 1 ? hi : lo, AUG_TRANSPOSE);
+
+      uint64_t move = (1UL << from) | (1UL << to);
+      action[a.first] = index.at({move, (flags & 2) | (from < to)});
+    }
+  }
+};
+
+const TransposeTable& transposeTable() {
+  static const TransposeTable table;
+  return table;
+}
+
+} // namespace
+
+
+int AugmentSquare(int square, int aug_code) {
+  if (aug_code != AUG_TRANSPOSE)
+    return square;
+  return square % 8 * 8 + square / 8;
+}
+
+
+Coord AugmentAction(Coord action, int aug_code) {
+  if (aug_code != AUG_TRANSPOSE || action >= TOTAL_NUM_ACTIONS)
+    return action;
+  return transposeTable().action[action];
+}
+
+
+int RandomAugCode(std::mt19937* rng) {
+  return (*rng)() % NUM_AUG_CODES;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <random>
+
+#include "GameBoard.h"
+
+/*
+  Symmetries used to augment training samples, recorded in aug_code.
+
+  The bases are the 3x3 corners on the a1-h8 diagonal and pieces move
+  the same way in all four directions, so transposing the board along
+  that diagonal gives an equivalent position of the same game. It
+  commutes with the half turn GetObservation() applies for white, so
+  the piece planes of BoardFeature are just transposed.
+
+  The colour flip is not used: draws and games reaching TOTAL_MAX_MOVE
+  are scored for white.
+*/
+
+#define AUG_IDENTITY   0
+#define AUG_TRANSPOSE  1
+#define NUM_AUG_CODES  2
+
+// Square y * 8 + x of the augmented position.
+int AugmentSquare(int square, int aug_code);
+
+// Action of the augmented position, the pass action is kept.
+Coord AugmentAction(Coord action, int aug_code);
+
+int RandomAugCode(std::mt19937* rng);
@@ -0,0 +1,71 @@
+#include "GameSymmetry.h"
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+uint64_t transposeMask(uint64_t mask) {
+  uint64_t res = 0;
+  for (int sq = 0; sq < 64; sq++) {
+    if ((mask >> sq) & 1)
+      res |= 1UL << AugmentSquare(sq, AUG_TRANSPOSE);
+  }
+  return res;
+}
+
+GameBoard transposeBoard(const GameBoard& board) {
+  GameBoard res = board;
+  for (int c = 0; c < 2; c++) {
+    res.pieces[c] = transposeMask(board.pieces[c]);
+  }
+  res.jump_action = transposeMask(board.jump_action);
+  res._last_move = AugmentAction(board._last_move, AUG_TRANSPOSE);
+  return res;
+}
+
+} // namespace
+
+// Legal actions and feature planes agree with the transposed board.
+TEST(GameSymmetryTest, transpose) {
+  std::mt19937 rng(0);
+  for (int game = 0; game < 20; ++game) {
+    GameBoard board;
+    ClearBoard(&board);
+
+    while (!IsOver(board) && board._ply < TOTAL_MAX_MOVE) {
+      GameBoard transposed = transposeBoard(board);
+      auto valid = GetValidMovesBinary(board);
+      auto transposed_valid = GetValidMovesBinary(transposed);
+      std::vector<Coord> legal;
+      for (Coord c = 0; c < TOTAL_NUM_ACTIONS; ++c) {
+        Coord t = AugmentAction(c, AUG_TRANSPOSE);
+        ASSERT_EQ(c, AugmentAction(t, AUG_TRANSPOSE));
+        ASSERT_EQ(valid[c], transposed_valid[t]) << "action " << c;
+        if (valid[c])
+          legal.push_back(c);
+      }
+
+      auto masks = GetObservationMasks(board);
+      auto transposed_masks = GetObservationMasks(transposed);
+      for (int i = 0; i < 2; ++i) {
+        ASSERT_EQ(transposeMask(masks[i]), transposed_masks[i]);
+      }
+
+      if (legal.empty())
+        break;
+      Play(&board, legal[rng() % legal.size()]);
+    }
+  }
+}
+
+TEST(GameSymmetryTest, passAction) {
+  EXPECT_EQ(416, AugmentAction(416, AUG_TRANSPOSE));
+  EXPECT_EQ(M_INVALID, AugmentAction(M_INVALID, AUG_TRANSPOSE));
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <sstream>
+#include <string>
+
+// elf
+#include "elf/base/context.h"
+#include "elf/legacy/python_options_utils_cpp.h"
+#include "elf/logging/IndexedLoggerFactory.h"
+
+#include "../common/Notifier.h"
+#include "client_manager.h"
+#include "control/CtrlEval.h"
+
+/*
+	Evaluation of a new model against an old one inside this process
+	(mode "arena"), without server nor ZMQ.
+
+	Every game thread counts as a client of its own for EvalSubCtrl, which
+	picks who plays black and decides when the new model passes or fails,
+	as it does on the server. Results are fed to it as soon as a game ends.
+
+	The new model plays as "actor_black" and the old one as
+	"actor_white" (whatever their colour in a game), so the leaves
+	of each model are batched over all the games. Python loads both models
+	before setModels().
+*/
+class LocalArena : public GameNotifierBase, public GameRequesterBase {
+ public:
+	LocalArena(
+			const ContextOptions& contextOptions,
+			const GameOptions& gameOptions,
+			elf::GameClient* client)
+			: client_(client),
+				mgr_(
+						contextOptions.num_games,
+						gameOptions.client_max_delay_sec,
+						contextOptions.num_games,
+						0.0),
+				eval_(gameOptions, contextOptions.mcts_options),
+				logger_(elf::logging::getIndexedLogger(
+							MAGENTA_B + std::string("|++|") + COLOR_END +
+							"LocalArena-",
+							"")) {
+	}
+
+	// Start the evaluation. As on the server, new_ver has to be later
+	// than old_ver.
+	void setModels(int64_t new_ver, int64_t old_ver) {
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		logger_->info("Arena new_ver: {}, old_ver: {}", new_ver, old_ver);
+		eval_.setBaselineModel(old_ver);
+		eval_.addNewModelForEvaluation(old_ver, new_ver);
+		started_ = true;
+		passed_ = false;
+	}
+
+	bool finished() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return started_ && eval_.idle();
+	}
+
+	// Whether the new model passed, once finished().
+	bool passed() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return passed_;
+	}
+
+	std::string info() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		std::stringstream ss;
+		ss	<< "[games=" << num_games_ << "]"
+				<< "[finished=" << (started_ && eval_.idle()) << "]"
+				<< "[passed=" << passed_ << "]";
+		return ss.str();
+	}
+
+	bool OnGameRequest(int game_idx, MsgRequest* request) override {
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		update_state();
+
+		const ClientInfo& info = mgr_.getClient(client_id(game_idx));
+		request->vers.set_wait();
+		request->client_ctrl.client_type = info.type();
+		eval_.fillInRequest(info, request);
+		return !request->vers.wait();
+	}
+
+	void OnGameEnd(const GameStateExt& s) override {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			GameRecord r = s.dumpRecord();
+			eval_.feedStats(mgr_.getClient(client_id(r.thread_id)), r);
+			num_games_++;
+			update_state();
+		}
+
+		// Report the game to python, as in selfplay.
+		elf::FuncsWithState funcs =
+				client_->BindStateToFunctions({"game_end"}, &s);
+		client_->sendWait({"game_end"}, &funcs);
+	}
+
+	void OnStateUpdate(const ThreadState& ts) override {
+		// Keeps the thread from being seen as stuck.
+		mgr_.updateStates(client_id(ts.thread_id), {{ts.thread_id, ts}});
+	}
+
+ private:
+	mutable std::mutex	mutex_;
+	elf::GameClient*		client_ = nullptr;
+	ClientManager				mgr_;
+	EvalSubCtrl					eval_;
+
+	bool								started_ = false;
+	bool								passed_ = false;
+	int									num_games_ = 0;
+
+	std::shared_ptr<spdlog::logger> logger_;
+
+	static std::string client_id(int game_idx) {
+		return "arena-" + std::to_string(game_idx);
+	}
+
+	void update_state() {
+		int64_t ver = eval_.updateState(mgr_);
+		if (ver >= 0) {
+			// Ends the evaluation, as the server does by updating the model.
+			passed_ = true;
+			eval_.setBaselineModel(ver);
+		}
+	}
+};
@@ -43,6 +43,9 @@ void ServerGameTrain::act() {
       if (_game_state_ext[i]->switchRandomMove(&_rng))
         break;
     }
+    if (_game_options.train_augment) {
+      _game_state_ext[i]->setAugCode(RandomAugCode(&_rng));
+    }
 
     funcsToSend.push_back(
         client_->BindStateToFunctions({"train"}, _game_state_ext[i].get()));
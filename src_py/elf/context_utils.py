@@ -47,6 +47,34 @@ class ContextArgs(object):
             'mcts_persistent_tree',
             'use persistent tree in MCTS',
             False)
+        spec.addIntOption(
+            'mcts_ponder_rollout_per_thread',
+            'number of rollouts per MCTS thread while the opponent is to '
+            'move (0 = no pondering, needs mcts_persistent_tree)',
+            0)
+        spec.addIntOption(
+            'mcts_max_nodes_per_tree',
+            'node budget of one MCTS tree (0 = no limit)',
+            0)
+        spec.addIntOption(
+            'mcts_max_nodes_per_process',
+            'node budget of all the MCTS trees of the process (0 = no limit)',
+            0)
+        spec.addIntOption(
+            'mcts_trees',
+            'number of MCTS trees searched from the same root, among which '
+            'the threads are shared out (1 = one shared tree)',
+            1)
+        spec.addFloatOption(
+            'mcts_tree_epsilon',
+            'with mcts_trees > 1 and mcts_epsilon = 0, weight of the root '
+            'noise of the trees past the first',
+            0.25)
+        spec.addFloatOption(
+            'mcts_tree_alpha',
+            'with mcts_trees > 1 and mcts_epsilon = 0, alpha term of the '
+            'root noise of the trees past the first',
+            0.3)
         spec.addBoolOption(
             'mcts_use_prior',
             'use prior in MCTS',
@@ -102,6 +130,13 @@ class ContextArgs(object):
         mcts.virtual_loss = options.mcts_virtual_loss
         mcts.pick_method = options.mcts_pick_method
         mcts.persistent_tree = options.mcts_persistent_tree
+        mcts.ponder_rollouts_per_thread = \
+            options.mcts_ponder_rollout_per_thread
+        mcts.max_nodes_per_tree = options.mcts_max_nodes_per_tree
+        mcts.max_nodes_per_process = options.mcts_max_nodes_per_process
+        mcts.num_trees = options.mcts_trees
+        mcts.tree_epsilon = options.mcts_tree_epsilon
+        mcts.tree_alpha = options.mcts_tree_alpha
         mcts.root_epsilon = options.mcts_epsilon
         mcts.root_alpha = options.mcts_alpha
 
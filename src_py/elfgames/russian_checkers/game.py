@@ -53,6 +53,61 @@ class Loader(object):
 			'num_reader',
 			'TODO: fill this help message in',
 			50)
+		spec.addBoolOption(
+			'replay_prioritized',
+			('Sample replay buffer games by weight (record priority, '
+			 'recency, length) instead of uniformly'),
+			False)
+		spec.addFloatOption(
+			'replay_recency_half_life',
+			('With replay_prioritized, halve the weight of a game every N '
+			 'inserted games (0 disables recency weighting)'),
+			0.0)
+		spec.addFloatOption(
+			'replay_version_half_life',
+			('With replay_prioritized, halve the weight of a game for every N '
+			 'model versions it is behind the newest selfplay game '
+			 '(0 disables version weighting)'),
+			0.0)
+		spec.addBoolOption(
+			'replay_weight_by_length',
+			('With replay_prioritized, weight games by their number of '
+			 'positions'),
+			False)
+		spec.addStrOption(
+			'replay_store_dir',
+			('If set, keep training positions in memory-mapped segment files '
+			 'in this directory instead of the in-memory replay buffer'),
+			'')
+		spec.addIntOption(
+			'replay_store_segment_size',
+			'Number of positions per replay store segment file',
+			65536)
+		spec.addIntOption(
+			'replay_store_num_versions',
+			('Keep replay store positions of the last N selfplay versions '
+			 '(0 keeps everything)'),
+			0)
+		spec.addIntOption(
+			'replay_store_min_positions',
+			('Number of positions the replay store needs before training '
+			 'starts (q_min_size counts games per queue and is not used)'),
+			20000)
+		spec.addBoolOption(
+			'replay_store_per_game',
+			('Sample replay store positions by picking a uniform game first, '
+			 'as the replay buffer does, instead of a uniform position'),
+			True)
+		spec.addBoolOption(
+			'train_augment',
+			('Apply a random board symmetry (colour flip) to each training '
+			 'sample, recorded in checkers_aug_code'),
+			False)
+		spec.addStrOption(
+			'tablebase_path',
+			('Endgame tablebase file. MCTS leaves found in it are scored '
+			 'without the network and won selfplay games end early'),
+			'')
 		spec.addIntOption(
 			'num_reset_ranking',
 			'TODO: fill this help message in',
@@ -180,6 +235,27 @@ class Loader(object):
 			'eval_winrate_thres',
 			'Win rate threshold for evalution',
 			0.55)
+		spec.addBoolOption(
+			'eval_sprt',
+			('Stop evaluation as soon as a sequential probability ratio '
+			 'test decides, at most after eval_num_games games'),
+			True)
+		spec.addFloatOption(
+			'eval_sprt_elo0',
+			'Elo gain of the new model under the fail hypothesis',
+			0.0)
+		spec.addFloatOption(
+			'eval_sprt_elo1',
+			'Elo gain of the new model under the pass hypothesis',
+			35.0)
+		spec.addFloatOption(
+			'eval_sprt_alpha',
+			'Chance of passing a model no stronger than eval_sprt_elo0',
+			0.05)
+		spec.addFloatOption(
+			'eval_sprt_beta',
+			'Chance of failing a model eval_sprt_elo1 stronger',
+			0.05)
 		spec.addIntOption(
 			'eval_old_model',
 			('If specified, then we directly switch to evaluation mode '
@@ -259,6 +335,22 @@ class Loader(object):
 		game_opt.q_min_size = self.options.q_min_size
 		game_opt.q_max_size = self.options.q_max_size
 		game_opt.num_reader = self.options.num_reader
+		game_opt.replay_prioritized = self.options.replay_prioritized
+		game_opt.replay_recency_half_life = \
+			self.options.replay_recency_half_life
+		game_opt.replay_version_half_life = \
+			self.options.replay_version_half_life
+		game_opt.replay_weight_by_length = self.options.replay_weight_by_length
+		game_opt.replay_store_dir = self.options.replay_store_dir
+		game_opt.replay_store_segment_size = \
+			self.options.replay_store_segment_size
+		game_opt.replay_store_num_versions = \
+			self.options.replay_store_num_versions
+		game_opt.replay_store_min_positions = \
+			self.options.replay_store_min_positions
+		game_opt.replay_store_per_game = self.options.replay_store_per_game
+		game_opt.train_augment = self.options.train_augment
+		game_opt.tablebase_path = self.options.tablebase_path
 		game_opt.checkers_num_future_actions = self.options.checkers_num_future_actions
 		game_opt.num_reset_ranking = self.options.num_reset_ranking
 		game_opt.policy_distri_cutoff = self.options.policy_distri_cutoff
@@ -278,6 +370,11 @@ class Loader(object):
 		game_opt.selfplay_async = self.options.selfplay_async
 		game_opt.eval_num_games = self.options.eval_num_games
 		game_opt.eval_thres = self.options.eval_winrate_thres
+		game_opt.eval_sprt = self.options.eval_sprt
+		game_opt.eval_sprt_elo0 = self.options.eval_sprt_elo0
+		game_opt.eval_sprt_elo1 = self.options.eval_sprt_elo1
+		game_opt.eval_sprt_alpha = self.options.eval_sprt_alpha
+		game_opt.eval_sprt_beta = self.options.eval_sprt_beta
 		game_opt.cheat_eval_new_model_wins_half = \
 			self.options.cheat_eval_new_model_wins_half
 		game_opt.cheat_selfplay_random_result = \
@@ -335,7 +432,7 @@ class Loader(object):
 				batchsize=co.mcts_options.num_rollouts_per_batch
 			)
 
-		elif self.options.mode == "selfplay":
+		elif self.options.mode == "selfplay" or self.options.mode == "arena":
 			desc["game_end"] = dict(
 				batchsize=1,
 			)
@@ -376,6 +473,7 @@ class Loader(object):
 						"checkers_winner", 
 						"checkers_mcts_scores", 
 						"checkers_move_idx",
+						"checkers_aug_code",
 						"checkers_selfplay_ver"],
 				reply=None
 			)
@@ -53,6 +53,26 @@ class Loader(object):
 			'num_reader',
 			'TODO: fill this help message in',
 			50)
+		spec.addBoolOption(
+			'replay_prioritized',
+			('Sample replay buffer games by weight (record priority, '
+			 'recency, model version, length) instead of uniformly'),
+			False)
+		spec.addFloatOption(
+			'replay_recency_half_life',
+			('With replay_prioritized, halve the weight of a game every N '
+			 'inserted games (0 disables recency weighting)'),
+			0.0)
+		spec.addFloatOption(
+			'replay_version_half_life',
+			('With replay_prioritized, halve the weight of a game for every N '
+			 'model versions it is behind the newest selfplay game '
+			 '(0 disables version weighting)'),
+			0.0)
+		spec.addBoolOption(
+			'replay_weight_by_length',
+			'With replay_prioritized, weight games by their number of moves',
+			False)
 		spec.addIntOption(
 			'num_reset_ranking',
 			'TODO: fill this help message in',
@@ -70,6 +90,11 @@ class Loader(object):
 			'keep_prev_selfplay',
 			'TODO: fill this help message in',
 			False)
+		spec.addBoolOption(
+			'train_augment',
+			('Apply a random board symmetry (transpose) to each training '
+			 'sample, recorded in aug_code'),
+			False)
 		spec.addIntOption(
 			'num_games_per_thread',
 			('For offline mode, it is the number of concurrent games per '
@@ -192,6 +217,27 @@ class Loader(object):
 			'eval_winrate_thres',
 			'Win rate threshold for evalution',
 			0.55)
+		spec.addBoolOption(
+			'eval_sprt',
+			('Stop evaluation as soon as a sequential probability ratio '
+			 'test decides, at most after eval_num_games games'),
+			True)
+		spec.addFloatOption(
+			'eval_sprt_elo0',
+			'Elo gain of the new model under the fail hypothesis',
+			0.0)
+		spec.addFloatOption(
+			'eval_sprt_elo1',
+			'Elo gain of the new model under the pass hypothesis',
+			35.0)
+		spec.addFloatOption(
+			'eval_sprt_alpha',
+			'Chance of passing a model no stronger than eval_sprt_elo0',
+			0.05)
+		spec.addFloatOption(
+			'eval_sprt_beta',
+			'Chance of failing a model eval_sprt_elo1 stronger',
+			0.05)
 		spec.addIntOption(
 			'eval_old_model',
 			('If specified, then we directly switch to evaluation mode '
@@ -285,11 +331,18 @@ class Loader(object):
 		game_opt.q_min_size = self.options.q_min_size
 		game_opt.q_max_size = self.options.q_max_size
 		game_opt.num_reader = self.options.num_reader
+		game_opt.replay_prioritized = self.options.replay_prioritized
+		game_opt.replay_recency_half_life = \
+			self.options.replay_recency_half_life
+		game_opt.replay_version_half_life = \
+			self.options.replay_version_half_life
+		game_opt.replay_weight_by_length = self.options.replay_weight_by_length
 		game_opt.num_future_actions = self.options.num_future_actions
 		game_opt.num_reset_ranking = self.options.num_reset_ranking
 		game_opt.policy_distri_cutoff = self.options.policy_distri_cutoff
 		game_opt.num_games_per_thread = self.options.num_games_per_thread
 		game_opt.keep_prev_selfplay = self.options.keep_prev_selfplay
+		game_opt.train_augment = self.options.train_augment
 		game_opt.expected_num_clients = self.options.expected_num_clients
 
 		game_opt.white_puct = self.options.white_puct
@@ -304,6 +357,11 @@ class Loader(object):
 		game_opt.selfplay_async = self.options.selfplay_async
 		game_opt.eval_num_games = self.options.eval_num_games
 		game_opt.eval_thres = self.options.eval_winrate_thres
+		game_opt.eval_sprt = self.options.eval_sprt
+		game_opt.eval_sprt_elo0 = self.options.eval_sprt_elo0
+		game_opt.eval_sprt_elo1 = self.options.eval_sprt_elo1
+		game_opt.eval_sprt_alpha = self.options.eval_sprt_alpha
+		game_opt.eval_sprt_beta = self.options.eval_sprt_beta
 		game_opt.cheat_eval_new_model_wins_half = \
 			self.options.cheat_eval_new_model_wins_half
 		game_opt.cheat_selfplay_random_result = \
@@ -361,7 +419,7 @@ class Loader(object):
 				batchsize=co.mcts_options.num_rollouts_per_batch
 			)
 
-		elif self.options.mode == "selfplay":
+		elif self.options.mode == "selfplay" or self.options.mode == "arena":
 			desc["game_end"] = dict(
 				batchsize=1,
 			)
@@ -402,6 +460,7 @@ class Loader(object):
 						"winner", 
 						"mcts_scores", 
 						"move_idx",
+						"aug_code",
 						"selfplay_ver"],
 				reply=None
 			)